@@ -0,0 +1,168 @@
+#ifndef APU_H
+#define APU_H
+
+#include "BlipBuffer.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class StateWriter;
+class StateReader;
+
+/**
+ * NES APU (NTSC): 펄스 2, 삼각파, 노이즈, DMC, 프레임 카운터
+ *
+ * 시간은 CPU 사이클 (절대값). 레지스터 접근 사이에는 채널을 사이클마다 진행하지 않고 runUntil() 로 한 번에 진행
+ * - 채널마다 다음 타이머 클럭 시점(nextClock)부터 주기만큼 건너뛰며 시퀀서만 진행하고, 출력이 바뀐 시점에만 BlipBuffer 에 기록
+ * - 프레임 카운터 이벤트(envelope, length, sweep)와 오디오 블록 경계에서 나눠 진행하므로 어디서 나눠 호출해도 결과가 같음
+ * - 믹서는 채널별 선형 근사 (pulse 0.00752, triangle 0.00851, noise 0.00494, DMC 0.00335)
+ *
+ * 오디오 블록: frameCycles 마다 호스트 샘플 한 블록을 만들어 audioOutput 으로 넘김
+ * 오디오를 끄면(headless) 소리에만 쓰이는 펄스/삼각파/노이즈 타이머와 합성을 건너뜀
+ * - 게임이 볼 수 있는 상태($4015: length, DMC, IRQ)는 그대로 진행
+ */
+class APU
+{
+public:
+    struct Envelope
+    {
+        bool start = false;
+        bool loop = false; // length counter halt 와 같은 비트
+        bool constant = false;
+        uint8_t period = 0; // 상수 볼륨이면 볼륨
+        uint8_t divider = 0;
+        uint8_t decay = 0;
+    };
+
+    struct Pulse
+    {
+        Envelope envelope;
+        bool enabled = false;
+        uint8_t duty = 0;
+        uint8_t step = 0;
+        uint8_t length = 0;
+        uint16_t timer = 0; // 11비트 주기 (CPU (timer + 1) * 2 사이클마다 시퀀서 진행)
+        bool sweepEnabled = false;
+        bool sweepNegate = false;
+        bool sweepReload = false;
+        uint8_t sweepPeriod = 0;
+        uint8_t sweepShift = 0;
+        uint8_t sweepDivider = 0;
+        uint64_t nextClock = 0;
+        int output = 0; // BlipBuffer 에 마지막으로 기록한 출력
+    };
+
+    struct Triangle
+    {
+        bool enabled = false;
+        bool control = false; // length counter halt + linear counter control
+        bool linearReload = false;
+        uint8_t linearPeriod = 0;
+        uint8_t linear = 0;
+        uint8_t length = 0;
+        uint8_t step = 0;
+        uint16_t timer = 0;
+        uint64_t nextClock = 0;
+        int output = 0;
+    };
+
+    struct Noise
+    {
+        Envelope envelope;
+        bool enabled = false;
+        bool mode = false; // 짧은 주기 (bit 6 피드백)
+        uint8_t period = 0;
+        uint8_t length = 0;
+        uint16_t shift = 1; // 15비트 LFSR
+        uint64_t nextClock = 0;
+        int output = 0;
+    };
+
+    struct DMC
+    {
+        bool irqEnabled = false;
+        bool loop = false;
+        uint8_t rate = 0;
+        uint8_t level = 0; // 7비트 출력
+        uint16_t sampleAddress = 0xC000;
+        uint16_t sampleLength = 1;
+        uint16_t address = 0xC000; // 다음에 읽을 주소
+        uint16_t bytesRemaining = 0;
+        uint8_t buffer = 0;
+        bool bufferEmpty = true;
+        uint8_t shift = 0;
+        uint8_t bitsRemaining = 8;
+        bool silence = true;
+        bool irq = false;
+        uint64_t nextClock = 0;
+        int output = 0;
+    };
+
+    Pulse pulse[2];
+    Triangle triangle;
+    Noise noise;
+    DMC dmc;
+
+    // 프레임 카운터 ($4017)
+    bool fiveStep = false;
+    bool frameIRQInhibit = false;
+    bool frameIRQ = false;
+    uint8_t frameStep = 0;
+    uint64_t frameStart = 0; // 지금 주기가 시작된 사이클
+
+    uint64_t cycle = 0; // 여기까지 진행함
+
+    // 출력
+    static const uint32_t frameCycles = 29781; // 오디오 블록 (NTSC 1 프레임)
+    static const uint32_t clockRate = 1789773;
+    bool audioEnabled = true;
+    int sampleRate = 48000;
+    uint64_t blockStart = 0;
+    BlipBuffer blip;
+    std::vector<int16_t> samples; // 마지막 블록 (재사용)
+    std::function<void(const int16_t *samples, size_t count)> audioOutput;
+
+    std::function<uint8_t(uint16_t address)> readMemory; // DMC 샘플 읽기
+
+    static const uint16_t stateVersion = 1; // save state 형식이 바뀌면 증가
+
+    APU();
+
+    // save state (채널/프레임 카운터, BlipBuffer 는 출력이므로 제외)
+    void saveState(StateWriter &writer) const;
+    bool loadState(StateReader &reader);
+
+    void setAudioEnabled(bool enabled);
+    void setSampleRate(int rate);
+
+    void writeRegister(uint16_t address, uint8_t value); // $4000-$4013, $4015, $4017
+    uint8_t readStatus();                                // $4015 (프레임 IRQ 를 지움)
+
+    void runUntil(uint64_t target);
+    uint64_t nextEvent() const; // 이 사이클 전에 따라잡아야 함 (IRQ, 오디오 블록 끝)
+    bool irq() const { return frameIRQ || dmc.irq; }
+
+private:
+    void runChannels(uint64_t end);
+    void runPulse(Pulse &channel, uint64_t end);
+    void runTriangle(uint64_t end);
+    void runNoise(uint64_t end);
+    void runDMC(uint64_t end);
+    void clockDMC();
+    void fillDMCBuffer();
+
+    void clockFrame();
+    void quarterFrame();
+    void halfFrame();
+    uint64_t nextFrameEvent() const;
+    void endBlock();
+
+    int pulseOutput(const Pulse &channel) const;
+    int triangleOutput() const;
+    int noiseOutput() const;
+    void updateOutputs(uint64_t time);
+    void setOutput(int &output, int value, uint64_t time, int32_t weight);
+};
+
+#endif
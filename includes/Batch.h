@@ -0,0 +1,56 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "CPU.h"
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * headless 일괄 실행 (test.cpp 와 같이 바이너리를 $8000 에 올린 CPU 를 실행)
+ *
+ * manifest 한 줄 = 작업 하나, '#' 뒤는 주석
+ *   <binary file> <cycle budget> <exit condition> [interpreter|blocks|jit]
+ * exit condition
+ *   trap:<hex address>[=<value>]  해당 주소에 쓰면 종료 (값을 주면 그 값이어야 통과)
+ *   budget                        cycle budget 을 모두 쓰면 통과
+ */
+enum class BatchExit
+{
+    Trap,
+    Budget,
+};
+
+struct BatchJob
+{
+    std::string name;
+    std::vector<uint8_t> program;
+    uint64_t cycleBudget = 0;
+    BatchExit exit = BatchExit::Trap;
+    uint16_t trapAddress = 0xF001;
+    int expected = -1; // -1: 값은 보지 않음
+    ExecutionMode mode = ExecutionMode::Interpreter;
+};
+
+struct BatchResult
+{
+    bool passed = false;
+    int result = -1; // trap 주소의 값 (도달하지 못했으면 -1)
+    uint64_t cycles = 0;
+    uint64_t frames = 0; // 실행한 프레임 (29780 사이클) 수
+    double seconds = 0;
+    std::string error;
+};
+
+static const uint64_t batchFrameCycles = 29780;
+
+// 잘못된 줄이 있으면 false 와 함께 error 에 이유를 기록
+bool parseManifest(std::istream &manifest, std::vector<BatchJob> &jobs, std::string &error);
+
+// 작업마다 독립된 CPU 인스턴스를 만들어 실행
+BatchResult runBatchJob(const BatchJob &job);
+std::vector<BatchResult> runBatch(const std::vector<BatchJob> &jobs, unsigned threads = 0);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef BLIP_BUFFER_H
+#define BLIP_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * band-limited step 합성
+ * - 채널 출력이 바뀐 클럭 시점에 변화량(delta)만 기록하고, 프레임이 끝나면 적분해 호스트 샘플로 변환
+ * - delta 는 창을 씌운 sinc (taps 개, 샘플 사이 위치를 phases 단계로 양자화)로 퍼뜨려 기록하므로 에일리어싱이 없음
+ * - 출력 직전에 DC 성분을 걸러냄 (NES 출력은 0 이상)
+ * - 버퍼는 정수 (delta 를 기록하는 순서와 무관하게 같은 샘플이 나옴)
+ *
+ * time 은 프레임 시작부터의 클럭 수 (프레임마다 endFrame 으로 0 부터 다시 셈)
+ */
+class BlipBuffer
+{
+public:
+    static const int phases = 32;
+    static const int taps = 16;
+    static const int deltaBits = 16; // delta 1 << deltaBits = 출력 최대 (1.0)
+
+    BlipBuffer();
+
+    void setRates(double clockRate, int sampleRate, uint32_t maxFrameClocks);
+    void clear();
+
+    void addDelta(uint32_t time, int32_t delta)
+    {
+        uint64_t position = offset + time * factor;
+        const int32_t *kernel = kernels[(position >> (fractionBits - phaseBits)) & (phases - 1)];
+        int32_t *out = &buffer[position >> fractionBits];
+        for (int i = 0; i < taps; ++i)
+            out[i] += delta * kernel[i];
+    }
+
+    // time 까지의 샘플을 samples 에 만들고 프레임을 끝냄 (만든 샘플 수)
+    size_t endFrame(uint32_t time, std::vector<int16_t> &samples);
+
+private:
+    static const int fractionBits = 32;
+    static const int phaseBits = 5;
+    static const int kernelBits = 13; // 커널 행의 합
+
+    uint64_t factor = 0; // 클럭당 샘플 (32.32 고정 소수점)
+    uint64_t offset = 0; // 지난 프레임에서 남은 샘플 위치의 소수 부분
+    std::vector<int32_t> buffer;
+    int32_t kernels[phases][taps];
+    int32_t integrator = 0;
+    float dcInput = 0;
+    float dcOutput = 0;
+};
+
+#endif
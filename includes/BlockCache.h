@@ -0,0 +1,97 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include "CPU.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * 미리 디코딩된 명령어
+ * - fixed: 주소가 디코딩 시점에 결정됨 (Implied, Accumulator, Immediate, ZeroPage, Absolute, Relative)
+ * - 그 외 모드는 operand 로부터 실행 시점에 주소를 계산 (X/Y, 간접 주소)
+ */
+struct DecodedOp
+{
+    void (*operation)(CPU &, uint16_t);
+    uint16_t operand; // fixed 면 최종 주소, 아니면 명령어의 operand 바이트
+    uint16_t next;    // 다음 명령어 주소
+    AddressMode mode;
+    uint8_t opcode;
+    uint8_t cycles;
+    bool pageCycle;
+    bool fixed;
+    bool writes; // 메모리에 쓰는 명령어 (쓰기 후에만 무효화/halt 확인)
+};
+
+/**
+ * 분기/JMP/JSR/RTS/RTI/BRK 까지의 명령어 묶음
+ * - 디코딩한 페이지의 호스트 포인터를 기억해 두고, 뱅크가 바뀌었으면 다시 디코딩
+ */
+struct Block
+{
+    uint16_t start;
+    uint16_t end; // 마지막 명령어 다음 주소
+    const uint8_t *pageMemory[2];
+    std::vector<DecodedOp> ops;
+    uint32_t maxCycles; // 페이지/분기 추가 사이클까지 포함한 최대 사이클
+    uint32_t executions = 0;
+    bool valid = false;
+
+    void (*native)(CPU *) = nullptr; // JIT 컴파일 결과
+    bool nativeRejected = false;     // 컴파일할 수 없는 블록
+};
+
+/**
+ * PC 를 키로 하는 basic block 캐시
+ * - RAM 에 있는 블록은 해당 페이지를 bus 에서 감시하고, 쓰기가 일어나면 그 주소를 포함한 블록을 무효화
+ * - 블록 시작 주소가 decodeThreshold 번 실행될 때까지는 디코딩하지 않고 interpret() 로 실행
+ *   (한두 번 실행되는 코드는 디코딩 비용이 인터프리터로 실행하는 비용보다 큼)
+ */
+class BlockCache
+{
+public:
+    static const int maxBlockLength = 64;
+
+    struct Stats
+    {
+        uint64_t lookups = 0;
+        uint64_t hits = 0;
+        uint64_t decodes = 0;
+        uint64_t invalidations = 0;
+        uint64_t coldRuns = 0; // 디코딩하지 않고 interpret() 로 실행한 블록 수
+    };
+
+    Stats stats;
+    uint32_t generation = 0;     // 무효화가 일어날 때마다 증가
+    uint8_t decodeThreshold = 2; // 0 이면 처음 실행할 때 바로 디코딩
+
+    explicit BlockCache(CPU &cpu);
+    ~BlockCache();
+    BlockCache(const BlockCache &) = delete;
+    BlockCache &operator=(const BlockCache &) = delete;
+
+    Block *lookup(uint16_t pc); // 아직 차갑거나 캐시할 수 없는 위치면 nullptr
+    void execute(Block &block, uint64_t targetCycles);
+    void interpret(uint64_t targetCycles);
+    void invalidate(uint16_t address);
+    void flush();
+
+    static uint16_t resolveAddress(CPU &cpu, const DecodedOp &op);
+
+    std::vector<Block> blocks; // 블록 저장소 (인덱스로 참조)
+
+private:
+    CPU &cpu;
+    std::vector<int32_t> blockIndex;              // pc -> blocks 인덱스 (-1: 없음)
+    std::vector<uint8_t> visits;                  // pc -> 블록 없이 실행된 횟수 (decodeThreshold 까지)
+    std::vector<uint16_t> codeBytes;              // 주소 -> 그 바이트를 포함한 블록 수
+    std::vector<std::vector<int32_t>> pageBlocks; // 페이지 -> 그 페이지에 걸친 블록들
+    std::vector<int32_t> freeBlocks;
+    bool watchedPages[Bus::pageCount] = {};
+
+    bool decode(Block &block, uint16_t pc);
+    void release(int32_t index);
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef BUS_H
+#define BUS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * memory-mapped IO 핸들러
+ * - context 는 보통 핸들러를 등록한 컴포넌트 (예: PPU)
+ */
+struct IOHandler
+{
+    uint8_t (*read)(void *context, uint16_t address);
+    void (*write)(void *context, uint16_t address, uint8_t value);
+    void *context;
+};
+
+/**
+ * 256바이트 페이지 단위 CPU 주소 버스
+ * - 메모리 페이지: 호스트 포인터로 바로 읽기/쓰기 (RAM, ROM)
+ * - IO 페이지: IOHandler 를 통해 읽기/쓰기 (PPU/APU 레지스터 등)
+ * - 뱅크 스위칭은 페이지 테이블의 포인터만 바꾸면 됨 (memcpy 없음)
+ *
+ * readPages/writePages 가 nullptr 이면 느린 경로(readSlow/writeSlow)로 처리.
+ * - 쓰기 금지(ROM) 페이지, IO 페이지, 감시(watch) 중인 페이지가 여기에 해당.
+ */
+class Bus
+{
+public:
+    static const int pageCount = 256;
+
+    struct Page
+    {
+        uint8_t *memory = nullptr; // 페이지 시작 주소 (메모리 페이지)
+        bool writable = false;
+        const IOHandler *handler = nullptr; // IO 페이지
+        const IOHandler *romWriter = nullptr; // ROM 페이지에 쓰기 (매퍼 레지스터), 읽기는 memory 로
+        uint8_t watched = 0;                // 0 이 아니면 쓰기 후 watcher 호출 (감시자 수)
+    };
+
+    Page pages[pageCount];
+    uint8_t *readPages[pageCount];  // 빠른 경로 (페이지 시작 주소)
+    uint8_t *writePages[pageCount]; // 빠른 경로 (페이지 시작 주소)
+
+    // 감시 중인 페이지에 쓰기가 일어나면 (쓰기 이후) 호출
+    void (*watcher)(void *context, uint16_t address) = nullptr;
+    void *watcherContext = nullptr;
+
+    uint32_t mapGeneration = 0; // 매핑이 바뀔 때마다 증가
+
+    Bus();
+
+    // [firstPage, firstPage + count) 페이지를 memory 에 연결 (size 보다 크면 미러링)
+    void mapMemory(uint8_t firstPage, int count, uint8_t *memory, size_t size, bool writable);
+    void mapROM(uint8_t firstPage, int count, const uint8_t *memory, size_t size, const IOHandler *writer = nullptr);
+    void mapHandler(uint8_t firstPage, int count, const IOHandler *handler);
+    void unmap(uint8_t firstPage, int count);
+    void watch(uint8_t page, bool enable); // 감시자 수를 증감 (trap, 코드 캐시가 같은 페이지를 감시할 수 있음)
+
+    uint8_t read(uint16_t address)
+    {
+        uint8_t *page = readPages[address >> 8];
+        if (page)
+            return page[address & 0xFF];
+        return readSlow(address);
+    }
+
+    void write(uint16_t address, uint8_t value)
+    {
+        uint8_t *page = writePages[address >> 8];
+        if (page)
+            page[address & 0xFF] = value;
+        else
+            writeSlow(address, value);
+    }
+
+    uint8_t readSlow(uint16_t address);
+    void writeSlow(uint16_t address, uint8_t value);
+
+private:
+    void updateFastPath(uint8_t page);
+};
+
+#endif
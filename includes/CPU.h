@@ -1,9 +1,11 @@
 #ifndef CPU_H
 #define CPU_H
 
+#include "Bus.h"
+
+#include <array>
 #include <cstdint>
-#include <functional>
-#include <unordered_map>
+#include <memory>
 #include <vector>
 
 enum class AddressMode
@@ -23,12 +25,30 @@ enum class AddressMode
     Relative
 };
 
+class CPU;
+class BlockCache;
+class JIT;
+class StateWriter;
+class StateReader;
+
+enum class ExecutionMode
+{
+    Interpreter, // 명령어마다 fetch/decode
+    BlockCache,  // 미리 디코딩한 basic block 실행
+    JIT,         // 자주 실행되는 block 을 x86-64 코드로 컴파일 (지원하지 않으면 BlockCache)
+};
+
+// operation == nullptr 이면 정의되지 않은 opcode
 struct Instruction
 {
-    std::function<void(uint16_t)> operation;
-    AddressMode mode;
+    void (*operation)(CPU &, uint16_t) = nullptr;
+    AddressMode mode = AddressMode::Implied;
+    uint8_t cycles = 2;     // 기본 사이클 수
+    bool pageCycle = false; // 인덱스 주소가 페이지를 넘으면 +1 사이클 (읽기 명령어)
 };
 
+using InstructionTable = std::array<Instruction, 256>;
+
 class CPU
 {
 public:
@@ -37,26 +57,72 @@ public:
     uint8_t y = 0x00;  // Y Register
     uint8_t sp = 0xFF; // Stack Pointer
 
-    uint8_t stat = 0x00;  // Processor Status Register
+    /*
+     * Processor Status Register
+     * - stat: 밖에서 읽고 쓰는 값, run()/execute()/reset()/nmi()/irq() 가 끝날 때 만들고 시작할 때 다시 반영
+     * - 실행 중에는 C/Z/V/N 을 명령어마다 계산하지 않고 마지막 결과만 기록해 두었다가 getStat() 에서 계산
+     * - statBits 에는 I/D/B/U 만 유효
+     */
+    uint8_t stat = 0x00;
+    uint8_t statBits = 0x00;
+    uint8_t carry = 0;          // C (0 또는 1)
+    uint8_t zeroResult = 1;     // Z = (zeroResult == 0)
+    uint8_t negativeResult = 0; // N = bit 7
+    uint8_t overflowResult = 0; // V = bit 7
     uint16_t pc = 0x0000; // Program Counter
 
-    std::vector<uint8_t> memory;                             // 64KB 메모리
-    std::unordered_map<uint8_t, Instruction> instructionSet; // Opcode 테이블
+    uint64_t cycles = 0;       // 지금까지 소비한 CPU 사이클
+    uint64_t instructions = 0; // 지금까지 실행한 명령어 수
+    bool pageCrossed = false;  // 마지막 주소 계산에서 페이지 경계를 넘었는지
+
+    int32_t trapAddress = -1; // 이 주소에 쓰기가 일어나면 halt (-1: 없음)
+    bool halted = false;
+
+    ExecutionMode executionMode = ExecutionMode::Interpreter;
+    std::unique_ptr<BlockCache> blockCache;
+    std::unique_ptr<JIT> jit;
+
+    Bus bus;                     // CPU 주소 공간 (페이지 테이블)
+    std::vector<uint8_t> memory; // 64KB 기본 메모리 (생성 시 전체 주소 공간에 그대로 매핑)
+
+    static const InstructionTable instructionSet; // Opcode 테이블 (모든 CPU 인스턴스가 공유)
+    static const uint16_t stateVersion = 1;       // save state 형식이 바뀌면 증가
 
     CPU();
+    ~CPU();
+    CPU(const CPU &) = delete; // bus 가 this 를 참조
+    CPU &operator=(const CPU &) = delete;
 
     uint8_t read(uint16_t address);
     uint16_t read16(uint16_t address, bool wrapAround);
     void write(uint16_t address, uint8_t value);
-    void execute();
+    void execute(); // 명령어 하나 (stat 반영 포함)
+    uint64_t run(uint64_t cycleBudget);
+    void setExecutionMode(ExecutionMode mode);
+    void setTrap(uint16_t address);
+
+    // save state (버퍼를 재사용하면 할당 없음, 불러오면 코드 캐시를 비움)
+    void saveState(StateWriter &writer) const;
+    bool loadState(StateReader &reader);
+    void saveState(std::vector<uint8_t> &buffer) const;
+    bool loadState(const std::vector<uint8_t> &buffer);
+
+    static void onWatchedWrite(void *context, uint16_t address);
     uint8_t fetch();
     uint16_t fetchAbsolute();
     uint8_t fetchZeroPage(uint8_t offset);
+    uint16_t indexAddress(uint16_t base, uint8_t index);
     uint16_t fetchAddress(AddressMode mode);
     void setZNFlag(uint8_t value);
+    uint8_t getStat() const;
+    void setStat(uint8_t value);
+    void loadStat() { setStat(stat); }   // 밖에서 바꾼 stat 을 lazy 필드로
+    void storeStat() { stat = getStat(); } // lazy 필드를 stat 으로
+    void executeInstruction();
+    uint64_t runInstructions(uint64_t cycleBudget);
 
     /* Instruction set */
-    void setupInstructionSet();
+    static InstructionTable setupInstructionSet();
 
     // Access
     void LDA(uint16_t address);
@@ -83,9 +149,13 @@ public:
     void DEY();
 
     // Shift
+    void ASL();
     void ASL(uint16_t address);
+    void LSR();
     void LSR(uint16_t address);
+    void ROL();
     void ROL(uint16_t address);
+    void ROR();
     void ROR(uint16_t address);
 
     // Bitwise
@@ -100,6 +170,7 @@ public:
     void CPY(uint16_t address);
 
     // branch
+    void branch(bool condition, uint16_t address);
     void BCC(uint16_t address);
     void BCS(uint16_t address);
     void BEQ(uint16_t address);
@@ -136,6 +207,12 @@ public:
     // Other
     void NOP();
 
+    // Interrupt
+    void reset();
+    void nmi();
+    void irq();
+    void interrupt(uint16_t vector);
+
     /* debug */
     void debugStack();
 };
@@ -0,0 +1,55 @@
+#ifndef CARTRIDGE_H
+#define CARTRIDGE_H
+
+#include "PPU.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * iNES / NES 2.0 롬 파일
+ * - 파일을 읽기 전용으로 mmap 하고 헤더만 해석 (PRG/CHR 를 복사하지 않으므로 로드 시간이 롬 크기와 무관)
+ * - prg/chr 는 매핑된 파일 안을 가리키는 view (Cartridge 가 살아 있는 동안 유효)
+ * - chrSize 가 0 이면 CHR-RAM (PPU 내장 8KB 를 씀)
+ *
+ * 헤더 (16바이트)
+ * - 4: PRG 16KB 단위, 5: CHR 8KB 단위
+ * - 6: [0] 미러링 (1: vertical), [1] 배터리, [2] trainer 512바이트, [3] 4화면, [7:4] 매퍼 하위
+ * - 7: [3:2] == 2 이면 NES 2.0, [7:4] 매퍼 상위
+ * - NES 2.0: 8 [3:0] 매퍼 [11:8], [7:4] 서브매퍼 / 9 PRG, CHR 크기 상위 / 10, 11 RAM 크기 (64 << n)
+ */
+class Cartridge
+{
+public:
+    const uint8_t *prg = nullptr;
+    size_t prgSize = 0;
+    const uint8_t *chr = nullptr;
+    size_t chrSize = 0;
+
+    uint16_t mapper = 0;
+    uint8_t submapper = 0;
+    Mirroring mirroring = Mirroring::Horizontal;
+    bool fourScreen = false;
+    bool battery = false;
+    bool nes20 = false;
+    size_t prgRAMSize = 0x2000;
+    size_t chrRAMSize = 0;
+
+    Cartridge() = default;
+    ~Cartridge();
+    Cartridge(const Cartridge &) = delete; // 매핑을 소유
+    Cartridge &operator=(const Cartridge &) = delete;
+
+    // 실패하면 false 와 이유 (파일을 열 수 없음, 헤더가 잘못됨, 크기가 맞지 않음)
+    bool open(const std::string &path, std::string &error);
+    // 이미 메모리에 있는 이미지 (data 는 Cartridge 보다 오래 살아야 함)
+    bool parse(const uint8_t *data, size_t size, std::string &error);
+    void close();
+
+private:
+    void *mapping = nullptr;
+    size_t mappingSize = 0;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include "Palette.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * 256x240 색 번호 더블 버퍼 (row-major, 행 간격 = pitch 바이트, 64바이트 정렬)
+ * - 픽셀은 NES 색 번호(0 ~ 63, grayscale 적용 후) 1바이트, emphasis 는 행마다 1바이트
+ * - PPU 는 back 프레임에 그리고, 프레임이 끝나면 present() 로 front/back 을 교체
+ * - 소비자는 front 프레임을 복사 없이 읽음 (잠금 없음), RGBA 가 필요할 때만 toRGBA() 로 변환
+ * - front 는 다음 present() 까지만 유효: 읽은 뒤 sequence() 가 그대로면 그동안 덮어쓰이지 않은 것
+ * - present() 할 때 직전 프레임과 비교해 바뀐 8x8 타일을 dirty 로 표시 (인코더/스트리머는 dirty 타일만 처리)
+ *
+ * 어느 쪽이 front 인지는 sequence 의 최하위 비트로 정해지므로 atomic 변수 하나로 교체가 끝남
+ */
+class FrameBuffer
+{
+public:
+    static const int width = 256;
+    static const int height = 240;
+    static const int pitch = 256; // 한 행의 바이트 수
+    static const int tileColumns = width / 8;
+    static const int tileRows = height / 8;
+
+    struct View
+    {
+        const uint8_t *pixels;   // pitch * height
+        const uint8_t *emphasis; // height
+        const uint32_t *dirty;   // tileRows, dirty[row] 의 bit column = 그 타일이 직전 프레임과 다름
+        uint64_t sequence;
+    };
+
+    FrameBuffer() : frames(new Frame[2]()) {}
+    FrameBuffer(const FrameBuffer &) = delete;
+    FrameBuffer &operator=(const FrameBuffer &) = delete;
+
+    // 생산자 (PPU)
+    uint8_t *backRow(int y) { return backFrame().pixels + y * pitch; }
+    void setBackEmphasis(int y, uint8_t emphasis) { backFrame().emphasis[y] = emphasis; }
+    void present();
+
+    // 소비자
+    uint64_t sequence() const { return sequenceNumber.load(std::memory_order_acquire); } // present() 된 프레임 수
+    View front() const { return view(sequence()); }
+    View back() const { return view(sequence() + 1); } // 그리는 중인 프레임
+    const uint8_t *frontBuffer(uint64_t *frameSequence = nullptr) const
+    {
+        View frame = front();
+        if (frameSequence)
+            *frameSequence = frame.sequence;
+        return frame.pixels;
+    }
+
+    // 색 변환 (SIMD), out 의 행 간격은 outPitch 픽셀
+    static void toRGBA(const View &frame, uint32_t *out, size_t outPitch,
+                       const RGBAPalette &palette = defaultPalette());
+    // 색 변환 없이 프레임 비교/기록용 해시 (64비트)
+    static uint64_t hash(const View &frame);
+    // 두 프레임에서 다른 8x8 타일 (SIMD), dirty 는 tileRows 개
+    static void diff(const View &previous, const View &current, uint32_t *dirty);
+    static int dirtyTiles(const View &frame); // dirty 타일 수
+
+private:
+    struct alignas(64) Frame
+    {
+        uint8_t pixels[pitch * height];
+        uint8_t emphasis[height];
+        uint32_t dirty[tileRows];
+    };
+
+    std::unique_ptr<Frame[]> frames;
+    std::atomic<uint64_t> sequenceNumber{0};
+
+    Frame &backFrame() { return frames[(sequenceNumber.load(std::memory_order_relaxed) + 1) & 1]; }
+    View view(uint64_t sequence) const
+    {
+        const Frame &frame = frames[sequence & 1];
+        return {frame.pixels, frame.emphasis, frame.dirty, sequence};
+    }
+};
+
+#endif
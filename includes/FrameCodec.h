@@ -0,0 +1,61 @@
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include "FrameBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct CodecState;
+
+/**
+ * 색 번호 프레임 무손실 압축 (보관용 스트림)
+ * 패킷 하나 = 프레임 하나: [varint 크기][flags][range coder 바이트]
+ * - 직전 프레임과 다른 8x8 타일만 기록: 바뀌지 않은 구간과 바뀐 구간의 타일 수를 번갈아 (raster 순서, RLE)
+ * - 바뀐 타일은 색 수로 나눔: 16색 이하는 타일 팔레트 + 픽셀마다 "왼쪽과 같음" 비트, 다르면 0 ~ 4비트 번호
+ *   (왼쪽, 위쪽 번호가 문맥), 그 이상은 픽셀마다 색 번호 (왼쪽 색이 문맥)
+ * - emphasis 는 바뀐 프레임에만 행마다 3비트
+ * - 모든 기호는 적응형 이진 range coder (LZMA 방식) 로 부호화, 확률 모델은 프레임 사이에 이어짐
+ * - keyframeInterval 프레임마다 직전 프레임 (모두 0) 과 확률 모델을 초기화하므로 keyframe 부터는 따로 풀 수 있음
+ *
+ * 픽셀은 FrameBuffer 와 같은 색 번호 (0 ~ 63), emphasis 는 3비트
+ */
+class FrameEncoder
+{
+public:
+    explicit FrameEncoder(uint32_t keyframeInterval = 600);
+    ~FrameEncoder();
+    FrameEncoder(const FrameEncoder &) = delete;
+    FrameEncoder &operator=(const FrameEncoder &) = delete;
+
+    void encode(const FrameBuffer::View &frame, std::vector<uint8_t> &out); // 패킷을 out 뒤에 붙임
+    uint64_t frames() const { return count; }
+
+private:
+    std::unique_ptr<CodecState> state;
+    std::vector<uint8_t> packet; // 재사용
+    uint32_t keyframeInterval;
+    uint64_t count = 0;
+};
+
+class FrameDecoder
+{
+public:
+    FrameDecoder();
+    ~FrameDecoder();
+    FrameDecoder(const FrameDecoder &) = delete;
+    FrameDecoder &operator=(const FrameDecoder &) = delete;
+
+    // 패킷 하나를 풀어 frame() 을 갱신하고 읽은 바이트 수를 돌려줌 (0: 입력이 모자라거나 잘못됨)
+    size_t decode(const uint8_t *data, size_t size);
+    // 다음 decode() 까지 유효, dirty = 직전 프레임과 다른 타일
+    FrameBuffer::View frame() const;
+
+private:
+    std::unique_ptr<CodecState> state;
+    uint64_t count = 0;
+};
+
+#endif
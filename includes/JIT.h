@@ -0,0 +1,54 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "BlockCache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * x86-64 동적 재컴파일러 (BlockCache 위에서 동작)
+ * - 일정 횟수 이상 실행된 블록을 mmap 한 버퍼에 네이티브 코드로 컴파일 (W^X: 쓰기와 실행 권한을 동시에 주지 않음)
+ * - a/x/y/sp/stat 은 호스트 레지스터에 유지 (r12/r13/r14/r15/ebx, rbp = CPU*)
+ * - 레지스터/즉시값/고정 주소 명령어는 직접 생성하고, 나머지는 인터프리터 핸들러를 호출
+ * - 메모리 접근은 bus 페이지 테이블을 직접 보고, IO/감시 페이지면 bus 로 호출
+ * - 자기 수정 코드/매핑 변경/halt 가 일어나면 그 명령어 직후 블록을 빠져나옴
+ */
+class JIT
+{
+public:
+    using NativeBlock = void (*)(CPU *);
+
+    static const size_t codeBufferSize = 4 << 20;
+    uint32_t hotThreshold = 64; // 이만큼 실행된 블록을 컴파일
+
+    struct Stats
+    {
+        uint64_t compiled = 0;
+        uint64_t nativeRuns = 0;
+        uint64_t flushes = 0;
+    };
+
+    Stats stats;
+
+    explicit JIT(CPU &cpu);
+    ~JIT();
+    JIT(const JIT &) = delete;
+    JIT &operator=(const JIT &) = delete;
+
+    static bool supported();
+    bool available() const { return code != nullptr; }
+
+    NativeBlock compile(Block &block);
+    void flush();
+
+private:
+    CPU &cpu;
+    uint8_t *code = nullptr; // mmap (평소에는 RX, 컴파일한 코드를 복사하는 동안만 해당 페이지를 RW)
+    size_t thunkSize = 0; // 버퍼 앞부분의 인터프리터 핸들러 호출 코드
+    size_t used = 0;
+    std::vector<uint8_t> out; // 컴파일 중인 코드
+};
+
+#endif
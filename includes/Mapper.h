@@ -0,0 +1,56 @@
+#ifndef MAPPER_H
+#define MAPPER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class NES;
+class Cartridge;
+class StateWriter;
+class StateReader;
+
+/**
+ * 카트리지 매퍼 (NROM 0, MMC1 1, UxROM 2, CNROM 3, MMC3 4)
+ * - $8000-$FFFF 쓰기로 레지스터를 바꾸고, 뱅크 스위칭은 CPU 버스 / PPU CHR 페이지 테이블의 포인터 교체
+ * - 뱅크 번호가 롬 크기를 넘으면 롬 크기로 나눈 나머지 (음수는 끝에서부터)
+ * - irq: 카트리지 IRQ 선 (레벨, 매퍼가 직접 내림)
+ */
+class Mapper
+{
+public:
+    bool irq = false;
+
+    static const uint16_t stateVersion = 1; // save state 형식이 바뀌면 증가
+
+    virtual ~Mapper() = default;
+
+    // 지원하지 않는 매퍼면 nullptr 와 이유
+    static std::unique_ptr<Mapper> create(NES &nes, const Cartridge &cartridge, std::string &error);
+
+    virtual void reset() = 0; // 전원을 켰을 때의 레지스터와 뱅크 배치
+    virtual void write(uint16_t address, uint8_t value) = 0;
+    virtual void scanline() {} // PPU 가 렌더링 중인 줄마다 (MMC3 IRQ 카운터)
+    virtual bool countsScanlines() const { return false; } // IRQ 가 켜져 있어 PPU 를 명령어마다 따라잡아야 함
+
+    // save state (레지스터만 기록하고, 읽은 뒤 뱅크 배치를 다시 적용)
+    void saveState(StateWriter &writer) const;
+    bool loadState(StateReader &reader);
+
+protected:
+    Mapper(NES &nes, const Cartridge &cartridge);
+
+    NES &nes;
+    const Cartridge &cartridge;
+
+    virtual void saveRegisters(StateWriter &) const {}
+    virtual void loadRegisters(StateReader &) {}
+    virtual void apply() = 0; // 레지스터에 맞게 뱅크 배치
+
+    void mapPRG(uint8_t firstPage, size_t size, int bank); // size 바이트 뱅크를 $firstPage00 부터
+    void mapCHR(int firstPage, int pageCount, int bank);   // pageCount KB 뱅크를 PPU 의 firstPage KB 부터
+    void setMirroring(int mode); // 0: 한 화면 (아래), 1: 한 화면 (위), 2: vertical, 3: horizontal
+};
+
+#endif
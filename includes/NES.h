@@ -0,0 +1,111 @@
+#ifndef NES_H
+#define NES_H
+
+#include "APU.h"
+#include "CPU.h"
+#include "Cartridge.h"
+#include "Mapper.h"
+#include "PPU.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class PPUScheduling
+{
+    LockStep, // 명령어마다 PPU 를 진행
+    CatchUp,  // PPU 레지스터 / OAM DMA 접근, NMI 가 날 때만 밀린 dot 을 한 번에 진행
+};
+
+/**
+ * CPU 주소 공간 구성
+ * - $0000-$07FF: 내부 RAM 2KB ($1FFF 까지 미러)
+ * - $2000-$2007: PPU 레지스터 ($3FFF 까지 미러)
+ * - $4000-$401F: APU / IO 레지스터 ($4014: OAM DMA, $4015: APU 상태, $4016/$4017: 컨트롤러)
+ * - $6000-$7FFF: PRG-RAM 8KB
+ * - $8000-$FFFF: PRG-ROM (16KB 면 미러, 카트리지가 있으면 매퍼가 배치하고 쓰기는 매퍼 레지스터로)
+ */
+class NES
+{
+public:
+    CPU cpu;
+    PPU ppu;
+    APU apu;
+
+    std::vector<uint8_t> ram;
+    std::vector<uint8_t> prgRAM;
+    std::vector<uint8_t> prgROM;
+
+    std::unique_ptr<Cartridge> cartridge; // mapper 가 참조하므로 먼저 선언 (나중에 해제)
+    std::unique_ptr<Mapper> mapper;
+
+    bool nmiPending = false;
+    bool dmaPending = false; // $4014 에 쓴 명령어가 끝나면 oamDMA(dmaPage)
+    uint8_t dmaPage = 0;
+
+    /**
+     * 표준 컨트롤러 2개
+     * - buttons: 프론트엔드가 설정하는 현재 입력 (bit 0 부터 A, B, Select, Start, Up, Down, Left, Right)
+     * - $4016 bit 0 = 1 (strobe) 인 동안 계속 buttons 를 래치, 0 이 되면 읽을 때마다 한 비트씩 밀어냄
+     * - 읽기는 bit 0 에 버튼, 나머지는 open bus ($40), 8번 읽은 뒤에는 1
+     */
+    uint8_t buttons[2] = {};
+    bool controllerStrobe = false;
+    uint8_t controllerShift[2] = {};
+
+    /**
+     * PPU 스케줄링
+     * - ppuTargetDot: CPU 가 진행한 만큼의 PPU dot (CPU 1 사이클 = 3 dot), ppu.dot 은 실제로 진행한 dot
+     * - ppuDeadline: 이 dot 에 다다르면 vblank NMI 가 나므로 그 전에 따라잡음
+     * - 어느 방식이든 결과(NMI 시점, 레지스터 값, 화면)는 같음
+     */
+    PPUScheduling ppuScheduling = PPUScheduling::CatchUp;
+    uint64_t ppuTargetDot = 0;
+    uint64_t ppuDeadline = 0;
+
+    /**
+     * APU 는 항상 필요할 때 따라잡음: APU 레지스터 접근, 매퍼 쓰기(DMC 가 읽는 뱅크), apuDeadline (IRQ / 오디오 블록 끝)
+     */
+    uint64_t apuDeadline = 0;
+
+    static const uint16_t stateVersion = 4; // save state 형식이 바뀌면 증가
+
+    NES();
+    NES(const NES &) = delete; // 핸들러가 this 를 참조
+    NES &operator=(const NES &) = delete;
+
+    void loadPRG(const std::vector<uint8_t> &prg);
+    // iNES / NES 2.0 파일을 mmap 하고 매퍼의 초기 뱅크를 배치 (CPU 리셋은 호출하는 쪽에서)
+    bool loadCartridge(const std::string &path, std::string &error);
+    void mapPRGBank(uint8_t firstPage, int count, const uint8_t *bank, size_t size);
+
+    void step();
+    void setAudioEnabled(bool enabled); // false: headless (합성 / 오디오 블록 없음, 게임이 보는 APU 상태는 그대로)
+    void syncPPU(); // PPU 를 CPU 시점까지 진행 (미뤄 둔 scanline 포함, 화면/레지스터를 밖에서 읽기 전에)
+
+    // save state (CPU + PPU + APU + RAM + 매퍼 레지스터, PRG/CHR-ROM 은 제외, 저장 전에 PPU/APU 를 따라잡음)
+    void saveState(std::vector<uint8_t> &buffer);
+    bool loadState(const std::vector<uint8_t> &buffer);
+
+    // IO 핸들러
+    static uint8_t readPPURegister(void *context, uint16_t address);
+    static void writePPURegister(void *context, uint16_t address, uint8_t value);
+    static uint8_t readIORegister(void *context, uint16_t address);
+    static void writeIORegister(void *context, uint16_t address, uint8_t value);
+    static uint8_t readMapperRegister(void *context, uint16_t address);
+    static void writeMapperRegister(void *context, uint16_t address, uint8_t value);
+
+    void oamDMA(uint8_t page);
+    static uint32_t oamDMACycles(uint64_t cycle) { return 513 + (cycle & 1); } // 홀수 사이클에 시작하면 1 사이클 더
+
+private:
+    void catchUpPPU();
+    void catchUpAPU();
+
+    IOHandler ppuRegisters;
+    IOHandler ioRegisters;
+    IOHandler mapperRegisters;
+};
+
+#endif
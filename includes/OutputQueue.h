@@ -0,0 +1,60 @@
+#ifndef OUTPUT_QUEUE_H
+#define OUTPUT_QUEUE_H
+
+#include "FrameBuffer.h"
+#include "SPSCQueue.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 에뮬레이션 스레드 -> 소비자 스레드 (화면 출력, 녹화) 로 프레임과 오디오를 넘기는 큐
+ * - 에뮬레이션 쪽 push 는 미리 할당한 슬롯에 복사만 함 (할당, mutex 없음)
+ * - 소비자는 pop() 한 슬롯을 다음 pop() 까지 복사 없이 읽음
+ */
+
+// FrameBuffer 의 front 프레임 복사본
+struct QueuedFrame
+{
+    alignas(64) uint8_t pixels[FrameBuffer::pitch * FrameBuffer::height];
+    uint8_t emphasis[FrameBuffer::height];
+    uint64_t sequence; // FrameBuffer::sequence()
+
+    FrameBuffer::View view() const { return {pixels, emphasis, nullptr, sequence}; } // dirty 는 없음
+};
+
+class FrameQueue
+{
+public:
+    explicit FrameQueue(size_t slots = 4, OverflowPolicy policy = OverflowPolicy::DropOldest) : queue(slots, policy) {}
+
+    bool push(const FrameBuffer::View &frame); // 생산자 (DropNewest 로 버려지면 false)
+    const QueuedFrame *pop() { return queue.pop(); }
+
+    SPSCQueue<QueuedFrame> queue;
+};
+
+// 샘플 블록 (push 한 span 이 capacity 보다 길면 여러 블록으로 나뉨)
+struct AudioBlock
+{
+    static const size_t capacity = 2048;
+    size_t count;
+    uint64_t first; // 지금까지 push 된 샘플 중 이 블록의 첫 샘플 번호 (버린 샘플 확인용)
+    int16_t samples[capacity];
+};
+
+class AudioQueue
+{
+public:
+    explicit AudioQueue(size_t slots = 16, OverflowPolicy policy = OverflowPolicy::Block) : queue(slots, policy) {}
+
+    size_t push(const int16_t *samples, size_t count); // 생산자, 큐에 넣은 샘플 수
+    const AudioBlock *pop() { return queue.pop(); }
+
+    SPSCQueue<AudioBlock> queue;
+
+private:
+    uint64_t produced = 0; // push 된 샘플 수
+};
+
+#endif
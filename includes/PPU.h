@@ -1,10 +1,29 @@
 #ifndef PPU_H
 #define PPU_H
 
+#include "FrameBuffer.h"
+
 #include <cstdint>
 #include <functional>
 #include <vector>
 
+class StateWriter;
+class StateReader;
+
+enum class Mirroring
+{
+    Horizontal,
+    Vertical,
+    SingleScreenLower,
+    SingleScreenUpper,
+};
+
+enum class RenderMode
+{
+    Dot,      // dot 마다 render()
+    Scanline, // 레지스터 접근이 없는 visible scanline 은 한 줄을 한 번에 그림
+};
+
 enum PipelineState
 {
     PreRender,
@@ -44,11 +63,20 @@ public:
     bool sprZeroHit; // 특정 픽셀에서 스프라이트0과 배경이 겹치면 set.
     bool vblankFlag;
 
+    uint8_t readBuffer; // PPUDATA 읽기 버퍼 (팔레트 외 영역은 한 번 늦게 읽힘)
+
     // OAM
     uint8_t oamAddr; // 스프라이트 evaluation 시작 주소
-    std::vector<uint32_t> oam;
-    std::vector<uint8_t> soam;
-    std::vector<uint8_t> sprShifters;
+    std::vector<uint8_t> oam; // 스프라이트 64개 × 4바이트 (y, tile, attr, x), 하드웨어와 같은 배치
+    uint8_t soam[8];    // 다음 줄에 그릴 스프라이트의 oam 인덱스 (evaluation 결과)
+    uint8_t soamCount;
+
+    /**
+     * 스프라이트 라인 버퍼: 다음 줄의 스프라이트 픽셀을 cycle 258 에 한 번에 그려 둠
+     * - [4:0] 스프라이트 픽셀 (0x10 | 팔레트 << 2 | 픽셀), 0x20: 배경 앞, 0x40: 스프라이트 0 (0 이면 투명)
+     * - 한 픽셀에 여러 스프라이트가 겹치면 인덱스가 낮은 불투명 픽셀
+     */
+    uint8_t sprLine[256];
 
     // Internal registers
     uint16_t v; // [14-12]: fine Y, [11-10]: nametable, [9-5]: coarseY(타일 y축 위치), [4-0]: coarseX(타일 x축 위치)
@@ -67,12 +95,77 @@ public:
     PipelineState pipelineState;
 
     std::vector<uint8_t> palette;
-    std::vector<std::vector<uint32_t>> pBuffer;
+    FrameBuffer frameBuffer; // 화면 출력 (visible scanline 이 끝나면 present)
+
+    // VRAM
+    std::vector<uint8_t> chr;  // 내장 CHR-RAM 8KB (카트리지가 CHR-ROM 을 연결하지 않으면 패턴 테이블)
+    std::vector<uint8_t> vram; // 네임 테이블 2KB ($2000-$2FFF, 미러링)
+    Mirroring mirroring;
+
+    /**
+     * 패턴 테이블 ($0000-$1FFF) 의 1KB 페이지 테이블
+     * - 매퍼가 CHR 뱅크를 바꾸면 포인터만 교체 (복사 없음), 바뀐 페이지의 타일 캐시만 무효화
+     * - CHR-ROM 페이지는 쓰기 금지
+     */
+    static const int chrPageCount = 8;
+    uint8_t *chrPages[chrPageCount];
+    bool chrWritable[chrPageCount];
+
+    /**
+     * 디코딩된 CHR 타일 캐시 (두 패턴 테이블의 512 타일, 픽셀당 1바이트 = 0~3)
+     * - 타일마다 8행 × 8픽셀, 왼쪽 픽셀부터 저장하고 스프라이트용 좌우 반전본을 따로 둠
+     * - chr 에 쓰면 해당 타일만 dirty 로 표시하고, 다음에 읽을 때 다시 디코딩
+     */
+    struct TileCacheStats
+    {
+        uint64_t decodes = 0;          // 누적 디코딩 타일 수
+        uint32_t frameDecodes = 0;     // 이번 프레임
+        uint32_t lastFrameDecodes = 0; // 직전 프레임
+    };
+
+    static const int tileCount = 512;
+    std::vector<uint8_t> tiles;
+    std::vector<uint8_t> flippedTiles;
+    std::vector<uint8_t> tileDirty;
+    TileCacheStats tileStats;
 
     // vblank
     std::function<void(void)> vblankNMI;
+    // 렌더링 중 각 줄의 cycle 260 (스프라이트 패턴을 읽으며 A12 가 올라가는 시점, MMC3 IRQ 카운터)
+    std::function<void(void)> scanlineCounter;
+
+    /**
+     * scanline 렌더러
+     * - visible scanline 이 시작되면 dot 을 바로 처리하지 않고 pendingDots 에 모았다가, 한 줄이 다 차면 renderScanline()
+     * - 그 사이에 레지스터에 접근하면 sync() 로 모아 둔 dot 을 render() 로 처리하고, 그 줄의 나머지도 dot 단위로 처리
+     */
+    RenderMode renderMode;
+    uint32_t pendingDots;
+    static const uint32_t scanlineDots = 341;
+    uint64_t dot; // tick() 으로 받은 누적 dot 수 (pendingDots 포함, save state 에는 없음)
+
+    /**
+     * frame skip: frameSkip 프레임을 건너뛰고 1 프레임을 그림 (0 이면 모두 그림)
+     * - 건너뛰는 프레임도 cycle/scanline/pipelineState, vblank NMI, 상태 플래그, v 는 그대로 진행
+     * - 픽셀(배경 쉬프터, 합성, 프레임 버퍼)은 만들지 않고 present() 도 하지 않음
+     * - sprite 0 hit 은 스프라이트 0 이 있는 줄에서만 그 8픽셀 아래의 배경 타일 행으로 계산
+     */
+    uint32_t frameSkip;
+    uint32_t skippedFrames; // 마지막으로 그린 뒤 건너뛴 프레임 수
+    bool skipFrame;         // 지금 프레임을 건너뛰는 중
+    bool sprZeroInLine;     // sprLine 에 스프라이트 0 이 있음
+    int sprZeroHitX;        // 건너뛰는 프레임에서 이 줄의 sprite 0 hit 위치 (-1 이면 없음)
+
+    static const uint16_t stateVersion = 6; // save state 형식이 바뀌면 증가
 
     // methods
+    PPU();
+
+    // save state (frameBuffer 는 출력이므로 제외)
+    void saveState(StateWriter &writer) const;
+    bool loadState(StateReader &reader);
+    void saveState(std::vector<uint8_t> &buffer) const;
+    bool loadState(const std::vector<uint8_t> &buffer);
 
     // IORegisters (called by CPU)
     void setPPUCtrl(uint8_t ctrl);
@@ -83,20 +176,51 @@ public:
     void setPPUAddr(uint8_t addr);
     void setPPUData(uint8_t data);
 
+    void writeOAM(const uint8_t *data); // OAM DMA: 256바이트를 oamAddr 부터 (한 바퀴 돌아 oamAddr 는 그대로)
+
     uint8_t getPPUStatus();
+    uint8_t getOAMData();
+    uint8_t getPPUData();
 
     uint8_t read(uint16_t address);
+    void write(uint16_t address, uint8_t value);
+    uint16_t nameTableAddress(uint16_t address);
+    uint8_t chrByte(uint16_t address) const { return chrPages[(address >> 10) & 0x07][address & 0x3FF]; }
+
+    // 매퍼용 (미뤄 둔 dot 을 먼저 처리)
+    void mapCHR(int firstPage, int count, const uint8_t *bank, bool writable); // 1KB 페이지 단위
+    void setMirroring(Mirroring mirroring);
+
+    // ptAddr: 패턴 테이블의 low plane 행 주소 (테이블 + 타일 * 16 + 행)
+    const uint8_t *tileRow(uint16_t ptAddr);
+    const uint8_t *flippedTileRow(uint16_t ptAddr);
+    void decodeTile(int tile);
+    void invalidateTiles();
+    size_t tileCacheBytes() const;
+
+    void tick(uint32_t dots);
+    void runUntil(uint64_t targetDot);
+    uint32_t dotsUntilVblank() const;
+    void sync();
+    void setRenderMode(RenderMode mode);
+    void setFrameSkip(uint32_t skip);
 
     void render();
+    bool renderingEnabled() const;
+    void renderScanline();
+    void renderLinePixels(int y, int start);
     void preRender();
     void visibleRender();
     void postRender();
     void vblank();
 
     void renderPixel();
+    void renderVisiblePixel(int x, int y);
     void renderBackgroundPixel(uint8_t &bgPixel, bool &bgOpaque);
-    void renderSpritePixel(int x, int y, bool bgOpaque, uint8_t &sprPixel, bool &sprOpaque, bool &sprForeground);
-    uint8_t compositePixel(int x, int y, uint8_t bgPixel, uint8_t sprPixel, bool bgOpaque, bool sprOpaque, bool sprForeground);
+    void renderSpritePixel(int x, bool bgOpaque, uint8_t &sprPixel, bool &sprOpaque, bool &sprForeground);
+    int findSpriteZeroHit(int start);
+    bool bgOpaqueAt(int x, int start);
+    uint8_t compositePixel(uint8_t bgPixel, uint8_t sprPixel, bool bgOpaque, bool sprOpaque, bool sprForeground);
 
     void clearFlags();
 
@@ -112,6 +236,7 @@ public:
     void loadNextTileIntoShifters();
 
     void evaluateSprites(int y);
+    void renderSpriteLine(int y);
     void fetchSpriteTitleByte();
     void fetchSpriteAttributeByte();
     void fetchSpritePatternLow();
@@ -0,0 +1,20 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <cstdint>
+
+/**
+ * NES 색 번호(0 ~ 63) -> RGBA(0xRRGGBBAA) 변환 테이블
+ * - PPUMASK 의 emphasis 3비트(bit 0: R, 1: G, 2: B) 조합 8가지를 미리 계산해 둠
+ * - 강조된 채널을 뺀 나머지 채널을 어둡게 함
+ */
+struct RGBAPalette
+{
+    uint32_t colors[8][64]; // [emphasis][색 번호]
+
+    explicit RGBAPalette(const uint32_t base[64]);
+};
+
+const RGBAPalette &defaultPalette();
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 픽셀 변환 커널 (scalar / SSE2 / AVX2, CPUID 로 선택)
+ *
+ * decodeRows: 8픽셀 행 rows 개를 팔레트 인덱스로 변환
+ * - low[i], high[i]: i 번째 행의 bitplane (bit 7 이 왼쪽 픽셀)
+ * - attributes[i]: i 번째 행의 팔레트 (nullptr 이면 0)
+ * - out[i * 8 + column] = attribute << 2 | high bit << 1 | low bit (flip 이면 좌우 반전)
+ *
+ * composite: 배경과 스프라이트 라인을 합성해 팔레트 인덱스(0 ~ 31)를 만듦
+ * - bg: 배경 픽셀 (0 이면 투명)
+ * - sprite: [4:0] 스프라이트 픽셀, 0x20: 배경 앞, 0x40: 스프라이트 0 (0 이면 투명)
+ * - 스프라이트 0 과 불투명한 배경이 겹치면 true (sprite 0 hit)
+ *
+ * indicesToRGBA: 색 번호(하위 6비트)를 64색 테이블로 RGBA 로 변환
+ *
+ * diffBlocks: 8바이트 블록 blocks 개(최대 32)를 비교해 다른 블록의 비트를 1 로 한 마스크
+ */
+struct PixelKernels
+{
+    const char *name;
+    void (*decodeRows)(const uint8_t *low, const uint8_t *high, const uint8_t *attributes, size_t rows,
+                       uint8_t *out, bool flip);
+    bool (*composite)(const uint8_t *bg, const uint8_t *sprite, uint8_t *out, size_t count);
+    void (*indicesToRGBA)(const uint8_t *indices, const uint32_t *palette, uint32_t *out, size_t count);
+    uint32_t (*diffBlocks)(const uint8_t *a, const uint8_t *b, size_t blocks);
+};
+
+// 이 CPU 에서 쓸 수 있는 가장 빠른 커널 (처음 호출할 때 한 번 선택)
+const PixelKernels &pixelKernels();
+
+// 개별 커널 (테스트/벤치마크용, 지원하지 않으면 nullptr)
+const PixelKernels *scalarPixelKernels();
+const PixelKernels *sse2PixelKernels();
+const PixelKernels *avx2PixelKernels();
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 되감기용 save state 기록 (프레임마다 push)
+ * - keyframeInterval 프레임마다 keyframe 을 두고, 나머지 프레임은 keyframe 과의 XOR 만 저장
+ * - XOR 결과는 [0 의 개수][literal 개수][literal...] 토큰(개수는 varint)으로 압축 (keyframe 은 0 과의 XOR)
+ * - 고정 크기 링 버퍼에 저장하고, 공간이 모자라면 가장 오래된 keyframe 그룹을 통째로 버림
+ * - 되감을 때만 keyframe + delta 를 풀어서 state 를 만듦
+ */
+class Rewind
+{
+public:
+    struct Stats
+    {
+        uint64_t frames = 0;       // push 된 프레임 수
+        uint64_t keyframes = 0;
+        uint64_t encodedBytes = 0; // 압축 후 누적 크기
+        uint64_t stateBytes = 0;   // 압축 전 누적 크기
+        uint64_t evicted = 0;      // 공간이 모자라 버린 프레임 수
+    };
+
+    Stats stats;
+
+    explicit Rewind(size_t capacity = 8 << 20, size_t maxFrames = 60 * 60 * 10, uint32_t keyframeInterval = 60);
+
+    void push(const std::vector<uint8_t> &state);
+    void clear();
+
+    size_t frames() const { return count; }
+    size_t bytesUsed() const;
+
+    // framesBack = 0 이 가장 최근 프레임
+    bool peek(size_t framesBack, std::vector<uint8_t> &state) const;
+    // peek 과 같고, 그보다 최근 프레임은 버림 (이후 push 는 그 프레임 뒤에 이어짐)
+    bool rewind(size_t framesBack, std::vector<uint8_t> &state);
+
+private:
+    struct Entry
+    {
+        uint64_t position;      // storage 의 논리 위치 (% capacity 가 실제 위치)
+        uint32_t size;          // 압축된 크기
+        uint32_t stateSize;     // 원래 state 크기
+        uint32_t sinceKeyframe; // 0 이면 keyframe
+    };
+
+    std::vector<uint8_t> storage;
+    std::vector<Entry> entries; // 링 (first 부터 count 개)
+    size_t first = 0;
+    size_t count = 0;
+    uint64_t head = 0; // 다음 기록 위치
+    uint32_t keyframeInterval;
+
+    std::vector<uint8_t> keyframe; // 현재 keyframe 원본 (delta 계산용)
+    std::vector<uint8_t> encoded;  // 압축 결과 (최대 크기로 유지하며 재사용, 앞부분만 유효)
+
+    const Entry &entry(size_t index) const { return entries[(first + index) % entries.size()]; }
+    size_t newest(size_t framesBack) const { return count - 1 - framesBack; }
+    void evictGroup();
+    void decode(size_t index, std::vector<uint8_t> &state) const;
+    void apply(const Entry &entry, std::vector<uint8_t> &state) const;
+};
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// 빈 슬롯이 없을 때 (소비자가 느릴 때) 생산자의 동작
+enum class OverflowPolicy
+{
+    DropOldest, // 아직 꺼내지 않은 가장 오래된 항목을 버리고 그 슬롯에 씀
+    DropNewest, // 새 항목을 버림 (acquire() 가 nullptr)
+    Block,      // 소비자가 슬롯을 돌려줄 때까지 대기 (잠금 없이 yield)
+};
+
+/**
+ * 생산자 하나, 소비자 하나 사이의 잠금 없는 큐 (슬롯 미리 할당)
+ * - 항목은 슬롯 번호(handle)로 주고받음: 생산자는 빈 슬롯에 직접 쓰고, 소비자는 슬롯을 복사 없이 읽음
+ * - 빈 슬롯 링 (소비자 -> 생산자)과 준비된 슬롯 링 (생산자 -> 소비자) 두 개, 인덱스는 캐시 라인마다 따로 둠
+ * - 준비된 링의 tail 만 양쪽이 CAS 로 옮김 (소비자가 꺼낼 때, DropOldest 생산자가 가장 오래된 항목을 회수할 때)
+ * - 소비자가 읽는 슬롯은 다음 pop() 까지 유효 (그동안 생산자가 덮어쓰지 않음)
+ * - produce 경로는 메모리 할당, mutex 없음
+ *
+ * slots 는 3 이상 (생산자가 쓰는 슬롯, 소비자가 읽는 슬롯, 대기 슬롯)
+ */
+template <typename T>
+class SPSCQueue
+{
+public:
+    SPSCQueue(size_t slots, OverflowPolicy policy)
+        : slotCount(static_cast<uint32_t>(std::max<size_t>(slots, 3))), mask(ringSize(slotCount) - 1), policy(policy),
+          slotData(new T[slotCount]()), freeRing(new std::atomic<uint32_t>[mask + 1]),
+          readyRing(new std::atomic<uint32_t>[mask + 1])
+    {
+        for (uint32_t i = 0; i < slotCount; ++i)
+            freeRing[i].store(i, std::memory_order_relaxed);
+        consumer.freeHead.store(slotCount, std::memory_order_release);
+    }
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    size_t slots() const { return slotCount; }
+
+    // 생산자: 쓸 슬롯 (DropNewest 에서 가득 차면 nullptr), 다 쓰면 publish()
+    T *acquire()
+    {
+        for (;;)
+        {
+            uint64_t tail = producer.freeTail;
+            if (tail != consumer.freeHead.load(std::memory_order_acquire))
+            {
+                producer.writing = freeRing[tail & mask].load(std::memory_order_relaxed);
+                producer.freeTail = tail + 1;
+                return &slotData[producer.writing];
+            }
+
+            if (policy == OverflowPolicy::DropNewest)
+            {
+                producer.dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            if (policy == OverflowPolicy::DropOldest && reclaimOldest())
+            {
+                producer.dropped.fetch_add(1, std::memory_order_relaxed);
+                return &slotData[producer.writing];
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void publish()
+    {
+        uint64_t head = producer.readyHead.load(std::memory_order_relaxed);
+        readyRing[head & mask].store(producer.writing, std::memory_order_relaxed);
+        producer.readyHead.store(head + 1, std::memory_order_release);
+        producer.pushed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 소비자: 이전에 꺼낸 슬롯을 돌려주고 다음 항목 (없으면 nullptr)
+    const T *pop()
+    {
+        release();
+        uint64_t tail = readyTail.value.load(std::memory_order_acquire);
+        for (;;)
+        {
+            if (tail == producer.readyHead.load(std::memory_order_acquire))
+                return nullptr;
+            uint32_t handle = readyRing[tail & mask].load(std::memory_order_relaxed);
+            if (readyTail.value.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel,
+                                                      std::memory_order_acquire))
+            {
+                consumer.reading = handle;
+                consumer.popped.fetch_add(1, std::memory_order_relaxed);
+                return &slotData[handle];
+            }
+        }
+    }
+
+    // 소비자: 읽던 슬롯을 바로 돌려줌 (pop() 이 자동으로 함)
+    void release()
+    {
+        if (consumer.reading == none)
+            return;
+        uint64_t head = consumer.freeHead.load(std::memory_order_relaxed);
+        freeRing[head & mask].store(consumer.reading, std::memory_order_relaxed);
+        consumer.freeHead.store(head + 1, std::memory_order_release);
+        consumer.reading = none;
+    }
+
+    // 통계 (어느 스레드에서 읽어도 됨)
+    uint64_t pushed() const { return producer.pushed.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return producer.dropped.load(std::memory_order_relaxed); }
+    uint64_t popped() const { return consumer.popped.load(std::memory_order_relaxed); }
+    size_t size() const // 꺼내지 않은 항목 수 (근사)
+    {
+        return producer.readyHead.load(std::memory_order_acquire) - readyTail.value.load(std::memory_order_acquire);
+    }
+
+private:
+    static const uint32_t none = ~0u;
+
+    static uint32_t ringSize(uint32_t slots)
+    {
+        uint32_t size = 1;
+        while (size < slots)
+            size <<= 1;
+        return size;
+    }
+
+    /*
+     * 꺼내지 않은 가장 오래된 항목을 생산자가 가져옴 (소비자의 pop() 과 같은 CAS 로 경쟁)
+     * - 링 크기 >= 슬롯 수이므로 tail 의 항목이 다시 쓰였다면 tail 도 이미 지나가서 CAS 가 실패함
+     */
+    bool reclaimOldest()
+    {
+        uint64_t tail = readyTail.value.load(std::memory_order_acquire);
+        if (tail == producer.readyHead.load(std::memory_order_relaxed))
+            return false;
+        uint32_t handle = readyRing[tail & mask].load(std::memory_order_relaxed);
+        if (!readyTail.value.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel))
+            return false;
+        producer.writing = handle;
+        return true;
+    }
+
+    const uint32_t slotCount;
+    const uint64_t mask; // 링 크기 - 1
+    const OverflowPolicy policy;
+    std::unique_ptr<T[]> slotData;
+    std::unique_ptr<std::atomic<uint32_t>[]> freeRing;  // 빈 슬롯 번호
+    std::unique_ptr<std::atomic<uint32_t>[]> readyRing; // 준비된 슬롯 번호 (오래된 것부터)
+
+    // 생산자가 쓰는 값
+    struct alignas(64) Producer
+    {
+        std::atomic<uint64_t> readyHead{0};
+        uint64_t freeTail = 0;
+        uint32_t writing = none;
+        std::atomic<uint64_t> pushed{0};
+        std::atomic<uint64_t> dropped{0};
+    } producer;
+
+    // 소비자가 쓰는 값
+    struct alignas(64) Consumer
+    {
+        std::atomic<uint64_t> freeHead{0};
+        uint32_t reading = none;
+        std::atomic<uint64_t> popped{0};
+    } consumer;
+
+    // 양쪽이 CAS
+    struct alignas(64) Index
+    {
+        std::atomic<uint64_t> value{0};
+    } readyTail;
+};
+
+#endif
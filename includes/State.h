@@ -0,0 +1,134 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * save state 직렬화
+ * - 컴포넌트마다 4바이트 태그 + 버전으로 시작하고, 필드를 정해진 순서로 little-endian 으로 기록
+ * - StateWriter 는 버퍼 뒤에 이어 붙이므로 clear() 한 버퍼를 재사용하면 할당이 없음
+ */
+class StateWriter
+{
+public:
+    explicit StateWriter(std::vector<uint8_t> &buffer) : buffer(buffer) {}
+
+    void section(const char tag[4], uint16_t version)
+    {
+        bytes(tag, 4);
+        write16(version);
+    }
+
+    void write8(uint8_t value) { buffer.push_back(value); }
+    void writeBool(bool value) { buffer.push_back(value ? 1 : 0); }
+    void write16(uint16_t value) { writeLE(value, 2); }
+    void write32(uint32_t value) { writeLE(value, 4); }
+    void write64(uint64_t value) { writeLE(value, 8); }
+
+    void bytes(const void *data, size_t size)
+    {
+        const uint8_t *begin = static_cast<const uint8_t *>(data);
+        buffer.insert(buffer.end(), begin, begin + size);
+    }
+
+    // 크기가 바뀔 수 있는 vector 는 원소 수를 앞에 기록
+    template <typename T>
+    void vector(const std::vector<T> &values)
+    {
+        write32(values.size());
+        if constexpr (sizeof(T) == 1)
+            bytes(values.data(), values.size());
+        else
+            for (const T &value : values)
+                writeLE(value, sizeof(T));
+    }
+
+private:
+    std::vector<uint8_t> &buffer;
+
+    void writeLE(uint64_t value, int size)
+    {
+        uint8_t data[8];
+        for (int i = 0; i < size; ++i)
+            data[i] = value >> (i * 8);
+        bytes(data, size);
+    }
+};
+
+/**
+ * StateWriter 가 기록한 순서대로 읽음
+ * - 버퍼 끝을 넘거나 태그/버전이 다르면 ok 가 false 가 되고, 이후 읽는 값은 0
+ */
+class StateReader
+{
+public:
+    bool ok = true;
+
+    StateReader(const std::vector<uint8_t> &buffer, size_t offset = 0) : buffer(buffer), offset(offset) {}
+
+    bool section(const char tag[4], uint16_t version)
+    {
+        char read[4] = {};
+        bytes(read, 4);
+        if (read16() != version || std::memcmp(read, tag, 4) != 0)
+            ok = false;
+        return ok;
+    }
+
+    uint8_t read8() { return readLE(1); }
+    bool readBool() { return readLE(1) != 0; }
+    uint16_t read16() { return readLE(2); }
+    uint32_t read32() { return readLE(4); }
+    uint64_t read64() { return readLE(8); }
+
+    void bytes(void *data, size_t size)
+    {
+        if (!ok || buffer.size() - offset < size)
+        {
+            ok = false;
+            std::memset(data, 0, size);
+            return;
+        }
+        std::memcpy(data, buffer.data() + offset, size);
+        offset += size;
+    }
+
+    // 크기가 같으면 그대로 덮어쓰므로 할당 없음
+    template <typename T>
+    void vector(std::vector<T> &values)
+    {
+        uint32_t size = read32();
+        if (!ok || size > buffer.size() - offset)
+        {
+            ok = false;
+            return;
+        }
+        values.resize(size);
+        if constexpr (sizeof(T) == 1)
+            bytes(values.data(), size);
+        else
+            for (T &value : values)
+                value = static_cast<T>(readLE(sizeof(T)));
+    }
+
+    size_t position() const { return offset; }
+
+private:
+    const std::vector<uint8_t> &buffer;
+    size_t offset;
+
+    uint64_t readLE(int size)
+    {
+        uint8_t data[8];
+        bytes(data, size);
+        uint64_t value = 0;
+        for (int i = 0; i < size; ++i)
+            value |= static_cast<uint64_t>(data[i]) << (i * 8);
+        return value;
+    }
+};
+
+#endif
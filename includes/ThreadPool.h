@@ -0,0 +1,27 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * 정해진 개수의 독립 작업을 여러 스레드로 나눠 실행 (work stealing)
+ * - 작업 번호를 스레드마다의 deque 에 나눠 담고, 각 스레드는 자기 deque 앞에서 꺼냄
+ * - 자기 deque 가 비면 다른 스레드의 deque 뒤에서 훔쳐 옴 (긴 작업이 한 스레드에 몰려도 균형이 맞음)
+ * - 실행 중에 작업이 추가되지 않으므로, 모든 deque 가 비면 종료
+ */
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threads = 0); // 0 이면 하드웨어 스레드 수
+
+    unsigned threads() const { return threadCount; }
+
+    // task(0) ~ task(count - 1) 를 모두 실행할 때까지 블록
+    void run(size_t count, const std::function<void(size_t)> &task);
+
+private:
+    unsigned threadCount;
+};
+
+#endif
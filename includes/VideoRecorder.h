@@ -0,0 +1,69 @@
+#ifndef VIDEO_RECORDER_H
+#define VIDEO_RECORDER_H
+
+#include "OutputQueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+struct iovec;
+
+enum class VideoFormat
+{
+    Y4M,     // YUV4MPEG2 4:2:0 (C420jpeg, full range), 60.0988 fps, 화소비 8:7
+    RGBA,    // 프레임마다 256 * 240 * 4 바이트 (R, G, B, A 순서)
+    Indexed, // 프레임마다 256 * 240 색 번호 + 240 바이트 (행마다 emphasis)
+};
+
+/**
+ * 프레임을 파일이나 파이프로 기록 (writer 스레드)
+ * - 에뮬레이션 스레드는 push() 에서 색 번호 프레임을 큐 슬롯에 복사만 함 (기록 형식과 무관하게 같은 비용)
+ * - 색 변환과 쓰기는 writer 스레드에서: 여러 프레임을 모아 writev 한 번으로 씀 (큐가 비면 모은 만큼 바로 씀)
+ * - 모든 프레임을 기록하므로 큐는 Block 정책: writer 가 계속 밀리면 에뮬레이션이 기다림
+ * - 쓰기가 실패하면 이후 프레임은 버리고, close() 가 false 와 이유를 돌려줌
+ */
+class VideoRecorder
+{
+public:
+    explicit VideoRecorder(size_t slots = 8);
+    ~VideoRecorder();
+    VideoRecorder(const VideoRecorder &) = delete;
+    VideoRecorder &operator=(const VideoRecorder &) = delete;
+
+    // path 가 "-" 면 표준 출력, fd 를 받는 쪽은 fd 를 닫지 않음 (파이프)
+    bool open(const std::string &path, VideoFormat format, std::string &error);
+    bool open(int fd, VideoFormat format, std::string &error);
+    bool close(std::string &error); // 남은 프레임을 모두 쓰고 writer 종료
+
+    bool recording() const { return writer.joinable(); }
+    void push(const FrameBuffer::View &frame); // 에뮬레이션 스레드
+
+    static size_t frameBytes(VideoFormat format);
+    static std::string header(VideoFormat format); // Y4M 스트림 헤더 (다른 형식은 빈 문자열)
+
+    // writer 통계 (close() 뒤에 정확)
+    uint64_t framesWritten() const { return frames.load(std::memory_order_relaxed); }
+    uint64_t bytesWritten() const { return bytes.load(std::memory_order_relaxed); }
+    uint64_t writeCalls() const { return calls.load(std::memory_order_relaxed); }
+
+private:
+    FrameQueue queue;
+    std::thread writer;
+    std::atomic<bool> stopping{false};
+    int fd = -1;
+    bool ownsFd = false;
+    VideoFormat format = VideoFormat::Y4M;
+    std::string writeError; // writer 스레드가 씀, close() 에서 읽음
+
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> calls{0};
+
+    void run();
+    bool writeAll(iovec *parts, int count);
+};
+
+#endif
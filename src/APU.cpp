@@ -0,0 +1,663 @@
+#include "APU.h"
+#include "State.h"
+
+#include <algorithm>
+#include <limits>
+
+static const uint8_t lengthTable[32] = {10, 254, 20,  2,  40, 4,  80, 6,  160, 8,  60, 10, 14, 12, 26, 14,
+                                        12, 16,  24,  18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30};
+static const uint8_t dutyTable[4] = {0x02, 0x06, 0x1E, 0xF9}; // bit n = 시퀀서 n 번째 출력
+static const uint16_t noisePeriods[16] = {4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068};
+static const uint16_t dmcPeriods[16] = {428, 380, 340, 320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54};
+
+// 프레임 카운터: 주기 시작부터 각 단계까지의 CPU 사이클 (4-step / 5-step)
+static const uint32_t frameSteps[2][4] = {{7457, 14913, 22371, 29829}, {7457, 14913, 22371, 37281}};
+static const uint32_t framePeriods[2] = {29830, 37282};
+
+// 채널 출력 1 당 BlipBuffer delta (1 << deltaBits = 1.0)
+static const int32_t pulseWeight = 493;    // 0.00752
+static const int32_t triangleWeight = 558; // 0.00851
+static const int32_t noiseWeight = 324;    // 0.00494
+static const int32_t dmcWeight = 220;      // 0.00335
+
+APU::APU() : readMemory([](uint16_t) -> uint8_t { return 0; })
+{
+    audioOutput = [](const int16_t *, size_t) {};
+    blip.setRates(clockRate, sampleRate, frameCycles);
+}
+
+// 오디오를 다시 켜면 멈춰 있던 타이머를 지금부터 다시 시작
+void APU::setAudioEnabled(bool enabled)
+{
+    if (enabled == audioEnabled)
+        return;
+    audioEnabled = enabled;
+    if (!enabled)
+        return;
+
+    blip.clear();
+    blockStart = cycle;
+    pulse[0].nextClock = pulse[1].nextClock = triangle.nextClock = noise.nextClock = cycle;
+    pulse[0].output = pulse[1].output = triangle.output = noise.output = dmc.output = 0;
+    updateOutputs(cycle);
+}
+
+void APU::setSampleRate(int rate)
+{
+    sampleRate = rate;
+    blip.setRates(clockRate, rate, frameCycles);
+}
+
+// envelope / length / sweep
+
+static void clockEnvelope(APU::Envelope &envelope)
+{
+    if (envelope.start)
+    {
+        envelope.start = false;
+        envelope.decay = 15;
+        envelope.divider = envelope.period;
+    }
+    else if (envelope.divider == 0)
+    {
+        envelope.divider = envelope.period;
+        if (envelope.decay > 0)
+            --envelope.decay;
+        else if (envelope.loop)
+            envelope.decay = 15;
+    }
+    else
+        --envelope.divider;
+}
+
+static int envelopeVolume(const APU::Envelope &envelope)
+{
+    return envelope.constant ? envelope.period : envelope.decay;
+}
+
+// 펄스 1 은 1의 보수로 빼므로 1 더 작아짐
+static int sweepTarget(const APU::Pulse &channel, bool first)
+{
+    int change = channel.timer >> channel.sweepShift;
+    if (channel.sweepNegate)
+        return channel.timer - change - (first ? 1 : 0);
+    return channel.timer + change;
+}
+
+static bool sweepMuted(const APU::Pulse &channel, bool first)
+{
+    return channel.timer < 8 || sweepTarget(channel, first) > 0x7FF;
+}
+
+static void clockSweep(APU::Pulse &channel, bool first)
+{
+    if (channel.sweepDivider == 0 && channel.sweepEnabled && channel.sweepShift > 0 && !sweepMuted(channel, first))
+        channel.timer = sweepTarget(channel, first);
+    if (channel.sweepDivider == 0 || channel.sweepReload)
+    {
+        channel.sweepDivider = channel.sweepPeriod;
+        channel.sweepReload = false;
+    }
+    else
+        --channel.sweepDivider;
+}
+
+static void clockLength(uint8_t &length, bool halt)
+{
+    if (!halt && length > 0)
+        --length;
+}
+
+void APU::quarterFrame()
+{
+    clockEnvelope(pulse[0].envelope);
+    clockEnvelope(pulse[1].envelope);
+    clockEnvelope(noise.envelope);
+
+    if (triangle.linearReload)
+        triangle.linear = triangle.linearPeriod;
+    else if (triangle.linear > 0)
+        --triangle.linear;
+    if (!triangle.control)
+        triangle.linearReload = false;
+}
+
+void APU::halfFrame()
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        clockLength(pulse[i].length, pulse[i].envelope.loop);
+        clockSweep(pulse[i], i == 0);
+    }
+    clockLength(triangle.length, triangle.control);
+    clockLength(noise.length, noise.envelope.loop);
+}
+
+uint64_t APU::nextFrameEvent() const
+{
+    return frameStart + frameSteps[fiveStep][frameStep];
+}
+
+void APU::clockFrame()
+{
+    quarterFrame();
+    if (frameStep & 0x01)
+        halfFrame();
+    if (frameStep == 3 && !fiveStep && !frameIRQInhibit)
+        frameIRQ = true;
+    if (++frameStep == 4)
+    {
+        frameStep = 0;
+        frameStart += framePeriods[fiveStep];
+    }
+    updateOutputs(cycle);
+}
+
+// 출력
+
+int APU::pulseOutput(const Pulse &channel) const
+{
+    if (channel.length == 0 || sweepMuted(channel, &channel == &pulse[0]))
+        return 0;
+    return ((dutyTable[channel.duty] >> channel.step) & 0x01) ? envelopeVolume(channel.envelope) : 0;
+}
+
+// 15 ~ 0, 0 ~ 15 (멈추면 마지막 값을 유지)
+int APU::triangleOutput() const
+{
+    return triangle.step < 16 ? 15 - triangle.step : triangle.step - 16;
+}
+
+int APU::noiseOutput() const
+{
+    if (noise.length == 0 || (noise.shift & 0x01))
+        return 0;
+    return envelopeVolume(noise.envelope);
+}
+
+void APU::setOutput(int &output, int value, uint64_t time, int32_t weight)
+{
+    if (value == output)
+        return;
+    if (audioEnabled)
+        blip.addDelta(static_cast<uint32_t>(time - blockStart), (value - output) * weight);
+    output = value;
+}
+
+// 레지스터 쓰기 / 프레임 카운터로 출력이 바뀌었을 수 있음
+void APU::updateOutputs(uint64_t time)
+{
+    setOutput(pulse[0].output, pulseOutput(pulse[0]), time, pulseWeight);
+    setOutput(pulse[1].output, pulseOutput(pulse[1]), time, pulseWeight);
+    setOutput(triangle.output, triangleOutput(), time, triangleWeight);
+    setOutput(noise.output, noiseOutput(), time, noiseWeight);
+    setOutput(dmc.output, dmc.level, time, dmcWeight);
+}
+
+// 채널 진행: [nextClock, end) 의 타이머 클럭을 처리
+
+// 소리가 나지 않는 동안에는 시퀀서 위치만 계산
+void APU::runPulse(Pulse &channel, uint64_t end)
+{
+    if (channel.nextClock >= end)
+        return;
+    uint64_t period = (channel.timer + 1) * 2;
+    int volume = envelopeVolume(channel.envelope);
+    if (channel.length == 0 || sweepMuted(channel, &channel == &pulse[0]) || volume == 0)
+    {
+        uint64_t clocks = (end - channel.nextClock + period - 1) / period;
+        channel.step = (channel.step + clocks) & 0x07;
+        channel.nextClock += clocks * period;
+        return;
+    }
+
+    uint8_t duty = dutyTable[channel.duty];
+    for (; channel.nextClock < end; channel.nextClock += period)
+    {
+        channel.step = (channel.step + 1) & 0x07;
+        setOutput(channel.output, ((duty >> channel.step) & 0x01) ? volume : 0, channel.nextClock, pulseWeight);
+    }
+}
+
+// length / linear counter 가 0 이면 멈춤, 초음파 주기(timer < 2)는 소리 대신 멈춤
+void APU::runTriangle(uint64_t end)
+{
+    if (triangle.nextClock >= end)
+        return;
+    uint64_t period = triangle.timer + 1;
+    if (triangle.length == 0 || triangle.linear == 0 || triangle.timer < 2)
+    {
+        triangle.nextClock += (end - triangle.nextClock + period - 1) / period * period;
+        return;
+    }
+
+    for (; triangle.nextClock < end; triangle.nextClock += period)
+    {
+        triangle.step = (triangle.step + 1) & 0x1F;
+        setOutput(triangle.output, triangleOutput(), triangle.nextClock, triangleWeight);
+    }
+}
+
+void APU::runNoise(uint64_t end)
+{
+    uint64_t period = noisePeriods[noise.period];
+    int tap = noise.mode ? 6 : 1;
+    bool audible = noise.length > 0 && envelopeVolume(noise.envelope) > 0;
+    for (; noise.nextClock < end; noise.nextClock += period)
+    {
+        uint16_t feedback = (noise.shift ^ (noise.shift >> tap)) & 0x01;
+        noise.shift = (noise.shift >> 1) | (feedback << 14);
+        if (audible)
+            setOutput(noise.output, noiseOutput(), noise.nextClock, noiseWeight);
+    }
+}
+
+// 샘플이 끝나 출력 유닛이 쉬는 동안에는 비트 카운터만 계산
+void APU::runDMC(uint64_t end)
+{
+    if (dmc.nextClock >= end)
+        return;
+    uint64_t period = dmcPeriods[dmc.rate];
+    if (dmc.silence && dmc.bufferEmpty)
+    {
+        uint64_t clocks = (end - dmc.nextClock + period - 1) / period;
+        dmc.bitsRemaining = 8 - (8 - dmc.bitsRemaining + clocks) % 8;
+        dmc.nextClock += clocks * period;
+        return;
+    }
+
+    for (; dmc.nextClock < end; dmc.nextClock += period)
+    {
+        clockDMC();
+        setOutput(dmc.output, dmc.level, dmc.nextClock, dmcWeight);
+    }
+}
+
+void APU::clockDMC()
+{
+    if (!dmc.silence)
+    {
+        if (dmc.shift & 0x01)
+        {
+            if (dmc.level <= 125)
+                dmc.level += 2;
+        }
+        else if (dmc.level >= 2)
+            dmc.level -= 2;
+        dmc.shift >>= 1;
+    }
+
+    if (--dmc.bitsRemaining == 0)
+    {
+        dmc.bitsRemaining = 8;
+        dmc.silence = dmc.bufferEmpty;
+        if (!dmc.bufferEmpty)
+        {
+            dmc.shift = dmc.buffer;
+            dmc.bufferEmpty = true;
+            fillDMCBuffer();
+        }
+    }
+}
+
+// 버퍼가 비면 바로 다음 바이트를 읽음 (CPU 정지 사이클은 생략)
+void APU::fillDMCBuffer()
+{
+    if (!dmc.bufferEmpty || dmc.bytesRemaining == 0)
+        return;
+    dmc.buffer = readMemory(dmc.address);
+    dmc.bufferEmpty = false;
+    dmc.address = dmc.address == 0xFFFF ? 0x8000 : dmc.address + 1;
+    if (--dmc.bytesRemaining == 0)
+    {
+        if (dmc.loop)
+        {
+            dmc.address = dmc.sampleAddress;
+            dmc.bytesRemaining = dmc.sampleLength;
+        }
+        else if (dmc.irqEnabled)
+            dmc.irq = true;
+    }
+}
+
+void APU::runChannels(uint64_t end)
+{
+    if (audioEnabled)
+    {
+        runPulse(pulse[0], end);
+        runPulse(pulse[1], end);
+        runTriangle(end);
+        runNoise(end);
+    }
+    runDMC(end);
+}
+
+/*
+ * target 직전까지 진행
+ * - 프레임 카운터 이벤트 / 오디오 블록 경계에서 나눔 (그 사이클의 채널 클럭보다 먼저 처리)
+ */
+void APU::runUntil(uint64_t target)
+{
+    while (cycle < target)
+    {
+        uint64_t end = std::min(target, nextFrameEvent());
+        if (audioEnabled)
+            end = std::min(end, blockStart + frameCycles);
+        runChannels(end);
+        cycle = end;
+
+        if (cycle == nextFrameEvent())
+            clockFrame();
+        if (audioEnabled && cycle == blockStart + frameCycles)
+            endBlock();
+    }
+}
+
+void APU::endBlock()
+{
+    blip.endFrame(frameCycles, samples);
+    audioOutput(samples.data(), samples.size());
+    blockStart += frameCycles;
+}
+
+// 프레임 IRQ, DMC IRQ (바이트를 읽을 수 있는 클럭마다), 오디오 블록 끝
+uint64_t APU::nextEvent() const
+{
+    uint64_t next = std::numeric_limits<uint64_t>::max();
+    if (!fiveStep && !frameIRQInhibit && !frameIRQ)
+        next = frameStart + frameSteps[0][3];
+    if (dmc.irqEnabled && dmc.bytesRemaining > 0)
+        next = std::min(next, dmc.nextClock + 1);
+    if (audioEnabled)
+        next = std::min(next, blockStart + frameCycles);
+    return next;
+}
+
+// 레지스터 (호출 전에 runUntil 로 지금 사이클까지 진행)
+
+void APU::writeRegister(uint16_t address, uint8_t value)
+{
+    switch (address)
+    {
+    case 0x4000:
+    case 0x4004:
+    {
+        Pulse &channel = pulse[(address >> 2) & 0x01];
+        channel.duty = value >> 6;
+        channel.envelope.loop = value & 0x20;
+        channel.envelope.constant = value & 0x10;
+        channel.envelope.period = value & 0x0F;
+        break;
+    }
+    case 0x4001:
+    case 0x4005:
+    {
+        Pulse &channel = pulse[(address >> 2) & 0x01];
+        channel.sweepEnabled = value & 0x80;
+        channel.sweepPeriod = (value >> 4) & 0x07;
+        channel.sweepNegate = value & 0x08;
+        channel.sweepShift = value & 0x07;
+        channel.sweepReload = true;
+        break;
+    }
+    case 0x4002:
+    case 0x4006:
+    {
+        Pulse &channel = pulse[(address >> 2) & 0x01];
+        channel.timer = (channel.timer & 0x700) | value;
+        break;
+    }
+    case 0x4003:
+    case 0x4007:
+    {
+        Pulse &channel = pulse[(address >> 2) & 0x01];
+        channel.timer = (channel.timer & 0xFF) | ((value & 0x07) << 8);
+        if (channel.enabled)
+            channel.length = lengthTable[value >> 3];
+        channel.step = 0;
+        channel.envelope.start = true;
+        break;
+    }
+    case 0x4008:
+        triangle.control = value & 0x80;
+        triangle.linearPeriod = value & 0x7F;
+        break;
+    case 0x400A: triangle.timer = (triangle.timer & 0x700) | value; break;
+    case 0x400B:
+        triangle.timer = (triangle.timer & 0xFF) | ((value & 0x07) << 8);
+        if (triangle.enabled)
+            triangle.length = lengthTable[value >> 3];
+        triangle.linearReload = true;
+        break;
+    case 0x400C:
+        noise.envelope.loop = value & 0x20;
+        noise.envelope.constant = value & 0x10;
+        noise.envelope.period = value & 0x0F;
+        break;
+    case 0x400E:
+        noise.mode = value & 0x80;
+        noise.period = value & 0x0F;
+        break;
+    case 0x400F:
+        if (noise.enabled)
+            noise.length = lengthTable[value >> 3];
+        noise.envelope.start = true;
+        break;
+    case 0x4010:
+        dmc.irqEnabled = value & 0x80;
+        if (!dmc.irqEnabled)
+            dmc.irq = false;
+        dmc.loop = value & 0x40;
+        dmc.rate = value & 0x0F;
+        break;
+    case 0x4011: dmc.level = value & 0x7F; break;
+    case 0x4012: dmc.sampleAddress = 0xC000 + value * 64; break;
+    case 0x4013: dmc.sampleLength = value * 16 + 1; break;
+    case 0x4015:
+        pulse[0].enabled = value & 0x01;
+        pulse[1].enabled = value & 0x02;
+        triangle.enabled = value & 0x04;
+        noise.enabled = value & 0x08;
+        if (!pulse[0].enabled)
+            pulse[0].length = 0;
+        if (!pulse[1].enabled)
+            pulse[1].length = 0;
+        if (!triangle.enabled)
+            triangle.length = 0;
+        if (!noise.enabled)
+            noise.length = 0;
+
+        dmc.irq = false;
+        if (!(value & 0x10))
+            dmc.bytesRemaining = 0;
+        else if (dmc.bytesRemaining == 0)
+        {
+            dmc.address = dmc.sampleAddress;
+            dmc.bytesRemaining = dmc.sampleLength;
+            fillDMCBuffer();
+        }
+        break;
+    case 0x4017: // 쓰기 후 3~4 사이클 지연은 생략
+        fiveStep = value & 0x80;
+        frameIRQInhibit = value & 0x40;
+        if (frameIRQInhibit)
+            frameIRQ = false;
+        frameStart = cycle;
+        frameStep = 0;
+        if (fiveStep)
+        {
+            quarterFrame();
+            halfFrame();
+        }
+        break;
+    default: break;
+    }
+    updateOutputs(cycle);
+}
+
+uint8_t APU::readStatus()
+{
+    uint8_t status = (pulse[0].length > 0 ? 0x01 : 0) | (pulse[1].length > 0 ? 0x02 : 0) |
+                     (triangle.length > 0 ? 0x04 : 0) | (noise.length > 0 ? 0x08 : 0) |
+                     (dmc.bytesRemaining > 0 ? 0x10 : 0) | (frameIRQ ? 0x40 : 0) | (dmc.irq ? 0x80 : 0);
+    frameIRQ = false;
+    return status;
+}
+
+// save state
+
+static void saveEnvelope(StateWriter &writer, const APU::Envelope &envelope)
+{
+    writer.writeBool(envelope.start);
+    writer.writeBool(envelope.loop);
+    writer.writeBool(envelope.constant);
+    writer.write8(envelope.period);
+    writer.write8(envelope.divider);
+    writer.write8(envelope.decay);
+}
+
+static void loadEnvelope(StateReader &reader, APU::Envelope &envelope)
+{
+    envelope.start = reader.readBool();
+    envelope.loop = reader.readBool();
+    envelope.constant = reader.readBool();
+    envelope.period = reader.read8();
+    envelope.divider = reader.read8();
+    envelope.decay = reader.read8();
+}
+
+// 기록 순서: 펄스 1, 2, 삼각파, 노이즈, DMC, 프레임 카운터, 시간 (output 은 합성용이므로 제외)
+void APU::saveState(StateWriter &writer) const
+{
+    writer.section("APU ", stateVersion);
+    for (const Pulse &channel : pulse)
+    {
+        saveEnvelope(writer, channel.envelope);
+        writer.writeBool(channel.enabled);
+        writer.write8(channel.duty);
+        writer.write8(channel.step);
+        writer.write8(channel.length);
+        writer.write16(channel.timer);
+        writer.writeBool(channel.sweepEnabled);
+        writer.writeBool(channel.sweepNegate);
+        writer.writeBool(channel.sweepReload);
+        writer.write8(channel.sweepPeriod);
+        writer.write8(channel.sweepShift);
+        writer.write8(channel.sweepDivider);
+        writer.write64(channel.nextClock);
+    }
+
+    writer.writeBool(triangle.enabled);
+    writer.writeBool(triangle.control);
+    writer.writeBool(triangle.linearReload);
+    writer.write8(triangle.linearPeriod);
+    writer.write8(triangle.linear);
+    writer.write8(triangle.length);
+    writer.write8(triangle.step);
+    writer.write16(triangle.timer);
+    writer.write64(triangle.nextClock);
+
+    saveEnvelope(writer, noise.envelope);
+    writer.writeBool(noise.enabled);
+    writer.writeBool(noise.mode);
+    writer.write8(noise.period);
+    writer.write8(noise.length);
+    writer.write16(noise.shift);
+    writer.write64(noise.nextClock);
+
+    writer.writeBool(dmc.irqEnabled);
+    writer.writeBool(dmc.loop);
+    writer.write8(dmc.rate);
+    writer.write8(dmc.level);
+    writer.write16(dmc.sampleAddress);
+    writer.write16(dmc.sampleLength);
+    writer.write16(dmc.address);
+    writer.write16(dmc.bytesRemaining);
+    writer.write8(dmc.buffer);
+    writer.writeBool(dmc.bufferEmpty);
+    writer.write8(dmc.shift);
+    writer.write8(dmc.bitsRemaining);
+    writer.writeBool(dmc.silence);
+    writer.writeBool(dmc.irq);
+    writer.write64(dmc.nextClock);
+
+    writer.writeBool(fiveStep);
+    writer.writeBool(frameIRQInhibit);
+    writer.writeBool(frameIRQ);
+    writer.write8(frameStep);
+    writer.write64(frameStart);
+    writer.write64(cycle);
+    writer.write64(blockStart);
+}
+
+// 합성 버퍼는 비우고 지금 출력에서 다시 시작
+bool APU::loadState(StateReader &reader)
+{
+    if (!reader.section("APU ", stateVersion))
+        return false;
+    for (Pulse &channel : pulse)
+    {
+        loadEnvelope(reader, channel.envelope);
+        channel.enabled = reader.readBool();
+        channel.duty = reader.read8() & 0x03;
+        channel.step = reader.read8() & 0x07;
+        channel.length = reader.read8();
+        channel.timer = reader.read16() & 0x7FF;
+        channel.sweepEnabled = reader.readBool();
+        channel.sweepNegate = reader.readBool();
+        channel.sweepReload = reader.readBool();
+        channel.sweepPeriod = reader.read8();
+        channel.sweepShift = reader.read8() & 0x07;
+        channel.sweepDivider = reader.read8();
+        channel.nextClock = reader.read64();
+    }
+
+    triangle.enabled = reader.readBool();
+    triangle.control = reader.readBool();
+    triangle.linearReload = reader.readBool();
+    triangle.linearPeriod = reader.read8();
+    triangle.linear = reader.read8();
+    triangle.length = reader.read8();
+    triangle.step = reader.read8() & 0x1F;
+    triangle.timer = reader.read16() & 0x7FF;
+    triangle.nextClock = reader.read64();
+
+    loadEnvelope(reader, noise.envelope);
+    noise.enabled = reader.readBool();
+    noise.mode = reader.readBool();
+    noise.period = reader.read8() & 0x0F;
+    noise.length = reader.read8();
+    noise.shift = reader.read16();
+    noise.nextClock = reader.read64();
+
+    dmc.irqEnabled = reader.readBool();
+    dmc.loop = reader.readBool();
+    dmc.rate = reader.read8() & 0x0F;
+    dmc.level = reader.read8() & 0x7F;
+    dmc.sampleAddress = reader.read16();
+    dmc.sampleLength = reader.read16();
+    dmc.address = reader.read16();
+    dmc.bytesRemaining = reader.read16();
+    dmc.buffer = reader.read8();
+    dmc.bufferEmpty = reader.readBool();
+    dmc.shift = reader.read8();
+    dmc.bitsRemaining = reader.read8();
+    dmc.silence = reader.readBool();
+    dmc.irq = reader.readBool();
+    dmc.nextClock = reader.read64();
+
+    fiveStep = reader.readBool();
+    frameIRQInhibit = reader.readBool();
+    frameIRQ = reader.readBool();
+    frameStep = reader.read8() & 0x03;
+    frameStart = reader.read64();
+    cycle = reader.read64();
+    blockStart = reader.read64();
+    if (!reader.ok || dmc.bitsRemaining == 0 || dmc.bitsRemaining > 8)
+        return false;
+
+    blip.clear();
+    pulse[0].output = pulse[1].output = triangle.output = noise.output = dmc.output = 0;
+    updateOutputs(cycle);
+    return true;
+}
@@ -0,0 +1,159 @@
+#include "Batch.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+using Clock = std::chrono::steady_clock;
+
+static const uint16_t programStart = 0x8000;
+
+static bool loadBinary(const std::string &path, std::vector<uint8_t> &program)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    program.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool parseExit(const std::string &text, BatchJob &job)
+{
+    if (text == "budget")
+    {
+        job.exit = BatchExit::Budget;
+        return true;
+    }
+    if (text.compare(0, 5, "trap:") != 0)
+        return false;
+
+    job.exit = BatchExit::Trap;
+    size_t equals = text.find('=');
+    std::string address = text.substr(5, equals == std::string::npos ? std::string::npos : equals - 5);
+    try
+    {
+        size_t used;
+        unsigned long value = std::stoul(address, &used, 16);
+        if (used != address.size() || value > 0xFFFF)
+            return false;
+        job.trapAddress = value;
+        if (equals != std::string::npos)
+        {
+            std::string expected = text.substr(equals + 1);
+            job.expected = std::stoi(expected, &used, 0);
+            if (used != expected.size() || job.expected < 0 || job.expected > 0xFF)
+                return false;
+        }
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+    return true;
+}
+
+static bool parseMode(const std::string &text, ExecutionMode &mode)
+{
+    if (text == "interpreter")
+        mode = ExecutionMode::Interpreter;
+    else if (text == "blocks")
+        mode = ExecutionMode::BlockCache;
+    else if (text == "jit")
+        mode = ExecutionMode::JIT;
+    else
+        return false;
+    return true;
+}
+
+bool parseManifest(std::istream &manifest, std::vector<BatchJob> &jobs, std::string &error)
+{
+    std::string line;
+    for (int number = 1; std::getline(manifest, line); ++number)
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string path, budget, exit, mode;
+        if (!(fields >> path))
+            continue; // 빈 줄
+
+        BatchJob job;
+        job.name = path;
+        fields >> budget >> exit >> mode;
+        try
+        {
+            job.cycleBudget = std::stoull(budget);
+        }
+        catch (const std::exception &)
+        {
+            error = "line " + std::to_string(number) + ": invalid cycle budget '" + budget + "'";
+            return false;
+        }
+        if (!parseExit(exit, job))
+        {
+            error = "line " + std::to_string(number) + ": invalid exit condition '" + exit + "'";
+            return false;
+        }
+        if (!mode.empty() && !parseMode(mode, job.mode))
+        {
+            error = "line " + std::to_string(number) + ": unknown execution mode '" + mode + "'";
+            return false;
+        }
+        if (!loadBinary(path, job.program))
+        {
+            error = "line " + std::to_string(number) + ": failed to open binary file '" + path + "'";
+            return false;
+        }
+        jobs.push_back(std::move(job));
+    }
+    return true;
+}
+
+BatchResult runBatchJob(const BatchJob &job)
+{
+    BatchResult result;
+    if (job.program.empty() || job.program.size() > 0x10000 - programStart)
+    {
+        result.error = "binary must be 1 to 32768 bytes";
+        return result;
+    }
+
+    Clock::time_point start = Clock::now();
+
+    CPU cpu;
+    std::copy(job.program.begin(), job.program.end(), cpu.memory.begin() + programStart);
+    cpu.pc = programStart;
+    if (job.exit == BatchExit::Trap)
+        cpu.setTrap(job.trapAddress);
+    cpu.setExecutionMode(job.mode);
+
+    while (!cpu.halted && cpu.cycles < job.cycleBudget)
+    {
+        cpu.run(std::min(batchFrameCycles, job.cycleBudget - cpu.cycles));
+        ++result.frames;
+    }
+
+    result.cycles = cpu.cycles;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (job.exit == BatchExit::Budget)
+        result.passed = !cpu.halted;
+    else if (cpu.halted)
+    {
+        result.result = cpu.memory[job.trapAddress];
+        result.passed = job.expected < 0 || result.result == job.expected;
+    }
+    else
+        result.error = "did not reach the trap address";
+    return result;
+}
+
+// 작업마다 결과 칸이 따로 있으므로 잠금 없이 기록
+std::vector<BatchResult> runBatch(const std::vector<BatchJob> &jobs, unsigned threads)
+{
+    std::vector<BatchResult> results(jobs.size());
+    ThreadPool pool(threads);
+    pool.run(jobs.size(), [&](size_t index) { results[index] = runBatchJob(jobs[index]); });
+    return results;
+}
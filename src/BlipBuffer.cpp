@@ -0,0 +1,78 @@
+#include "BlipBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const double pi = 3.14159265358979323846;
+static const double cutoff = 0.9;          // Nyquist 대비 통과 대역
+static const float dcPole = 0.999f;        // DC 차단 (약 7Hz @ 48kHz)
+static const float outputScale = 32767.0f; // 출력 1.0 = int16 최대
+
+/*
+ * phase p 의 커널: 샘플 i 가 step 중심에서 (i - taps / 2 + 1 - p / phases) 샘플 떨어진 위치의 sinc * Blackman 창
+ * - 행마다 정수 합이 정확히 1 << kernelBits 가 되도록 가운데 탭에서 반올림 오차를 맞춤 (적분하면 크기가 delta 인 step)
+ */
+BlipBuffer::BlipBuffer()
+{
+    for (int phase = 0; phase < phases; ++phase)
+    {
+        double sum = 0;
+        double values[taps];
+        for (int i = 0; i < taps; ++i)
+        {
+            double t = i - taps / 2 + 1 - double(phase) / phases;
+            double x = pi * cutoff * t;
+            double sinc = t == 0 ? 1.0 : std::sin(x) / x;
+            double w = 2 * pi * t / taps;
+            double window = std::fabs(t) >= taps / 2 ? 0.0 : 0.42 + 0.5 * std::cos(w) + 0.08 * std::cos(2 * w);
+            values[i] = sinc * window;
+            sum += values[i];
+        }
+        int32_t total = 0;
+        for (int i = 0; i < taps; ++i)
+        {
+            kernels[phase][i] = static_cast<int32_t>(std::lrint(values[i] / sum * (1 << kernelBits)));
+            total += kernels[phase][i];
+        }
+        kernels[phase][taps / 2 - 1] += (1 << kernelBits) - total;
+    }
+    setRates(1789773.0, 48000, 40000);
+}
+
+void BlipBuffer::setRates(double clockRate, int sampleRate, uint32_t maxFrameClocks)
+{
+    factor = static_cast<uint64_t>(sampleRate / clockRate * double(uint64_t(1) << fractionBits));
+    size_t maxSamples = ((maxFrameClocks * factor) >> fractionBits) + 1;
+    buffer.assign(maxSamples + taps, 0);
+    clear();
+}
+
+void BlipBuffer::clear()
+{
+    std::fill(buffer.begin(), buffer.end(), 0);
+    offset = 0;
+    integrator = dcInput = dcOutput = 0;
+}
+
+size_t BlipBuffer::endFrame(uint32_t time, std::vector<int16_t> &samples)
+{
+    uint64_t position = offset + time * factor;
+    size_t count = position >> fractionBits;
+    samples.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        integrator += buffer[i];
+        float input = integrator * (1.0f / (1 << (kernelBits + deltaBits)));
+        dcOutput = input - dcInput + dcPole * dcOutput;
+        dcInput = input;
+        float value = std::max(-1.0f, std::min(1.0f, dcOutput)) * outputScale;
+        samples[i] = static_cast<int16_t>(std::lrint(value));
+    }
+
+    // 아직 출력하지 않은 꼬리 (다음 프레임 앞부분)를 앞으로 옮김
+    std::copy(buffer.begin() + count, buffer.begin() + count + taps, buffer.begin());
+    std::fill(buffer.begin() + taps, buffer.end(), 0);
+    offset = position & ((uint64_t(1) << fractionBits) - 1);
+    return count;
+}
@@ -0,0 +1,338 @@
+#include "BlockCache.h"
+
+BlockCache::BlockCache(CPU &cpu)
+    : cpu(cpu), blockIndex(0x10000, -1), visits(0x10000, 0), codeBytes(0x10000, 0), pageBlocks(Bus::pageCount)
+{
+}
+
+BlockCache::~BlockCache()
+{
+    flush();
+}
+
+static bool endsBlock(uint8_t opcode, AddressMode mode)
+{
+    switch (opcode)
+    {
+    case 0x00: // BRK
+    case 0x20: // JSR
+    case 0x40: // RTI
+    case 0x4C: // JMP
+    case 0x60: // RTS
+    case 0x6C: // JMP (간접)
+        return true;
+    default: return mode == AddressMode::Relative;
+    }
+}
+
+// 메모리에 쓰는 명령어 (스택 포함)
+static bool writesMemory(uint8_t opcode)
+{
+    switch (opcode)
+    {
+    case 0x85: case 0x95: case 0x8D: case 0x9D: case 0x99: case 0x81: case 0x91: // STA
+    case 0x86: case 0x96: case 0x8E:                                             // STX
+    case 0x84: case 0x94: case 0x8C:                                             // STY
+    case 0xE6: case 0xF6: case 0xEE: case 0xFE:                                  // INC
+    case 0xC6: case 0xD6: case 0xCE: case 0xDE:                                  // DEC
+    case 0x06: case 0x16: case 0x0E: case 0x1E:                                  // ASL
+    case 0x46: case 0x56: case 0x4E: case 0x5E:                                  // LSR
+    case 0x26: case 0x36: case 0x2E: case 0x3E:                                  // ROL
+    case 0x66: case 0x76: case 0x6E: case 0x7E:                                  // ROR
+    case 0x48: case 0x08: case 0x20: case 0x00:                                  // PHA, PHP, JSR, BRK
+        return true;
+    default: return false;
+    }
+}
+
+// 블록이 걸친 페이지 (1~2개)
+static int blockPages(const Block &block, uint8_t pages[2])
+{
+    pages[0] = block.start >> 8;
+    pages[1] = (block.end - 1) >> 8 & 0xFF;
+    return pages[0] == pages[1] ? 1 : 2;
+}
+
+static uint8_t operandLength(AddressMode mode)
+{
+    switch (mode)
+    {
+    case AddressMode::Implied:
+    case AddressMode::Accumulator: return 0;
+    case AddressMode::Absolute:
+    case AddressMode::AbsoluteXIndexed:
+    case AddressMode::AbsoluteYIndexed:
+    case AddressMode::Indirect: return 2;
+    default: return 1;
+    }
+}
+
+Block *BlockCache::lookup(uint16_t pc)
+{
+    ++stats.lookups;
+    int32_t index = blockIndex[pc];
+    if (index >= 0)
+    {
+        Block &block = blocks[index];
+        // 뱅크 스위칭으로 페이지가 바뀌었으면 다시 디코딩
+        if (cpu.bus.readPages[block.start >> 8] == block.pageMemory[0] &&
+            cpu.bus.readPages[(block.end - 1) >> 8 & 0xFF] == block.pageMemory[1])
+        {
+            ++stats.hits;
+            return &block;
+        }
+        release(index);
+    }
+
+    if (visits[pc] < decodeThreshold)
+    {
+        ++visits[pc];
+        return nullptr;
+    }
+
+    if (freeBlocks.empty())
+    {
+        freeBlocks.push_back(blocks.size());
+        blocks.emplace_back();
+    }
+    index = freeBlocks.back();
+    Block &block = blocks[index];
+    if (!decode(block, pc))
+        return nullptr;
+    freeBlocks.pop_back();
+    ++stats.decodes;
+
+    blockIndex[pc] = index;
+    for (uint16_t address = block.start; address != block.end; ++address)
+        ++codeBytes[address];
+    uint8_t pages[2];
+    for (int i = 0, count = blockPages(block, pages); i < count; ++i)
+    {
+        uint8_t page = pages[i];
+        pageBlocks[page].push_back(index);
+        // RAM 에 있는 코드만 감시 (ROM 은 쓰기로 바뀌지 않음)
+        if (cpu.bus.pages[page].writable && !watchedPages[page])
+        {
+            watchedPages[page] = true;
+            cpu.bus.watch(page, true);
+        }
+    }
+    return &block;
+}
+
+bool BlockCache::decode(Block &block, uint16_t pc)
+{
+    block.ops.clear();
+    block.start = pc;
+    block.maxCycles = 0;
+    block.executions = 0;
+    block.native = nullptr;
+    block.nativeRejected = false;
+
+    while (block.ops.size() < maxBlockLength)
+    {
+        // 명령어가 두 페이지에 걸칠 수 있으므로 바이트마다 페이지 확인 (IO 페이지면 중단)
+        uint8_t bytes[3];
+        uint16_t address = pc;
+        const uint8_t *page = cpu.bus.readPages[address >> 8];
+        if (!page)
+            break;
+        bytes[0] = page[address & 0xFF];
+
+        const Instruction &instruction = CPU::instructionSet[bytes[0]];
+        if (instruction.operation == nullptr)
+            break;
+
+        uint8_t length = operandLength(instruction.mode);
+        bool readable = true;
+        for (uint8_t i = 1; i <= length; ++i)
+        {
+            address = pc + i;
+            page = cpu.bus.readPages[address >> 8];
+            if (!page)
+            {
+                readable = false;
+                break;
+            }
+            bytes[i] = page[address & 0xFF];
+        }
+        if (!readable)
+            break;
+
+        // 블록은 최대 두 페이지까지 (무효화/검증 단위)
+        uint16_t next = pc + 1 + length;
+        uint8_t startPage = block.start >> 8;
+        uint8_t lastPage = (next - 1) >> 8 & 0xFF;
+        if (lastPage != startPage && lastPage != static_cast<uint8_t>(startPage + 1))
+            break;
+
+        DecodedOp op;
+        op.operation = instruction.operation;
+        op.operand = length == 2 ? (bytes[1] | (bytes[2] << 8)) : (length == 1 ? bytes[1] : 0);
+        op.next = next;
+        op.mode = instruction.mode;
+        op.opcode = bytes[0];
+        op.cycles = instruction.cycles;
+        op.pageCycle = instruction.pageCycle;
+        op.fixed = true;
+        op.writes = writesMemory(op.opcode);
+        switch (instruction.mode)
+        {
+        case AddressMode::Implied:
+        case AddressMode::Accumulator: op.operand = 0; break;
+        case AddressMode::Immediate: op.operand = pc + 1; break;
+        case AddressMode::ZeroPage:
+        case AddressMode::Absolute: break;
+        case AddressMode::Relative: op.operand = next + static_cast<int8_t>(bytes[1]); break;
+        default: op.fixed = false; break;
+        }
+        block.ops.push_back(op);
+        block.maxCycles += op.cycles + (op.pageCycle ? 1 : 0) + (op.mode == AddressMode::Relative ? 2 : 0);
+        pc = next;
+
+        if (endsBlock(op.opcode, op.mode))
+            break;
+    }
+
+    if (block.ops.empty())
+        return false;
+
+    block.end = pc;
+    block.pageMemory[0] = cpu.bus.readPages[block.start >> 8];
+    block.pageMemory[1] = cpu.bus.readPages[(block.end - 1) >> 8 & 0xFF];
+    block.valid = true;
+    return true;
+}
+
+uint16_t BlockCache::resolveAddress(CPU &cpu, const DecodedOp &op)
+{
+    switch (op.mode)
+    {
+    case AddressMode::ZeroPageXIndexed: return (op.operand + cpu.x) & 0xFF;
+    case AddressMode::ZeroPageYIndexed: return (op.operand + cpu.y) & 0xFF;
+    case AddressMode::AbsoluteXIndexed: return cpu.indexAddress(op.operand, cpu.x);
+    case AddressMode::AbsoluteYIndexed: return cpu.indexAddress(op.operand, cpu.y);
+    case AddressMode::Indirect: return cpu.read16(op.operand, false);
+    case AddressMode::IndexedIndirect: return cpu.read16((op.operand + cpu.x) & 0xFF, true);
+    case AddressMode::IndirectIndexed: return cpu.indexAddress(cpu.read16(op.operand, true), cpu.y);
+    default: return op.operand;
+    }
+}
+
+/*
+ * 블록 실행
+ * - CPU::executeInstruction() 와 같은 순서로 pc/cycles/instructions 를 갱신하므로 인터프리터와 결과가 같음
+ * - 자기 수정 코드(무효화), 매핑 변경, halt, 사이클 예산 소진 시 명령어 단위로 중단
+ */
+void BlockCache::execute(Block &block, uint64_t targetCycles)
+{
+    const uint32_t startGeneration = generation;
+    const uint32_t startMapGeneration = cpu.bus.mapGeneration;
+    // 블록 전체가 예산 안에 들어오면 명령어마다 사이클을 확인할 필요 없음
+    const bool checkCycles = cpu.cycles + block.maxCycles >= targetCycles;
+    ++block.executions;
+
+    for (const DecodedOp &op : block.ops)
+    {
+        cpu.pc = op.next;
+        cpu.pageCrossed = false;
+        uint16_t address = op.fixed ? op.operand : resolveAddress(cpu, op);
+        op.operation(cpu, address);
+        cpu.cycles += op.cycles + (op.pageCycle && cpu.pageCrossed);
+        ++cpu.instructions;
+
+        // 무효화/매핑 변경/halt 는 모두 쓰기(bus 느린 경로)로만 일어남
+        if (op.writes &&
+            (generation != startGeneration || cpu.bus.mapGeneration != startMapGeneration || cpu.halted))
+            break;
+        if (checkCycles && cpu.cycles >= targetCycles)
+            break;
+    }
+}
+
+/*
+ * 블록을 만들지 않고 블록을 끝낼 때까지 인터프리터로 실행
+ * - 분기/점프, maxBlockLength 개, 이미 디코딩한 블록의 시작 주소에서 멈춤 (다음 lookup() 이 블록 경계에서 일어나도록)
+ * - 읽을 수 없는 페이지(IO)의 명령어는 하나만 실행
+ */
+void BlockCache::interpret(uint64_t targetCycles)
+{
+    ++stats.coldRuns;
+    for (int count = 0; count < maxBlockLength; ++count)
+    {
+        const uint8_t *page = cpu.bus.readPages[cpu.pc >> 8];
+        if (!page)
+        {
+            cpu.executeInstruction();
+            return;
+        }
+        uint8_t opcode = page[cpu.pc & 0xFF];
+        cpu.executeInstruction();
+        if (endsBlock(opcode, CPU::instructionSet[opcode].mode) || blockIndex[cpu.pc] >= 0 ||
+            cpu.cycles >= targetCycles || cpu.halted)
+            return;
+    }
+}
+
+// address 를 포함하는 블록만 무효화 (같은 페이지의 데이터 쓰기로 코드가 버려지지 않도록)
+void BlockCache::invalidate(uint16_t address)
+{
+    if (codeBytes[address] == 0) // 블록이 없는 바이트면 페이지의 블록 목록을 훑지 않음
+        return;
+    std::vector<int32_t> &list = pageBlocks[address >> 8];
+    for (size_t i = 0; i < list.size();)
+    {
+        const Block &block = blocks[list[i]];
+        if (static_cast<uint16_t>(address - block.start) < static_cast<uint16_t>(block.end - block.start))
+        {
+            ++generation;
+            release(list[i]); // list 에서 i 번째를 지우고 마지막 원소를 그 자리로 옮김
+        }
+        else
+            ++i;
+    }
+}
+
+void BlockCache::release(int32_t index)
+{
+    Block &block = blocks[index];
+    if (!block.valid)
+        return;
+
+    ++stats.invalidations;
+    block.valid = false;
+    block.native = nullptr;
+    if (blockIndex[block.start] == index)
+        blockIndex[block.start] = -1;
+    for (uint16_t address = block.start; address != block.end; ++address)
+        --codeBytes[address];
+
+    uint8_t pages[2];
+    for (int i = 0, count = blockPages(block, pages); i < count; ++i)
+    {
+        uint8_t page = pages[i];
+        std::vector<int32_t> &list = pageBlocks[page];
+        for (size_t j = 0; j < list.size(); ++j)
+        {
+            if (list[j] == index)
+            {
+                list[j] = list.back();
+                list.pop_back();
+                break;
+            }
+        }
+        if (list.empty() && watchedPages[page])
+        {
+            watchedPages[page] = false;
+            cpu.bus.watch(page, false);
+        }
+    }
+    freeBlocks.push_back(index);
+}
+
+void BlockCache::flush()
+{
+    for (size_t index = 0; index < blocks.size(); ++index)
+        release(index);
+    ++generation;
+}
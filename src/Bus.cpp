@@ -0,0 +1,90 @@
+#include "Bus.h"
+
+Bus::Bus()
+{
+    for (int page = 0; page < pageCount; ++page)
+        updateFastPath(page);
+}
+
+void Bus::mapMemory(uint8_t firstPage, int count, uint8_t *memory, size_t size, bool writable)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        Page &page = pages[(firstPage + i) & 0xFF];
+        page.memory = memory + ((static_cast<size_t>(i) << 8) % size);
+        page.writable = writable;
+        page.handler = nullptr;
+        page.romWriter = nullptr;
+        updateFastPath((firstPage + i) & 0xFF);
+    }
+}
+
+// 쓰기 금지 페이지이므로 const 를 떼어도 ROM 에 쓰는 일은 없음 (쓰기는 writer 로)
+void Bus::mapROM(uint8_t firstPage, int count, const uint8_t *memory, size_t size, const IOHandler *writer)
+{
+    mapMemory(firstPage, count, const_cast<uint8_t *>(memory), size, false);
+    for (int i = 0; i < count; ++i)
+        pages[(firstPage + i) & 0xFF].romWriter = writer;
+}
+
+void Bus::mapHandler(uint8_t firstPage, int count, const IOHandler *handler)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        Page &page = pages[(firstPage + i) & 0xFF];
+        page.memory = nullptr;
+        page.writable = false;
+        page.handler = handler;
+        page.romWriter = nullptr;
+        updateFastPath((firstPage + i) & 0xFF);
+    }
+}
+
+void Bus::unmap(uint8_t firstPage, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        Page &page = pages[(firstPage + i) & 0xFF];
+        page.memory = nullptr;
+        page.writable = false;
+        page.handler = nullptr;
+        page.romWriter = nullptr;
+        updateFastPath((firstPage + i) & 0xFF);
+    }
+}
+
+void Bus::watch(uint8_t page, bool enable)
+{
+    pages[page].watched += enable ? 1 : -1;
+    updateFastPath(page);
+}
+
+uint8_t Bus::readSlow(uint16_t address)
+{
+    const Page &page = pages[address >> 8];
+    if (page.handler)
+        return page.handler->read(page.handler->context, address);
+    return 0; // open bus
+}
+
+void Bus::writeSlow(uint16_t address, uint8_t value)
+{
+    const Page &page = pages[address >> 8];
+    if (page.handler)
+        page.handler->write(page.handler->context, address, value);
+    else if (page.romWriter)
+        page.romWriter->write(page.romWriter->context, address, value);
+    else if (page.memory && page.writable)
+        page.memory[address & 0xFF] = value;
+
+    if (page.watched && watcher)
+        watcher(watcherContext, address);
+}
+
+void Bus::updateFastPath(uint8_t index)
+{
+    const Page &page = pages[index];
+    readPages[index] = page.memory;
+    writePages[index] = (page.writable && !page.watched) ? page.memory : nullptr;
+    ++mapGeneration;
+}
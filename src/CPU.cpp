@@ -1,4 +1,7 @@
 #include "CPU.h"
+#include "BlockCache.h"
+#include "JIT.h"
+#include "State.h"
 
 #include <iostream>
 #include <stdexcept>
@@ -25,16 +28,22 @@ constexpr uint8_t FLAG_NEGATIVE = 7;
 #define CLEAR_FLAG(status, flag) ((status) &= ~(1 << (flag)))
 #define CHECK_FLAG(status, flag) ((status) & (1 << (flag)))
 
+const InstructionTable CPU::instructionSet = CPU::setupInstructionSet();
+
 CPU::CPU()
 {
     memory.reserve(0x10000);      // 최대 64KB
     memory.resize(0x10000, 0x00); // 초기화
-    setupInstructionSet();
+    bus.mapMemory(0x00, Bus::pageCount, memory.data(), memory.size(), true);
+    bus.watcher = onWatchedWrite;
+    bus.watcherContext = this;
 }
 
+CPU::~CPU() = default;
+
 uint8_t CPU::read(uint16_t address)
 {
-    return memory[address];
+    return bus.read(address);
 }
 
 uint16_t CPU::read16(uint16_t address, bool wrapAround = false)
@@ -47,10 +56,17 @@ uint16_t CPU::read16(uint16_t address, bool wrapAround = false)
 
 void CPU::write(uint16_t address, uint8_t value)
 {
-    memory[address] = value;
+    bus.write(address, value);
 }
 
 void CPU::execute()
+{
+    loadStat();
+    executeInstruction();
+    storeStat();
+}
+
+void CPU::executeInstruction()
 {
     uint8_t opcode = fetch();
 
@@ -59,14 +75,200 @@ void CPU::execute()
     //     std::cout << "Executing opcode: 0x" << std::hex << std::uppercase << +opcode << " " << pc << std::endl;
     // }
 
-    if (instructionSet.find(opcode) != instructionSet.end())
+    const Instruction &instruction = instructionSet[opcode];
+    if (instruction.operation == nullptr)
     {
-        auto &instruction = instructionSet[opcode];
-        uint16_t address = fetchAddress(instruction.mode);
-        instruction.operation(address);
-    }
-    else
         std::cerr << "Unknown opcode: " << std::hex << +opcode << "\n";
+        cycles += instruction.cycles; // NOP 처럼 취급
+        ++instructions;
+        return;
+    }
+
+    pageCrossed = false;
+    uint16_t address = fetchAddress(instruction.mode);
+    instruction.operation(*this, address);
+    cycles += instruction.cycles + (instruction.pageCycle && pageCrossed);
+    ++instructions;
+}
+
+/*
+ * cycleBudget 만큼 사이클을 소비하거나 halt 될 때까지 실행하고, 실제 소비한 사이클을 반환
+ * - 마지막 명령어만큼 예산을 넘칠 수 있음
+ */
+uint64_t CPU::run(uint64_t cycleBudget)
+{
+    loadStat();
+    uint64_t used = runInstructions(cycleBudget);
+    storeStat();
+    return used;
+}
+
+uint64_t CPU::runInstructions(uint64_t cycleBudget)
+{
+    uint64_t start = cycles;
+    uint64_t target = start + cycleBudget;
+
+    if (executionMode == ExecutionMode::JIT)
+    {
+        while (cycles < target && !halted)
+        {
+            Block *block = blockCache->lookup(pc);
+            if (!block)
+            {
+                blockCache->interpret(target);
+                continue;
+            }
+            if (!block->native && !block->nativeRejected && block->executions >= jit->hotThreshold)
+                jit->compile(*block);
+            // 네이티브 코드는 명령어마다 사이클을 확인하지 않으므로 블록 전체가 예산 안에 들어올 때만 실행
+            if (block->native && cycles + block->maxCycles < target)
+            {
+                ++block->executions;
+                ++jit->stats.nativeRuns;
+                block->native(this);
+            }
+            else
+                blockCache->execute(*block, target);
+        }
+        return cycles - start;
+    }
+
+    if (executionMode == ExecutionMode::BlockCache)
+    {
+        while (cycles < target && !halted)
+        {
+            Block *block = blockCache->lookup(pc);
+            if (block)
+                blockCache->execute(*block, target);
+            else
+                blockCache->interpret(target); // 아직 차가운 코드, IO 페이지 등 캐시할 수 없는 위치
+        }
+        return cycles - start;
+    }
+
+    while (cycles < target && !halted)
+        executeInstruction();
+    return cycles - start;
+}
+
+void CPU::setExecutionMode(ExecutionMode mode)
+{
+    if (mode == ExecutionMode::JIT && !jit && JIT::supported())
+    {
+        jit = std::make_unique<JIT>(*this);
+        if (!jit->available()) // 실행 가능 메모리를 얻지 못함
+            jit.reset();
+    }
+    if (mode == ExecutionMode::JIT && !jit)
+        mode = ExecutionMode::BlockCache;
+
+    executionMode = mode;
+    if (mode != ExecutionMode::JIT)
+        jit.reset();
+    if (mode == ExecutionMode::Interpreter)
+        blockCache.reset();
+    else if (!blockCache)
+        blockCache = std::make_unique<BlockCache>(*this);
+}
+
+// trap 주소가 있는 페이지만 감시하므로 다른 쓰기는 빠른 경로 그대로
+void CPU::setTrap(uint16_t address)
+{
+    if (trapAddress >= 0)
+        bus.watch(trapAddress >> 8, false);
+    trapAddress = address;
+    halted = false;
+    bus.watch(address >> 8, true);
+}
+
+/*
+ * save state
+ * - trap 주소/실행 모드는 설정이므로 저장하지 않음
+ * - memory 는 bus 에 쓰기 가능하게 매핑된 페이지만 저장 (ROM 과 다른 컴포넌트의 메모리는 제외)
+ */
+static void ramPages(const CPU &cpu, bool pages[Bus::pageCount])
+{
+    const uint8_t *base = cpu.memory.data();
+    for (int index = 0; index < Bus::pageCount; ++index)
+        pages[index] = false;
+    for (const Bus::Page &page : cpu.bus.pages)
+        if (page.writable && page.memory >= base && page.memory < base + cpu.memory.size())
+            pages[(page.memory - base) >> 8] = true;
+}
+
+void CPU::saveState(StateWriter &writer) const
+{
+    writer.section("CPU ", stateVersion);
+    writer.write8(a);
+    writer.write8(x);
+    writer.write8(y);
+    writer.write8(sp);
+    writer.write8(stat);
+    writer.write16(pc);
+    writer.write64(cycles);
+    writer.write64(instructions);
+    writer.writeBool(halted);
+
+    bool pages[Bus::pageCount];
+    ramPages(*this, pages);
+    for (int index = 0; index < Bus::pageCount; index += 8)
+    {
+        uint8_t bits = 0;
+        for (int bit = 0; bit < 8; ++bit)
+            bits |= pages[index + bit] << bit;
+        writer.write8(bits);
+    }
+    for (int index = 0; index < Bus::pageCount; ++index)
+        if (pages[index])
+            writer.bytes(&memory[index << 8], 0x100);
+}
+
+bool CPU::loadState(StateReader &reader)
+{
+    if (!reader.section("CPU ", stateVersion))
+        return false;
+    a = reader.read8();
+    x = reader.read8();
+    y = reader.read8();
+    sp = reader.read8();
+    setStat(reader.read8());
+    pc = reader.read16();
+    cycles = reader.read64();
+    instructions = reader.read64();
+    halted = reader.readBool();
+
+    uint8_t bits[Bus::pageCount / 8];
+    reader.bytes(bits, sizeof(bits));
+    for (int index = 0; index < Bus::pageCount; ++index)
+        if (bits[index >> 3] & (1 << (index & 7)))
+            reader.bytes(&memory[index << 8], 0x100);
+
+    // 메모리를 직접 덮어썼으므로 bus 감시로는 알 수 없음
+    if (blockCache)
+        blockCache->flush();
+    return reader.ok;
+}
+
+void CPU::saveState(std::vector<uint8_t> &buffer) const
+{
+    buffer.clear();
+    StateWriter writer(buffer);
+    saveState(writer);
+}
+
+bool CPU::loadState(const std::vector<uint8_t> &buffer)
+{
+    StateReader reader(buffer);
+    return loadState(reader);
+}
+
+void CPU::onWatchedWrite(void *context, uint16_t address)
+{
+    CPU &cpu = *static_cast<CPU *>(context);
+    if (address == cpu.trapAddress)
+        cpu.halted = true;
+    if (cpu.blockCache)
+        cpu.blockCache->invalidate(address);
 }
 
 uint8_t CPU::fetch()
@@ -76,7 +278,9 @@ uint8_t CPU::fetch()
 
 uint16_t CPU::fetchAbsolute()
 {
-    return read(pc++) | (read(pc++) << 8); // little endian
+    uint8_t low = read(pc++);
+    uint8_t high = read(pc++);
+    return low | (high << 8); // little endian
 }
 
 uint8_t CPU::fetchZeroPage(uint8_t offset = 0)
@@ -84,208 +288,244 @@ uint8_t CPU::fetchZeroPage(uint8_t offset = 0)
     return (read(pc++) + offset) & 0xFF; // Zero Page에서 랩 어라운드
 }
 
+uint16_t CPU::indexAddress(uint16_t base, uint8_t index)
+{
+    uint16_t address = base + index;
+    pageCrossed = (base ^ address) & 0xFF00;
+    return address;
+}
+
 uint16_t CPU::fetchAddress(AddressMode mode)
 {
     switch (mode)
     {
     case AddressMode::Implied: return 0;
-    case AddressMode::Accumulator: return -1;
+    case AddressMode::Accumulator: return 0;
     case AddressMode::Immediate: return pc++;
     case AddressMode::ZeroPage: return fetchZeroPage();
     case AddressMode::ZeroPageXIndexed: return fetchZeroPage(x);
     case AddressMode::ZeroPageYIndexed: return fetchZeroPage(y);
     case AddressMode::Absolute: return fetchAbsolute();
-    case AddressMode::AbsoluteXIndexed: return fetchAbsolute() + x;
-    case AddressMode::AbsoluteYIndexed: return fetchAbsolute() + y;
+    case AddressMode::AbsoluteXIndexed: return indexAddress(fetchAbsolute(), x);
+    case AddressMode::AbsoluteYIndexed: return indexAddress(fetchAbsolute(), y);
     case AddressMode::Indirect: return read16(fetchAbsolute());
     case AddressMode::IndexedIndirect: return read16(fetchZeroPage(x), true);
-    case AddressMode::IndirectIndexed: return read16(fetchZeroPage(), true) + y;
-    case AddressMode::Relative: return pc + 1 + static_cast<int8_t>(read(pc++));
+    case AddressMode::IndirectIndexed: return indexAddress(read16(fetchZeroPage(), true), y);
+    case AddressMode::Relative:
+    {
+        int8_t offset = static_cast<int8_t>(read(pc++));
+        return pc + offset;
+    }
     default: throw std::runtime_error("Unknown addressing mode");
     }
 }
 
+// Z/N 은 결과만 기록해 두고 읽을 때 계산
 void CPU::setZNFlag(uint8_t value)
 {
-    SET_FLAG(stat, FLAG_ZERO, value == 0);
-    SET_FLAG(stat, FLAG_NEGATIVE, value & 0x80);
+    zeroResult = value;
+    negativeResult = value;
+}
+
+uint8_t CPU::getStat() const
+{
+    uint8_t value = statBits & ~(1 << FLAG_CARRY | 1 << FLAG_ZERO | 1 << FLAG_OVERFLOW | 1 << FLAG_NEGATIVE);
+    value |= carry << FLAG_CARRY;
+    value |= (zeroResult == 0) << FLAG_ZERO;
+    value |= (overflowResult & 0x80) >> (7 - FLAG_OVERFLOW);
+    value |= negativeResult & 0x80;
+    return value;
+}
+
+void CPU::setStat(uint8_t value)
+{
+    stat = value;
+    statBits = value;
+    carry = CHECK_FLAG(value, FLAG_CARRY) ? 1 : 0;
+    zeroResult = CHECK_FLAG(value, FLAG_ZERO) ? 0 : 1;
+    overflowResult = value << (7 - FLAG_OVERFLOW);
+    negativeResult = value;
 }
 
 /* instruction set */
-void CPU::setupInstructionSet()
+InstructionTable CPU::setupInstructionSet()
 {
+    InstructionTable table{};
+
     // Access
-    instructionSet[0xA9] = { [this](uint16_t address) { LDA(address); }, AddressMode::Immediate };
-    instructionSet[0xA5] = { [this](uint16_t address) { LDA(address); }, AddressMode::ZeroPage };
-    instructionSet[0xB5] = { [this](uint16_t address) { LDA(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0xAD] = { [this](uint16_t address) { LDA(address); }, AddressMode::Absolute };
-    instructionSet[0xBD] = { [this](uint16_t address) { LDA(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0xB9] = { [this](uint16_t address) { LDA(address); }, AddressMode::AbsoluteYIndexed };
-    instructionSet[0xA1] = { [this](uint16_t address) { LDA(address); }, AddressMode::IndexedIndirect };
-    instructionSet[0xB1] = { [this](uint16_t address) { LDA(address); }, AddressMode::IndirectIndexed };
-    instructionSet[0x85] = { [this](uint16_t address) { STA(address); }, AddressMode::ZeroPage };
-    instructionSet[0x95] = { [this](uint16_t address) { STA(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0x8D] = { [this](uint16_t address) { STA(address); }, AddressMode::Absolute };
-    instructionSet[0x9D] = { [this](uint16_t address) { STA(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0x99] = { [this](uint16_t address) { STA(address); }, AddressMode::AbsoluteYIndexed };
-    instructionSet[0x81] = { [this](uint16_t address) { STA(address); }, AddressMode::IndexedIndirect };
-    instructionSet[0x91] = { [this](uint16_t address) { STA(address); }, AddressMode::IndirectIndexed };
-    instructionSet[0xA2] = { [this](uint16_t address) { LDX(address); }, AddressMode::Immediate };
-    instructionSet[0xA6] = { [this](uint16_t address) { LDX(address); }, AddressMode::ZeroPage };
-    instructionSet[0xB6] = { [this](uint16_t address) { LDX(address); }, AddressMode::ZeroPageYIndexed };
-    instructionSet[0xAE] = { [this](uint16_t address) { LDX(address); }, AddressMode::Absolute };
-    instructionSet[0xBE] = { [this](uint16_t address) { LDX(address); }, AddressMode::AbsoluteYIndexed };
-    instructionSet[0x86] = { [this](uint16_t address) { STX(address); }, AddressMode::ZeroPage };
-    instructionSet[0x96] = { [this](uint16_t address) { STX(address); }, AddressMode::ZeroPageYIndexed };
-    instructionSet[0x8E] = { [this](uint16_t address) { STX(address); }, AddressMode::Absolute };
-    instructionSet[0xA0] = { [this](uint16_t address) { LDY(address); }, AddressMode::Immediate };
-    instructionSet[0xA4] = { [this](uint16_t address) { LDY(address); }, AddressMode::ZeroPage };
-    instructionSet[0xB4] = { [this](uint16_t address) { LDY(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0xAC] = { [this](uint16_t address) { LDY(address); }, AddressMode::Absolute };
-    instructionSet[0xBC] = { [this](uint16_t address) { LDY(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0x84] = { [this](uint16_t address) { STY(address); }, AddressMode::ZeroPage };
-    instructionSet[0x94] = { [this](uint16_t address) { STY(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0x8C] = { [this](uint16_t address) { STY(address); }, AddressMode::Absolute };
+    table[0xA9] = { [](CPU &cpu, uint16_t address) { cpu.LDA(address); }, AddressMode::Immediate, 2 };
+    table[0xA5] = { [](CPU &cpu, uint16_t address) { cpu.LDA(address); }, AddressMode::ZeroPage, 3 };
+    table[0xB5] = { [](CPU &cpu, uint16_t address) { cpu.LDA(address); }, AddressMode::ZeroPageXIndexed, 4 };
+    table[0xAD] = { [](CPU &cpu, uint16_t address) { cpu.LDA(address); }, AddressMode::Absolute, 4 };
+    table[0xBD] = { [](CPU &cpu, uint16_t address) { cpu.LDA(address); }, AddressMode::AbsoluteXIndexed, 4, true };
+    table[0xB9] = { [](CPU &cpu, uint16_t address) { cpu.LDA(address); }, AddressMode::AbsoluteYIndexed, 4, true };
+    table[0xA1] = { [](CPU &cpu, uint16_t address) { cpu.LDA(address); }, AddressMode::IndexedIndirect, 6 };
+    table[0xB1] = { [](CPU &cpu, uint16_t address) { cpu.LDA(address); }, AddressMode::IndirectIndexed, 5, true };
+    table[0x85] = { [](CPU &cpu, uint16_t address) { cpu.STA(address); }, AddressMode::ZeroPage, 3 };
+    table[0x95] = { [](CPU &cpu, uint16_t address) { cpu.STA(address); }, AddressMode::ZeroPageXIndexed, 4 };
+    table[0x8D] = { [](CPU &cpu, uint16_t address) { cpu.STA(address); }, AddressMode::Absolute, 4 };
+    table[0x9D] = { [](CPU &cpu, uint16_t address) { cpu.STA(address); }, AddressMode::AbsoluteXIndexed, 5 };
+    table[0x99] = { [](CPU &cpu, uint16_t address) { cpu.STA(address); }, AddressMode::AbsoluteYIndexed, 5 };
+    table[0x81] = { [](CPU &cpu, uint16_t address) { cpu.STA(address); }, AddressMode::IndexedIndirect, 6 };
+    table[0x91] = { [](CPU &cpu, uint16_t address) { cpu.STA(address); }, AddressMode::IndirectIndexed, 6 };
+    table[0xA2] = { [](CPU &cpu, uint16_t address) { cpu.LDX(address); }, AddressMode::Immediate, 2 };
+    table[0xA6] = { [](CPU &cpu, uint16_t address) { cpu.LDX(address); }, AddressMode::ZeroPage, 3 };
+    table[0xB6] = { [](CPU &cpu, uint16_t address) { cpu.LDX(address); }, AddressMode::ZeroPageYIndexed, 4 };
+    table[0xAE] = { [](CPU &cpu, uint16_t address) { cpu.LDX(address); }, AddressMode::Absolute, 4 };
+    table[0xBE] = { [](CPU &cpu, uint16_t address) { cpu.LDX(address); }, AddressMode::AbsoluteYIndexed, 4, true };
+    table[0x86] = { [](CPU &cpu, uint16_t address) { cpu.STX(address); }, AddressMode::ZeroPage, 3 };
+    table[0x96] = { [](CPU &cpu, uint16_t address) { cpu.STX(address); }, AddressMode::ZeroPageYIndexed, 4 };
+    table[0x8E] = { [](CPU &cpu, uint16_t address) { cpu.STX(address); }, AddressMode::Absolute, 4 };
+    table[0xA0] = { [](CPU &cpu, uint16_t address) { cpu.LDY(address); }, AddressMode::Immediate, 2 };
+    table[0xA4] = { [](CPU &cpu, uint16_t address) { cpu.LDY(address); }, AddressMode::ZeroPage, 3 };
+    table[0xB4] = { [](CPU &cpu, uint16_t address) { cpu.LDY(address); }, AddressMode::ZeroPageXIndexed, 4 };
+    table[0xAC] = { [](CPU &cpu, uint16_t address) { cpu.LDY(address); }, AddressMode::Absolute, 4 };
+    table[0xBC] = { [](CPU &cpu, uint16_t address) { cpu.LDY(address); }, AddressMode::AbsoluteXIndexed, 4, true };
+    table[0x84] = { [](CPU &cpu, uint16_t address) { cpu.STY(address); }, AddressMode::ZeroPage, 3 };
+    table[0x94] = { [](CPU &cpu, uint16_t address) { cpu.STY(address); }, AddressMode::ZeroPageXIndexed, 4 };
+    table[0x8C] = { [](CPU &cpu, uint16_t address) { cpu.STY(address); }, AddressMode::Absolute, 4 };
 
     // Transfer
-    instructionSet[0xAA] = { [this](uint16_t) { TAX(); }, AddressMode::Implied };
-    instructionSet[0x8A] = { [this](uint16_t) { TXA(); }, AddressMode::Implied };
-    instructionSet[0xA8] = { [this](uint16_t) { TAY(); }, AddressMode::Implied };
-    instructionSet[0x98] = { [this](uint16_t) { TYA(); }, AddressMode::Implied };
+    table[0xAA] = { [](CPU &cpu, uint16_t) { cpu.TAX(); }, AddressMode::Implied, 2 };
+    table[0x8A] = { [](CPU &cpu, uint16_t) { cpu.TXA(); }, AddressMode::Implied, 2 };
+    table[0xA8] = { [](CPU &cpu, uint16_t) { cpu.TAY(); }, AddressMode::Implied, 2 };
+    table[0x98] = { [](CPU &cpu, uint16_t) { cpu.TYA(); }, AddressMode::Implied, 2 };
 
     // Arithmetic
-    instructionSet[0x69] = { [this](uint16_t address) { ADC(address); }, AddressMode::Immediate };
-    instructionSet[0x65] = { [this](uint16_t address) { ADC(address); }, AddressMode::ZeroPage };
-    instructionSet[0x75] = { [this](uint16_t address) { ADC(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0x6D] = { [this](uint16_t address) { ADC(address); }, AddressMode::Absolute };
-    instructionSet[0x7D] = { [this](uint16_t address) { ADC(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0x79] = { [this](uint16_t address) { ADC(address); }, AddressMode::AbsoluteYIndexed };
-    instructionSet[0x61] = { [this](uint16_t address) { ADC(address); }, AddressMode::IndexedIndirect };
-    instructionSet[0x71] = { [this](uint16_t address) { ADC(address); }, AddressMode::IndirectIndexed };
-    instructionSet[0xE9] = { [this](uint16_t address) { SBC(address); }, AddressMode::Immediate };
-    instructionSet[0xE5] = { [this](uint16_t address) { SBC(address); }, AddressMode::ZeroPage };
-    instructionSet[0xF5] = { [this](uint16_t address) { SBC(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0xED] = { [this](uint16_t address) { SBC(address); }, AddressMode::Absolute };
-    instructionSet[0xFD] = { [this](uint16_t address) { SBC(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0xF9] = { [this](uint16_t address) { SBC(address); }, AddressMode::AbsoluteYIndexed };
-    instructionSet[0xE1] = { [this](uint16_t address) { SBC(address); }, AddressMode::IndexedIndirect };
-    instructionSet[0xF1] = { [this](uint16_t address) { SBC(address); }, AddressMode::IndirectIndexed };
-    instructionSet[0xE6] = { [this](uint16_t address) { INC(address); }, AddressMode::ZeroPage };
-    instructionSet[0xF6] = { [this](uint16_t address) { INC(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0xEE] = { [this](uint16_t address) { INC(address); }, AddressMode::Absolute };
-    instructionSet[0xFE] = { [this](uint16_t address) { INC(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0xC6] = { [this](uint16_t address) { DEC(address); }, AddressMode::ZeroPage };
-    instructionSet[0xD6] = { [this](uint16_t address) { DEC(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0xCE] = { [this](uint16_t address) { DEC(address); }, AddressMode::Absolute };
-    instructionSet[0xDE] = { [this](uint16_t address) { DEC(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0xE8] = { [this](uint16_t) { INX(); }, AddressMode::Implied };
-    instructionSet[0xCA] = { [this](uint16_t) { DEX(); }, AddressMode::Implied };
-    instructionSet[0xC8] = { [this](uint16_t) { INY(); }, AddressMode::Implied };
-    instructionSet[0x88] = { [this](uint16_t) { DEY(); }, AddressMode::Implied };
+    table[0x69] = { [](CPU &cpu, uint16_t address) { cpu.ADC(address); }, AddressMode::Immediate, 2 };
+    table[0x65] = { [](CPU &cpu, uint16_t address) { cpu.ADC(address); }, AddressMode::ZeroPage, 3 };
+    table[0x75] = { [](CPU &cpu, uint16_t address) { cpu.ADC(address); }, AddressMode::ZeroPageXIndexed, 4 };
+    table[0x6D] = { [](CPU &cpu, uint16_t address) { cpu.ADC(address); }, AddressMode::Absolute, 4 };
+    table[0x7D] = { [](CPU &cpu, uint16_t address) { cpu.ADC(address); }, AddressMode::AbsoluteXIndexed, 4, true };
+    table[0x79] = { [](CPU &cpu, uint16_t address) { cpu.ADC(address); }, AddressMode::AbsoluteYIndexed, 4, true };
+    table[0x61] = { [](CPU &cpu, uint16_t address) { cpu.ADC(address); }, AddressMode::IndexedIndirect, 6 };
+    table[0x71] = { [](CPU &cpu, uint16_t address) { cpu.ADC(address); }, AddressMode::IndirectIndexed, 5, true };
+    table[0xE9] = { [](CPU &cpu, uint16_t address) { cpu.SBC(address); }, AddressMode::Immediate, 2 };
+    table[0xE5] = { [](CPU &cpu, uint16_t address) { cpu.SBC(address); }, AddressMode::ZeroPage, 3 };
+    table[0xF5] = { [](CPU &cpu, uint16_t address) { cpu.SBC(address); }, AddressMode::ZeroPageXIndexed, 4 };
+    table[0xED] = { [](CPU &cpu, uint16_t address) { cpu.SBC(address); }, AddressMode::Absolute, 4 };
+    table[0xFD] = { [](CPU &cpu, uint16_t address) { cpu.SBC(address); }, AddressMode::AbsoluteXIndexed, 4, true };
+    table[0xF9] = { [](CPU &cpu, uint16_t address) { cpu.SBC(address); }, AddressMode::AbsoluteYIndexed, 4, true };
+    table[0xE1] = { [](CPU &cpu, uint16_t address) { cpu.SBC(address); }, AddressMode::IndexedIndirect, 6 };
+    table[0xF1] = { [](CPU &cpu, uint16_t address) { cpu.SBC(address); }, AddressMode::IndirectIndexed, 5, true };
+    table[0xE6] = { [](CPU &cpu, uint16_t address) { cpu.INC(address); }, AddressMode::ZeroPage, 5 };
+    table[0xF6] = { [](CPU &cpu, uint16_t address) { cpu.INC(address); }, AddressMode::ZeroPageXIndexed, 6 };
+    table[0xEE] = { [](CPU &cpu, uint16_t address) { cpu.INC(address); }, AddressMode::Absolute, 6 };
+    table[0xFE] = { [](CPU &cpu, uint16_t address) { cpu.INC(address); }, AddressMode::AbsoluteXIndexed, 7 };
+    table[0xC6] = { [](CPU &cpu, uint16_t address) { cpu.DEC(address); }, AddressMode::ZeroPage, 5 };
+    table[0xD6] = { [](CPU &cpu, uint16_t address) { cpu.DEC(address); }, AddressMode::ZeroPageXIndexed, 6 };
+    table[0xCE] = { [](CPU &cpu, uint16_t address) { cpu.DEC(address); }, AddressMode::Absolute, 6 };
+    table[0xDE] = { [](CPU &cpu, uint16_t address) { cpu.DEC(address); }, AddressMode::AbsoluteXIndexed, 7 };
+    table[0xE8] = { [](CPU &cpu, uint16_t) { cpu.INX(); }, AddressMode::Implied, 2 };
+    table[0xCA] = { [](CPU &cpu, uint16_t) { cpu.DEX(); }, AddressMode::Implied, 2 };
+    table[0xC8] = { [](CPU &cpu, uint16_t) { cpu.INY(); }, AddressMode::Implied, 2 };
+    table[0x88] = { [](CPU &cpu, uint16_t) { cpu.DEY(); }, AddressMode::Implied, 2 };
 
     // Shift
-    instructionSet[0x0A] = { [this](uint16_t address) { ASL(address); }, AddressMode::Accumulator };
-    instructionSet[0x06] = { [this](uint16_t address) { ASL(address); }, AddressMode::ZeroPage };
-    instructionSet[0x16] = { [this](uint16_t address) { ASL(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0x0E] = { [this](uint16_t address) { ASL(address); }, AddressMode::Absolute };
-    instructionSet[0x1E] = { [this](uint16_t address) { ASL(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0x4A] = { [this](uint16_t address) { LSR(address); }, AddressMode::Accumulator };
-    instructionSet[0x46] = { [this](uint16_t address) { LSR(address); }, AddressMode::ZeroPage };
-    instructionSet[0x56] = { [this](uint16_t address) { LSR(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0x4E] = { [this](uint16_t address) { LSR(address); }, AddressMode::Absolute };
-    instructionSet[0x5E] = { [this](uint16_t address) { LSR(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0x2A] = { [this](uint16_t address) { ROL(address); }, AddressMode::Accumulator };
-    instructionSet[0x26] = { [this](uint16_t address) { ROL(address); }, AddressMode::ZeroPage };
-    instructionSet[0x36] = { [this](uint16_t address) { ROL(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0x2E] = { [this](uint16_t address) { ROL(address); }, AddressMode::Absolute };
-    instructionSet[0x3E] = { [this](uint16_t address) { ROL(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0x6A] = { [this](uint16_t address) { ROR(address); }, AddressMode::Accumulator };
-    instructionSet[0x66] = { [this](uint16_t address) { ROR(address); }, AddressMode::ZeroPage };
-    instructionSet[0x76] = { [this](uint16_t address) { ROR(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0x6E] = { [this](uint16_t address) { ROR(address); }, AddressMode::Absolute };
-    instructionSet[0x7E] = { [this](uint16_t address) { ROR(address); }, AddressMode::AbsoluteXIndexed };
+    table[0x0A] = { [](CPU &cpu, uint16_t) { cpu.ASL(); }, AddressMode::Accumulator, 2 };
+    table[0x06] = { [](CPU &cpu, uint16_t address) { cpu.ASL(address); }, AddressMode::ZeroPage, 5 };
+    table[0x16] = { [](CPU &cpu, uint16_t address) { cpu.ASL(address); }, AddressMode::ZeroPageXIndexed, 6 };
+    table[0x0E] = { [](CPU &cpu, uint16_t address) { cpu.ASL(address); }, AddressMode::Absolute, 6 };
+    table[0x1E] = { [](CPU &cpu, uint16_t address) { cpu.ASL(address); }, AddressMode::AbsoluteXIndexed, 7 };
+    table[0x4A] = { [](CPU &cpu, uint16_t) { cpu.LSR(); }, AddressMode::Accumulator, 2 };
+    table[0x46] = { [](CPU &cpu, uint16_t address) { cpu.LSR(address); }, AddressMode::ZeroPage, 5 };
+    table[0x56] = { [](CPU &cpu, uint16_t address) { cpu.LSR(address); }, AddressMode::ZeroPageXIndexed, 6 };
+    table[0x4E] = { [](CPU &cpu, uint16_t address) { cpu.LSR(address); }, AddressMode::Absolute, 6 };
+    table[0x5E] = { [](CPU &cpu, uint16_t address) { cpu.LSR(address); }, AddressMode::AbsoluteXIndexed, 7 };
+    table[0x2A] = { [](CPU &cpu, uint16_t) { cpu.ROL(); }, AddressMode::Accumulator, 2 };
+    table[0x26] = { [](CPU &cpu, uint16_t address) { cpu.ROL(address); }, AddressMode::ZeroPage, 5 };
+    table[0x36] = { [](CPU &cpu, uint16_t address) { cpu.ROL(address); }, AddressMode::ZeroPageXIndexed, 6 };
+    table[0x2E] = { [](CPU &cpu, uint16_t address) { cpu.ROL(address); }, AddressMode::Absolute, 6 };
+    table[0x3E] = { [](CPU &cpu, uint16_t address) { cpu.ROL(address); }, AddressMode::AbsoluteXIndexed, 7 };
+    table[0x6A] = { [](CPU &cpu, uint16_t) { cpu.ROR(); }, AddressMode::Accumulator, 2 };
+    table[0x66] = { [](CPU &cpu, uint16_t address) { cpu.ROR(address); }, AddressMode::ZeroPage, 5 };
+    table[0x76] = { [](CPU &cpu, uint16_t address) { cpu.ROR(address); }, AddressMode::ZeroPageXIndexed, 6 };
+    table[0x6E] = { [](CPU &cpu, uint16_t address) { cpu.ROR(address); }, AddressMode::Absolute, 6 };
+    table[0x7E] = { [](CPU &cpu, uint16_t address) { cpu.ROR(address); }, AddressMode::AbsoluteXIndexed, 7 };
 
     // Bitwise
-    instructionSet[0x29] = { [this](uint16_t address) { AND(address); }, AddressMode::Immediate };
-    instructionSet[0x25] = { [this](uint16_t address) { AND(address); }, AddressMode::ZeroPage };
-    instructionSet[0x35] = { [this](uint16_t address) { AND(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0x2D] = { [this](uint16_t address) { AND(address); }, AddressMode::Absolute };
-    instructionSet[0x3D] = { [this](uint16_t address) { AND(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0x39] = { [this](uint16_t address) { AND(address); }, AddressMode::AbsoluteYIndexed };
-    instructionSet[0x21] = { [this](uint16_t address) { AND(address); }, AddressMode::IndexedIndirect };
-    instructionSet[0x31] = { [this](uint16_t address) { AND(address); }, AddressMode::IndirectIndexed };
-    instructionSet[0x09] = { [this](uint16_t address) { ORA(address); }, AddressMode::Immediate };
-    instructionSet[0x05] = { [this](uint16_t address) { ORA(address); }, AddressMode::ZeroPage };
-    instructionSet[0x15] = { [this](uint16_t address) { ORA(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0x0D] = { [this](uint16_t address) { ORA(address); }, AddressMode::Absolute };
-    instructionSet[0x1D] = { [this](uint16_t address) { ORA(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0x19] = { [this](uint16_t address) { ORA(address); }, AddressMode::AbsoluteYIndexed };
-    instructionSet[0x01] = { [this](uint16_t address) { ORA(address); }, AddressMode::IndexedIndirect };
-    instructionSet[0x11] = { [this](uint16_t address) { ORA(address); }, AddressMode::IndirectIndexed };
-    instructionSet[0x49] = { [this](uint16_t address) { EOR(address); }, AddressMode::Immediate };
-    instructionSet[0x45] = { [this](uint16_t address) { EOR(address); }, AddressMode::ZeroPage };
-    instructionSet[0x55] = { [this](uint16_t address) { EOR(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0x4D] = { [this](uint16_t address) { EOR(address); }, AddressMode::Absolute };
-    instructionSet[0x5D] = { [this](uint16_t address) { EOR(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0x59] = { [this](uint16_t address) { EOR(address); }, AddressMode::AbsoluteYIndexed };
-    instructionSet[0x41] = { [this](uint16_t address) { EOR(address); }, AddressMode::IndexedIndirect };
-    instructionSet[0x51] = { [this](uint16_t address) { EOR(address); }, AddressMode::IndirectIndexed };
-    instructionSet[0x24] = { [this](uint16_t address) { BIT(address); }, AddressMode::ZeroPage };
-    instructionSet[0x2C] = { [this](uint16_t address) { BIT(address); }, AddressMode::Absolute };
+    table[0x29] = { [](CPU &cpu, uint16_t address) { cpu.AND(address); }, AddressMode::Immediate, 2 };
+    table[0x25] = { [](CPU &cpu, uint16_t address) { cpu.AND(address); }, AddressMode::ZeroPage, 3 };
+    table[0x35] = { [](CPU &cpu, uint16_t address) { cpu.AND(address); }, AddressMode::ZeroPageXIndexed, 4 };
+    table[0x2D] = { [](CPU &cpu, uint16_t address) { cpu.AND(address); }, AddressMode::Absolute, 4 };
+    table[0x3D] = { [](CPU &cpu, uint16_t address) { cpu.AND(address); }, AddressMode::AbsoluteXIndexed, 4, true };
+    table[0x39] = { [](CPU &cpu, uint16_t address) { cpu.AND(address); }, AddressMode::AbsoluteYIndexed, 4, true };
+    table[0x21] = { [](CPU &cpu, uint16_t address) { cpu.AND(address); }, AddressMode::IndexedIndirect, 6 };
+    table[0x31] = { [](CPU &cpu, uint16_t address) { cpu.AND(address); }, AddressMode::IndirectIndexed, 5, true };
+    table[0x09] = { [](CPU &cpu, uint16_t address) { cpu.ORA(address); }, AddressMode::Immediate, 2 };
+    table[0x05] = { [](CPU &cpu, uint16_t address) { cpu.ORA(address); }, AddressMode::ZeroPage, 3 };
+    table[0x15] = { [](CPU &cpu, uint16_t address) { cpu.ORA(address); }, AddressMode::ZeroPageXIndexed, 4 };
+    table[0x0D] = { [](CPU &cpu, uint16_t address) { cpu.ORA(address); }, AddressMode::Absolute, 4 };
+    table[0x1D] = { [](CPU &cpu, uint16_t address) { cpu.ORA(address); }, AddressMode::AbsoluteXIndexed, 4, true };
+    table[0x19] = { [](CPU &cpu, uint16_t address) { cpu.ORA(address); }, AddressMode::AbsoluteYIndexed, 4, true };
+    table[0x01] = { [](CPU &cpu, uint16_t address) { cpu.ORA(address); }, AddressMode::IndexedIndirect, 6 };
+    table[0x11] = { [](CPU &cpu, uint16_t address) { cpu.ORA(address); }, AddressMode::IndirectIndexed, 5, true };
+    table[0x49] = { [](CPU &cpu, uint16_t address) { cpu.EOR(address); }, AddressMode::Immediate, 2 };
+    table[0x45] = { [](CPU &cpu, uint16_t address) { cpu.EOR(address); }, AddressMode::ZeroPage, 3 };
+    table[0x55] = { [](CPU &cpu, uint16_t address) { cpu.EOR(address); }, AddressMode::ZeroPageXIndexed, 4 };
+    table[0x4D] = { [](CPU &cpu, uint16_t address) { cpu.EOR(address); }, AddressMode::Absolute, 4 };
+    table[0x5D] = { [](CPU &cpu, uint16_t address) { cpu.EOR(address); }, AddressMode::AbsoluteXIndexed, 4, true };
+    table[0x59] = { [](CPU &cpu, uint16_t address) { cpu.EOR(address); }, AddressMode::AbsoluteYIndexed, 4, true };
+    table[0x41] = { [](CPU &cpu, uint16_t address) { cpu.EOR(address); }, AddressMode::IndexedIndirect, 6 };
+    table[0x51] = { [](CPU &cpu, uint16_t address) { cpu.EOR(address); }, AddressMode::IndirectIndexed, 5, true };
+    table[0x24] = { [](CPU &cpu, uint16_t address) { cpu.BIT(address); }, AddressMode::ZeroPage, 3 };
+    table[0x2C] = { [](CPU &cpu, uint16_t address) { cpu.BIT(address); }, AddressMode::Absolute, 4 };
 
     // Compare
-    instructionSet[0xC9] = { [this](uint16_t address) { CMP(address); }, AddressMode::Immediate };
-    instructionSet[0xC5] = { [this](uint16_t address) { CMP(address); }, AddressMode::ZeroPage };
-    instructionSet[0xD5] = { [this](uint16_t address) { CMP(address); }, AddressMode::ZeroPageXIndexed };
-    instructionSet[0xCD] = { [this](uint16_t address) { CMP(address); }, AddressMode::Absolute };
-    instructionSet[0xDD] = { [this](uint16_t address) { CMP(address); }, AddressMode::AbsoluteXIndexed };
-    instructionSet[0xD9] = { [this](uint16_t address) { CMP(address); }, AddressMode::AbsoluteYIndexed };
-    instructionSet[0xC1] = { [this](uint16_t address) { CMP(address); }, AddressMode::IndexedIndirect };
-    instructionSet[0xD1] = { [this](uint16_t address) { CMP(address); }, AddressMode::IndirectIndexed };
-    instructionSet[0xE0] = { [this](uint16_t address) { CPX(address); }, AddressMode::Immediate };
-    instructionSet[0xE4] = { [this](uint16_t address) { CPX(address); }, AddressMode::ZeroPage };
-    instructionSet[0xEC] = { [this](uint16_t address) { CPX(address); }, AddressMode::Absolute };
-    instructionSet[0xC0] = { [this](uint16_t address) { CPY(address); }, AddressMode::Immediate };
-    instructionSet[0xC4] = { [this](uint16_t address) { CPY(address); }, AddressMode::ZeroPage };
-    instructionSet[0xCC] = { [this](uint16_t address) { CPY(address); }, AddressMode::Absolute };
+    table[0xC9] = { [](CPU &cpu, uint16_t address) { cpu.CMP(address); }, AddressMode::Immediate, 2 };
+    table[0xC5] = { [](CPU &cpu, uint16_t address) { cpu.CMP(address); }, AddressMode::ZeroPage, 3 };
+    table[0xD5] = { [](CPU &cpu, uint16_t address) { cpu.CMP(address); }, AddressMode::ZeroPageXIndexed, 4 };
+    table[0xCD] = { [](CPU &cpu, uint16_t address) { cpu.CMP(address); }, AddressMode::Absolute, 4 };
+    table[0xDD] = { [](CPU &cpu, uint16_t address) { cpu.CMP(address); }, AddressMode::AbsoluteXIndexed, 4, true };
+    table[0xD9] = { [](CPU &cpu, uint16_t address) { cpu.CMP(address); }, AddressMode::AbsoluteYIndexed, 4, true };
+    table[0xC1] = { [](CPU &cpu, uint16_t address) { cpu.CMP(address); }, AddressMode::IndexedIndirect, 6 };
+    table[0xD1] = { [](CPU &cpu, uint16_t address) { cpu.CMP(address); }, AddressMode::IndirectIndexed, 5, true };
+    table[0xE0] = { [](CPU &cpu, uint16_t address) { cpu.CPX(address); }, AddressMode::Immediate, 2 };
+    table[0xE4] = { [](CPU &cpu, uint16_t address) { cpu.CPX(address); }, AddressMode::ZeroPage, 3 };
+    table[0xEC] = { [](CPU &cpu, uint16_t address) { cpu.CPX(address); }, AddressMode::Absolute, 4 };
+    table[0xC0] = { [](CPU &cpu, uint16_t address) { cpu.CPY(address); }, AddressMode::Immediate, 2 };
+    table[0xC4] = { [](CPU &cpu, uint16_t address) { cpu.CPY(address); }, AddressMode::ZeroPage, 3 };
+    table[0xCC] = { [](CPU &cpu, uint16_t address) { cpu.CPY(address); }, AddressMode::Absolute, 4 };
 
     // branch
-    instructionSet[0x90] = { [this](uint16_t address) { BCC(address); }, AddressMode::Relative };
-    instructionSet[0xB0] = { [this](uint16_t address) { BCS(address); }, AddressMode::Relative };
-    instructionSet[0xF0] = { [this](uint16_t address) { BEQ(address); }, AddressMode::Relative };
-    instructionSet[0xD0] = { [this](uint16_t address) { BNE(address); }, AddressMode::Relative };
-    instructionSet[0x10] = { [this](uint16_t address) { BPL(address); }, AddressMode::Relative };
-    instructionSet[0x30] = { [this](uint16_t address) { BMI(address); }, AddressMode::Relative };
-    instructionSet[0x50] = { [this](uint16_t address) { BVC(address); }, AddressMode::Relative };
-    instructionSet[0x70] = { [this](uint16_t address) { BVS(address); }, AddressMode::Relative };
+    table[0x90] = { [](CPU &cpu, uint16_t address) { cpu.BCC(address); }, AddressMode::Relative, 2 };
+    table[0xB0] = { [](CPU &cpu, uint16_t address) { cpu.BCS(address); }, AddressMode::Relative, 2 };
+    table[0xF0] = { [](CPU &cpu, uint16_t address) { cpu.BEQ(address); }, AddressMode::Relative, 2 };
+    table[0xD0] = { [](CPU &cpu, uint16_t address) { cpu.BNE(address); }, AddressMode::Relative, 2 };
+    table[0x10] = { [](CPU &cpu, uint16_t address) { cpu.BPL(address); }, AddressMode::Relative, 2 };
+    table[0x30] = { [](CPU &cpu, uint16_t address) { cpu.BMI(address); }, AddressMode::Relative, 2 };
+    table[0x50] = { [](CPU &cpu, uint16_t address) { cpu.BVC(address); }, AddressMode::Relative, 2 };
+    table[0x70] = { [](CPU &cpu, uint16_t address) { cpu.BVS(address); }, AddressMode::Relative, 2 };
 
     // jump
-    instructionSet[0x4C] = { [this](uint16_t address) { JMP(address); }, AddressMode::Absolute };
-    instructionSet[0x6C] = { [this](uint16_t address) { JMP(address); }, AddressMode::Indirect };
-    instructionSet[0x20] = { [this](uint16_t address) { JSR(address); }, AddressMode::Absolute };
-    instructionSet[0x60] = { [this](uint16_t) { RTS(); }, AddressMode::Implied };
-    instructionSet[0x00] = { [this](uint16_t) { BRK(); }, AddressMode::Implied };
-    instructionSet[0x40] = { [this](uint16_t) { RTI(); }, AddressMode::Implied };
+    table[0x4C] = { [](CPU &cpu, uint16_t address) { cpu.JMP(address); }, AddressMode::Absolute, 3 };
+    table[0x6C] = { [](CPU &cpu, uint16_t address) { cpu.JMP(address); }, AddressMode::Indirect, 5 };
+    table[0x20] = { [](CPU &cpu, uint16_t address) { cpu.JSR(address); }, AddressMode::Absolute, 6 };
+    table[0x60] = { [](CPU &cpu, uint16_t) { cpu.RTS(); }, AddressMode::Implied, 6 };
+    table[0x00] = { [](CPU &cpu, uint16_t) { cpu.BRK(); }, AddressMode::Implied, 7 };
+    table[0x40] = { [](CPU &cpu, uint16_t) { cpu.RTI(); }, AddressMode::Implied, 6 };
 
     // stack
-    instructionSet[0x48] = { [this](uint16_t) { PHA(); }, AddressMode::Implied };
-    instructionSet[0x68] = { [this](uint16_t) { PLA(); }, AddressMode::Implied };
-    instructionSet[0x08] = { [this](uint16_t) { PHP(); }, AddressMode::Implied };
-    instructionSet[0x28] = { [this](uint16_t) { PLP(); }, AddressMode::Implied };
-    instructionSet[0x9A] = { [this](uint16_t) { TXS(); }, AddressMode::Implied };
-    instructionSet[0xBA] = { [this](uint16_t) { TSX(); }, AddressMode::Implied };
+    table[0x48] = { [](CPU &cpu, uint16_t) { cpu.PHA(); }, AddressMode::Implied, 3 };
+    table[0x68] = { [](CPU &cpu, uint16_t) { cpu.PLA(); }, AddressMode::Implied, 4 };
+    table[0x08] = { [](CPU &cpu, uint16_t) { cpu.PHP(); }, AddressMode::Implied, 3 };
+    table[0x28] = { [](CPU &cpu, uint16_t) { cpu.PLP(); }, AddressMode::Implied, 4 };
+    table[0x9A] = { [](CPU &cpu, uint16_t) { cpu.TXS(); }, AddressMode::Implied, 2 };
+    table[0xBA] = { [](CPU &cpu, uint16_t) { cpu.TSX(); }, AddressMode::Implied, 2 };
 
     // flag
-    instructionSet[0x18] = { [this](uint16_t) { CLC(); }, AddressMode::Implied };
-    instructionSet[0x38] = { [this](uint16_t) { SEC(); }, AddressMode::Implied };
-    instructionSet[0x58] = { [this](uint16_t) { CLI(); }, AddressMode::Implied };
-    instructionSet[0x78] = { [this](uint16_t) { SEI(); }, AddressMode::Implied };
-    instructionSet[0xD8] = { [this](uint16_t) { CLD(); }, AddressMode::Implied };
-    instructionSet[0xF8] = { [this](uint16_t) { SED(); }, AddressMode::Implied };
-    instructionSet[0xB8] = { [this](uint16_t) { CLV(); }, AddressMode::Implied };
+    table[0x18] = { [](CPU &cpu, uint16_t) { cpu.CLC(); }, AddressMode::Implied, 2 };
+    table[0x38] = { [](CPU &cpu, uint16_t) { cpu.SEC(); }, AddressMode::Implied, 2 };
+    table[0x58] = { [](CPU &cpu, uint16_t) { cpu.CLI(); }, AddressMode::Implied, 2 };
+    table[0x78] = { [](CPU &cpu, uint16_t) { cpu.SEI(); }, AddressMode::Implied, 2 };
+    table[0xD8] = { [](CPU &cpu, uint16_t) { cpu.CLD(); }, AddressMode::Implied, 2 };
+    table[0xF8] = { [](CPU &cpu, uint16_t) { cpu.SED(); }, AddressMode::Implied, 2 };
+    table[0xB8] = { [](CPU &cpu, uint16_t) { cpu.CLV(); }, AddressMode::Implied, 2 };
 
     // other
-    instructionSet[0xEA] = { [this](uint16_t) { NOP(); }, AddressMode::Implied };
+    table[0xEA] = { [](CPU &cpu, uint16_t) { cpu.NOP(); }, AddressMode::Implied, 2 };
+
+    return table;
 }
 
 // Access
@@ -351,9 +591,9 @@ void CPU::TYA()
 void CPU::ADC(uint16_t address)
 {
     uint8_t memory = read(address);
-    uint8_t result = a + memory + (CHECK_FLAG(stat, FLAG_CARRY) ? 1 : 0);
-    SET_FLAG(stat, FLAG_CARRY, result > 0xFF);
-    SET_FLAG(stat, FLAG_OVERFLOW, (~(a ^ memory) & (a ^ result) & 0x80));
+    uint16_t result = a + memory + carry;
+    carry = result > 0xFF;
+    overflowResult = ~(a ^ memory) & (a ^ result);
     a = result & 0xFF;
     setZNFlag(a);
 }
@@ -361,9 +601,9 @@ void CPU::ADC(uint16_t address)
 void CPU::SBC(uint16_t address)
 {
     uint8_t memory = read(address);
-    uint16_t result = a - memory - (CHECK_FLAG(stat, FLAG_CARRY) ? 0 : 1);
-    SET_FLAG(stat, FLAG_CARRY, result < 0x100);
-    SET_FLAG(stat, FLAG_OVERFLOW, ((a ^ result) & (a ^ memory) & 0x80));
+    uint16_t result = a - memory - (carry ^ 1);
+    carry = result < 0x100;
+    overflowResult = (a ^ result) & (a ^ memory);
     a = result & 0xFF;
     setZNFlag(a);
 }
@@ -402,77 +642,69 @@ void CPU::DEY()
     setZNFlag(--y);
 }
 
-// Shift
+// Shift (인자 없는 쪽은 Accumulator 모드)
+void CPU::ASL()
+{
+    carry = a >> 7;
+    a <<= 1;
+    setZNFlag(a);
+}
+
 void CPU::ASL(uint16_t address)
 {
-    if (address == -1)
-    {
-        SET_FLAG(stat, FLAG_CARRY, a & 0x80);
-        a <<= 1;
-        setZNFlag(a);
-    }
-    else
-    {
-        uint8_t value = read(address);
-        SET_FLAG(stat, FLAG_CARRY, value & 0x80);
-        write(address, value <<= 1);
-        setZNFlag(value);
-    }
+    uint8_t value = read(address);
+    carry = value >> 7;
+    write(address, value <<= 1);
+    setZNFlag(value);
+}
+
+void CPU::LSR()
+{
+    carry = a & 0x01;
+    a >>= 1;
+    setZNFlag(a);
 }
 
 void CPU::LSR(uint16_t address)
 {
-    if (address == -1)
-    {
-        SET_FLAG(stat, FLAG_CARRY, a & 0x01);
-        a >>= 1;
-        setZNFlag(a);
-    }
-    else
-    {
-        uint8_t value = read(address);
-        SET_FLAG(stat, FLAG_CARRY, value & 0x01);
-        write(address, value >>= 1);
-        setZNFlag(value);
-    }
+    uint8_t value = read(address);
+    carry = value & 0x01;
+    write(address, value >>= 1);
+    setZNFlag(value);
+}
+
+void CPU::ROL()
+{
+    uint8_t carryIn = carry;
+    carry = a >> 7;
+    a = (a << 1) | carryIn;
+    setZNFlag(a);
 }
 
 void CPU::ROL(uint16_t address)
 {
-    if (address == -1)
-    {
-        uint8_t carry = CHECK_FLAG(stat, FLAG_CARRY) ? 1 : 0;
-        SET_FLAG(stat, FLAG_CARRY, a & 0x80);
-        a = (a << 1) | carry;
-        setZNFlag(a);
-    }
-    else
-    {
-        uint8_t value = read(address);
-        uint8_t carry = CHECK_FLAG(stat, FLAG_CARRY) ? 1 : 0;
-        SET_FLAG(stat, FLAG_CARRY, value & 0x80);
-        write(address, value = (value << 1) | carry);
-        setZNFlag(value);
-    }
+    uint8_t value = read(address);
+    uint8_t carryIn = carry;
+    carry = value >> 7;
+    write(address, value = (value << 1) | carryIn);
+    setZNFlag(value);
+}
+
+void CPU::ROR()
+{
+    uint8_t carryIn = carry << 7;
+    carry = a & 0x01;
+    a = (a >> 1) | carryIn;
+    setZNFlag(a);
 }
 
 void CPU::ROR(uint16_t address)
 {
-    if (address == -1)
-    {
-        uint8_t carry = CHECK_FLAG(stat, FLAG_CARRY) ? 0x80 : 0;
-        SET_FLAG(stat, FLAG_CARRY, a & 0x01);
-        a = (a >> 1) | carry;
-        setZNFlag(a);
-    }
-    else
-    {
-        uint8_t value = read(address);
-        uint8_t carry = CHECK_FLAG(stat, FLAG_CARRY) ? 0x80 : 0;
-        SET_FLAG(stat, FLAG_CARRY, value & 0x01);
-        write(address, value = (value >> 1) | carry);
-        setZNFlag(value);
-    }
+    uint8_t value = read(address);
+    uint8_t carryIn = carry << 7;
+    carry = value & 0x01;
+    write(address, value = (value >> 1) | carryIn);
+    setZNFlag(value);
 }
 
 void CPU::AND(uint16_t address)
@@ -496,79 +728,80 @@ void CPU::EOR(uint16_t address)
 void CPU::BIT(uint16_t address)
 {
     int8_t value = read(address);
-    SET_FLAG(stat, FLAG_ZERO, (a & value) == 0);
-    SET_FLAG(stat, FLAG_NEGATIVE, value & 0x80);
-    SET_FLAG(stat, FLAG_OVERFLOW, value & 0x40);
+    zeroResult = a & value;
+    negativeResult = value;
+    overflowResult = value << (7 - FLAG_OVERFLOW);
 }
 
 // Compare
 void CPU::CMP(uint16_t address)
 {
     uint8_t value = read(address);
-    SET_FLAG(stat, FLAG_CARRY, a >= value);
+    carry = a >= value;
     setZNFlag(a - value);
 }
 
 void CPU::CPX(uint16_t address)
 {
     uint8_t value = read(address);
-    SET_FLAG(stat, FLAG_CARRY, x >= value);
+    carry = x >= value;
     setZNFlag(x - value);
 }
 
 void CPU::CPY(uint16_t address)
 {
     uint8_t value = read(address);
-    SET_FLAG(stat, FLAG_CARRY, y >= value);
+    carry = y >= value;
     setZNFlag(y - value);
 }
 
 // Branch
+// 분기하면 +1 사이클, 분기 대상이 다른 페이지면 +1 사이클
+void CPU::branch(bool condition, uint16_t address)
+{
+    if (!condition)
+        return;
+    cycles += ((pc ^ address) & 0xFF00) ? 2 : 1;
+    pc = address;
+}
+
 void CPU::BCC(uint16_t address)
 {
-    if (!CHECK_FLAG(stat, FLAG_CARRY))
-        pc = address;
+    branch(!carry, address);
 }
 
 void CPU::BCS(uint16_t address)
 {
-    if (CHECK_FLAG(stat, FLAG_CARRY))
-        pc = address;
+    branch(carry, address);
 }
 
 void CPU::BEQ(uint16_t address)
 {
-    if (CHECK_FLAG(stat, FLAG_ZERO))
-        pc = address;
+    branch(zeroResult == 0, address);
 }
 
 void CPU::BNE(uint16_t address)
 {
-    if (!CHECK_FLAG(stat, FLAG_ZERO))
-        pc = address;
+    branch(zeroResult != 0, address);
 }
 
 void CPU::BPL(uint16_t address)
 {
-    if (!CHECK_FLAG(stat, FLAG_NEGATIVE))
-        pc = address;
+    branch(!(negativeResult & 0x80), address);
 }
 void CPU::BMI(uint16_t address)
 {
-    if (CHECK_FLAG(stat, FLAG_NEGATIVE))
-        pc = address;
+    branch(negativeResult & 0x80, address);
 }
 
 void CPU::BVC(uint16_t address)
 {
-    if (!CHECK_FLAG(stat, FLAG_OVERFLOW))
-        pc = address;
+    branch(!(overflowResult & 0x80), address);
 }
 
 void CPU::BVS(uint16_t address)
 {
-    if (CHECK_FLAG(stat, FLAG_OVERFLOW))
-        pc = address;
+    branch(overflowResult & 0x80, address);
 }
 
 void CPU::JMP(uint16_t address)
@@ -585,22 +818,26 @@ void CPU::JSR(uint16_t address)
 
 void CPU::RTS()
 {
-    pc = (read(++sp + 0x100) | (read(++sp + 0x100) << 8)) + 1;
+    uint8_t low = read(++sp + 0x100);
+    uint8_t high = read(++sp + 0x100);
+    pc = (low | (high << 8)) + 1;
 }
 
 void CPU::BRK()
 {
     write(0x100 + sp--, (pc + 1) >> 8);
     write(0x100 + sp--, (pc + 1) & 0xFF);
-    write(0x100 + sp--, stat | (1 << 4) | (1 << 5));
+    write(0x100 + sp--, getStat() | (1 << 4) | (1 << 5));
     pc = read(0xFFFE) | (read(0xFFFF) << 8);
-    SET_FLAG(stat, FLAG_INTERRUPT, true);
+    SET_FLAG(statBits, FLAG_INTERRUPT, true);
 }
 
 void CPU::RTI()
 {
-    stat = read(0x0100 + ++sp);
-    pc = read(0x0100 + ++sp) | (read(0x0100 + ++sp) << 8);
+    setStat(read(0x0100 + ++sp));
+    uint8_t low = read(0x0100 + ++sp);
+    uint8_t high = read(0x0100 + ++sp);
+    pc = low | (high << 8);
 }
 
 // Stack
@@ -617,12 +854,12 @@ void CPU::PLA()
 
 void CPU::PHP()
 {
-    write(0x100 + sp--, stat | (1 << 4) | (1 << 5));
+    write(0x100 + sp--, getStat() | (1 << 4) | (1 << 5));
 }
 
 void CPU::PLP()
 {
-    stat = read(++sp + 0x100);
+    setStat(read(++sp + 0x100));
 }
 
 void CPU::TXS()
@@ -639,49 +876,86 @@ void CPU::TSX()
 // Flag
 void CPU::CLC()
 {
-    SET_FLAG(stat, FLAG_CARRY, false);
+    carry = 0;
 }
 
 void CPU::SEC()
 {
-    SET_FLAG(stat, FLAG_CARRY, true);
+    carry = 1;
 }
 
 void CPU::CLI()
 {
-    SET_FLAG(stat, FLAG_INTERRUPT, false);
+    SET_FLAG(statBits, FLAG_INTERRUPT, false);
 }
 
 void CPU::SEI()
 {
-    SET_FLAG(stat, FLAG_INTERRUPT, true);
+    SET_FLAG(statBits, FLAG_INTERRUPT, true);
 }
 
 void CPU::CLD()
 {
-    SET_FLAG(stat, FLAG_DECIMAL, false);
+    SET_FLAG(statBits, FLAG_DECIMAL, false);
 }
 
 void CPU::SED()
 {
-    SET_FLAG(stat, FLAG_DECIMAL, true);
+    SET_FLAG(statBits, FLAG_DECIMAL, true);
 }
 
 void CPU::CLV()
 {
-    SET_FLAG(stat, FLAG_OVERFLOW, false);
+    overflowResult = 0;
 }
 
 // Other
 void CPU::NOP() {}
 
+// Interrupt
+void CPU::reset()
+{
+    sp -= 3;
+    SET_FLAG(stat, FLAG_INTERRUPT, true);
+    loadStat();
+    pc = read16(0xFFFC);
+    cycles += 7;
+}
+
+void CPU::nmi()
+{
+    loadStat();
+    interrupt(0xFFFA);
+    storeStat();
+}
+
+void CPU::irq()
+{
+    if (CHECK_FLAG(stat, FLAG_INTERRUPT)) // 명령어 밖에서 부르므로 stat 이 최신
+        return;
+    loadStat();
+    interrupt(0xFFFE);
+    storeStat();
+}
+
+// BRK 와 같지만 B 플래그를 쓰지 않음
+void CPU::interrupt(uint16_t vector)
+{
+    write(0x100 + sp--, pc >> 8);
+    write(0x100 + sp--, pc & 0xFF);
+    write(0x100 + sp--, (getStat() & ~(1 << FLAG_BRK)) | (1 << FLAG_UNUSED));
+    SET_FLAG(statBits, FLAG_INTERRUPT, true);
+    pc = read16(vector);
+    cycles += 7;
+}
+
 // Debug
 void CPU::debugStack()
 {
     std::cout << "SP: 0x" << std::hex << +sp << std::endl;
     for (uint16_t i = sp + 1; i <= 0xFF; ++i)
     {
-        std::cout << "Stack[0x" << std::hex << (0x100 + i) << "] = 0x" << +memory[0x100 + i] << "\n";
+        std::cout << "Stack[0x" << std::hex << (0x100 + i) << "] = 0x" << +read(0x100 + i) << "\n";
     }
     std::cout << "-----------------------------" << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "Cartridge.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t headerSize = 16;
+static const size_t trainerSize = 512;
+
+Cartridge::~Cartridge()
+{
+    close();
+}
+
+// 읽기 전용 mmap (페이지는 처음 읽을 때 들어오므로 여는 비용은 파일 크기와 무관)
+bool Cartridge::open(const std::string &path, std::string &error)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = "failed to open ROM file '" + path + "'";
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(headerSize))
+    {
+        ::close(fd);
+        error = "ROM file is too small";
+        return false;
+    }
+
+    void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // 매핑은 fd 를 닫아도 유지
+    if (data == MAP_FAILED)
+    {
+        error = "failed to map ROM file '" + path + "'";
+        return false;
+    }
+    mapping = data;
+    mappingSize = info.st_size;
+
+    if (!parse(static_cast<const uint8_t *>(data), mappingSize, error))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void Cartridge::close()
+{
+    if (mapping)
+        munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+    prg = chr = nullptr;
+    prgSize = chrSize = 0;
+}
+
+// NES 2.0 크기: 상위 nibble 이 F 면 하위 바이트가 지수 형식 (2^E * (MM * 2 + 1))
+static size_t romSize(uint8_t low, uint8_t high, size_t unit)
+{
+    if (high == 0x0F)
+        return (size_t(1) << (low >> 2)) * ((low & 0x03) * 2 + 1);
+    return ((size_t(high) << 8) | low) * unit;
+}
+
+static size_t ramSize(uint8_t shift)
+{
+    return shift ? size_t(64) << shift : 0;
+}
+
+bool Cartridge::parse(const uint8_t *data, size_t size, std::string &error)
+{
+    if (size < headerSize || std::memcmp(data, "NES\x1A", 4) != 0)
+    {
+        error = "not an iNES file";
+        return false;
+    }
+
+    uint8_t flags6 = data[6];
+    uint8_t flags7 = data[7];
+    nes20 = (flags7 & 0x0C) == 0x08;
+
+    mirroring = (flags6 & 0x01) ? Mirroring::Vertical : Mirroring::Horizontal;
+    battery = flags6 & 0x02;
+    fourScreen = flags6 & 0x08;
+
+    if (nes20)
+    {
+        mapper = (flags6 >> 4) | (flags7 & 0xF0) | ((data[8] & 0x0F) << 8);
+        submapper = data[8] >> 4;
+        prgSize = romSize(data[4], data[9] & 0x0F, 0x4000);
+        chrSize = romSize(data[5], data[9] >> 4, 0x2000);
+        prgRAMSize = ramSize(data[10] & 0x0F) + ramSize(data[10] >> 4);
+        chrRAMSize = ramSize(data[11] & 0x0F) + ramSize(data[11] >> 4);
+    }
+    else
+    {
+        // 12-15 에 문자열이 들어 있는 오래된 덤프 ("DiskDude!") 는 7번 바이트도 믿을 수 없음
+        bool dirty = data[12] || data[13] || data[14] || data[15];
+        mapper = (flags6 >> 4) | (dirty ? 0 : (flags7 & 0xF0));
+        submapper = 0;
+        prgSize = data[4] * size_t(0x4000);
+        chrSize = data[5] * size_t(0x2000);
+        prgRAMSize = (data[8] ? data[8] : 1) * size_t(0x2000);
+        chrRAMSize = chrSize ? 0 : 0x2000;
+    }
+
+    // 뱅크 전환 단위 (PRG 8KB, CHR 1KB) 의 배수만 지원
+    if (prgSize % 0x2000 != 0 || chrSize % 0x400 != 0)
+    {
+        error = "unsupported PRG/CHR size";
+        return false;
+    }
+
+    size_t offset = headerSize + ((flags6 & 0x04) ? trainerSize : 0);
+    if (prgSize == 0 || offset + prgSize + chrSize > size)
+    {
+        error = "ROM file is truncated or has an invalid header";
+        return false;
+    }
+
+    prg = data + offset;
+    chr = chrSize ? prg + prgSize : nullptr;
+    return true;
+}
@@ -0,0 +1,80 @@
+#include "FrameBuffer.h"
+#include "PixelKernels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+/*
+ * back 프레임을 직전(front) 프레임과 비교해 dirty 를 채운 뒤 교체
+ * - 첫 프레임은 비교할 대상이 없으므로 모두 dirty
+ */
+void FrameBuffer::present()
+{
+    Frame &next = backFrame();
+    if (sequence() == 0)
+        std::fill(std::begin(next.dirty), std::end(next.dirty), 0xFFFFFFFFu);
+    else
+        diff(front(), view(sequence() + 1), next.dirty);
+
+    sequenceNumber.fetch_add(1, std::memory_order_release);
+}
+
+// 타일 행마다 8개 scanline 의 블록 마스크를 합침 (emphasis 가 바뀐 scanline 은 한 줄 전체)
+void FrameBuffer::diff(const View &previous, const View &current, uint32_t *dirty)
+{
+    const PixelKernels &kernels = pixelKernels();
+    for (int row = 0; row < tileRows; ++row)
+    {
+        uint32_t mask = 0;
+        for (int y = row * 8; y < row * 8 + 8; ++y)
+        {
+            if (previous.emphasis[y] != current.emphasis[y])
+                mask = 0xFFFFFFFFu;
+            else
+                mask |= kernels.diffBlocks(previous.pixels + y * pitch, current.pixels + y * pitch, tileColumns);
+        }
+        dirty[row] = mask;
+    }
+}
+
+int FrameBuffer::dirtyTiles(const View &frame)
+{
+    int count = 0;
+    for (int row = 0; row < tileRows; ++row)
+        count += __builtin_popcount(frame.dirty[row]);
+    return count;
+}
+
+void FrameBuffer::toRGBA(const View &frame, uint32_t *out, size_t outPitch, const RGBAPalette &palette)
+{
+    const PixelKernels &kernels = pixelKernels();
+    for (int y = 0; y < height; ++y)
+        kernels.indicesToRGBA(frame.pixels + y * pitch, palette.colors[frame.emphasis[y] & 0x07], out + y * outPitch,
+                              width);
+}
+
+// 8바이트씩 4개 lane 에 번갈아 섞어 곱셈 지연을 겹침 (size 는 8의 배수)
+uint64_t FrameBuffer::hash(const View &frame)
+{
+    const uint64_t prime = 0x9E3779B97F4A7C15ull;
+    uint64_t lanes[4] = {0xcbf29ce484222325ull, 1, 2, 3};
+    auto mix = [&](const uint8_t *data, size_t size) {
+        for (size_t i = 0; i < size; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            uint64_t &lane = lanes[(i >> 3) & 3];
+            lane = (lane ^ word) * prime;
+            lane ^= lane >> 29;
+        }
+    };
+    for (int y = 0; y < height; ++y)
+        mix(frame.pixels + y * pitch, width);
+    mix(frame.emphasis, height);
+
+    uint64_t value = 0;
+    for (uint64_t lane : lanes)
+        value = (value ^ lane) * prime;
+    return value ^ (value >> 32);
+}
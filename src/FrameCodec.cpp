@@ -0,0 +1,463 @@
+#include "FrameCodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const int height = FrameBuffer::height;
+static const int tileColumns = FrameBuffer::tileColumns;
+static const int tiles = FrameBuffer::tileColumns * FrameBuffer::tileRows;
+static const uint8_t keyframeFlag = 0x01;
+
+static const int probabilityBits = 11;
+static const int adaptShift = 5;
+static const uint16_t probabilityHalf = 1 << (probabilityBits - 1);
+
+static const int maxPaletteColors = 16; // 타일 팔레트로 부호화하는 최대 색 수
+static const int denseKind = 16;        // 타일 종류: 색 수 - 1, 16 은 그보다 많음
+static const int noKind = 17;           // 프레임의 첫 타일 (이전 타일 없음)
+
+/*
+ * 확률 모델 (0 이 나올 확률, 11비트)
+ * - 비트 트리: 값의 상위 비트부터 부호화하며 지금까지의 비트로 노드를 고름 (bits 비트 값에 1 << bits 개)
+ */
+struct CodecModels
+{
+    uint16_t runs[2][4][256];      // [바뀐 구간?][varint 몇 번째 바이트] 바이트
+    uint16_t kind[noKind + 1][32]; // [이전 타일 종류] 종류
+    uint16_t color[64];            // 타일 팔레트 색
+    uint16_t pixel[64][64];        // [왼쪽 색] 색 (16색 초과 타일)
+    uint16_t emphasisChanged;
+    uint16_t emphasis[8][8];      // [윗 행 emphasis] emphasis
+    uint16_t sameAsLeft[5][4];    // [번호 비트 수][왼쪽 == 위쪽, 앞 픽셀도 같았는지] 왼쪽과 같은 번호인지
+    // [번호 비트 수][왼쪽 번호 * 16 + 위쪽 번호] 타일 팔레트 번호
+    uint16_t index[5][maxPaletteColors * maxPaletteColors][maxPaletteColors];
+
+    void reset()
+    {
+        uint16_t *first = &runs[0][0][0];
+        std::fill(first, first + sizeof(CodecModels) / sizeof(uint16_t), probabilityHalf);
+    }
+};
+
+// 직전 프레임 (다음 프레임의 기준) + 확률 모델
+struct CodecState
+{
+    CodecModels models;
+    uint8_t pixels[FrameBuffer::pitch * height];
+    uint8_t emphasis[height];
+    uint32_t dirty[FrameBuffer::tileRows];
+
+    void reset()
+    {
+        models.reset();
+        std::memset(pixels, 0, sizeof(pixels));
+        std::memset(emphasis, 0, sizeof(emphasis));
+    }
+
+    FrameBuffer::View view(uint64_t sequence) const { return {pixels, emphasis, dirty, sequence}; }
+};
+
+namespace
+{
+class RangeEncoder
+{
+public:
+    explicit RangeEncoder(std::vector<uint8_t> &out) : out(out) {}
+
+    void bit(uint16_t &probability, int value)
+    {
+        uint32_t bound = (range >> probabilityBits) * probability;
+        if (!value)
+        {
+            range = bound;
+            probability += ((1 << probabilityBits) - probability) >> adaptShift;
+        }
+        else
+        {
+            low += bound;
+            range -= bound;
+            probability -= probability >> adaptShift;
+        }
+        while (range < (1u << 24))
+        {
+            range <<= 8;
+            shiftLow();
+        }
+    }
+
+    void tree(uint16_t *probabilities, int bits, int value)
+    {
+        int node = 1;
+        for (int i = bits - 1; i >= 0; --i)
+        {
+            int b = (value >> i) & 1;
+            bit(probabilities[node], b);
+            node = (node << 1) | b;
+        }
+    }
+
+    void flush()
+    {
+        for (int i = 0; i < 5; ++i)
+            shiftLow();
+    }
+
+private:
+    std::vector<uint8_t> &out;
+    uint64_t low = 0;
+    uint32_t range = 0xFFFFFFFFu;
+    uint8_t cache = 0;
+    uint64_t cacheSize = 1;
+
+    // 자리 올림이 정해질 때까지 0xFF 바이트를 cacheSize 로 미뤄 둠
+    void shiftLow()
+    {
+        if (static_cast<uint32_t>(low) < 0xFF000000u || (low >> 32) != 0)
+        {
+            uint8_t carry = static_cast<uint8_t>(low >> 32);
+            uint8_t pending = cache;
+            do
+            {
+                out.push_back(static_cast<uint8_t>(pending + carry));
+                pending = 0xFF;
+            } while (--cacheSize != 0);
+            cache = static_cast<uint8_t>(low >> 24);
+        }
+        ++cacheSize;
+        low = (low & 0x00FFFFFFu) << 8;
+    }
+};
+
+class RangeDecoder
+{
+public:
+    RangeDecoder(const uint8_t *data, const uint8_t *end) : data(data), end(end)
+    {
+        for (int i = 0; i < 5; ++i)
+            code = (code << 8) | next();
+    }
+
+    int bit(uint16_t &probability)
+    {
+        uint32_t bound = (range >> probabilityBits) * probability;
+        int value;
+        if (code < bound)
+        {
+            range = bound;
+            probability += ((1 << probabilityBits) - probability) >> adaptShift;
+            value = 0;
+        }
+        else
+        {
+            code -= bound;
+            range -= bound;
+            probability -= probability >> adaptShift;
+            value = 1;
+        }
+        while (range < (1u << 24))
+        {
+            range <<= 8;
+            code = (code << 8) | next();
+        }
+        return value;
+    }
+
+    int tree(uint16_t *probabilities, int bits)
+    {
+        int node = 1;
+        for (int i = 0; i < bits; ++i)
+            node = (node << 1) | bit(probabilities[node]);
+        return node - (1 << bits);
+    }
+
+    bool overrun = false;
+
+private:
+    const uint8_t *data;
+    const uint8_t *end;
+    uint32_t range = 0xFFFFFFFFu;
+    uint32_t code = 0;
+
+    uint8_t next()
+    {
+        if (data < end)
+            return *data++;
+        overrun = true;
+        return 0;
+    }
+};
+} // namespace
+
+static void writeVarint(std::vector<uint8_t> &out, size_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// 최대 4바이트 (size 를 넘거나 더 길면 false)
+static bool readVarint(const uint8_t *data, size_t size, size_t &value, size_t &length)
+{
+    value = 0;
+    for (length = 0; length < size && length < 4; ++length)
+    {
+        value |= static_cast<size_t>(data[length] & 0x7F) << (7 * length);
+        if (!(data[length] & 0x80))
+        {
+            ++length;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void encodeRun(RangeEncoder &coder, CodecModels &models, int changed, int run)
+{
+    for (int i = 0;; ++i)
+    {
+        int byte = run & 0x7F;
+        run >>= 7;
+        coder.tree(models.runs[changed][i], 8, byte | (run ? 0x80 : 0));
+        if (!run)
+            return;
+    }
+}
+
+static int decodeRun(RangeDecoder &coder, CodecModels &models, int changed)
+{
+    int run = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        int byte = coder.tree(models.runs[changed][i], 8);
+        run |= (byte & 0x7F) << (7 * i);
+        if (!(byte & 0x80))
+            break;
+    }
+    return run;
+}
+
+static int tileKind(int colors)
+{
+    return colors <= maxPaletteColors ? colors - 1 : denseKind;
+}
+
+// 팔레트 번호 비트 수 (색 1개면 0)
+static int indexBits(int kind)
+{
+    return kind == 0 ? 0 : 32 - __builtin_clz(kind);
+}
+
+// 타일 안의 왼쪽 이웃 (첫 열은 위쪽, 첫 행의 위쪽은 왼쪽으로 대신함)
+static inline int leftOf(const uint8_t values[64], int i)
+{
+    return i == 0 ? 0 : (i & 7) ? values[i - 1] : values[i - 8];
+}
+
+static void encodeTile(RangeEncoder &coder, CodecModels &models, const uint8_t *tile, int &previousKind)
+{
+    uint8_t pixels[64];
+    uint64_t used = 0;
+    for (int y = 0; y < 8; ++y)
+    {
+        std::memcpy(pixels + y * 8, tile + y * FrameBuffer::pitch, 8);
+        for (int x = 0; x < 8; ++x)
+            used |= uint64_t(1) << pixels[y * 8 + x];
+    }
+
+    int kind = tileKind(__builtin_popcountll(used));
+    coder.tree(models.kind[previousKind], 5, kind);
+    previousKind = kind;
+
+    if (kind == denseKind)
+    {
+        for (int i = 0; i < 64; ++i)
+            coder.tree(models.pixel[leftOf(pixels, i)], 6, pixels[i]);
+        return;
+    }
+
+    // 타일 팔레트 (작은 색부터)
+    uint8_t numbers[64];
+    for (int number = 0; used; ++number, used &= used - 1)
+    {
+        int color = __builtin_ctzll(used);
+        numbers[color] = static_cast<uint8_t>(number);
+        coder.tree(models.color, 6, color);
+    }
+
+    int bits = indexBits(kind);
+    if (bits == 0)
+        return;
+    uint8_t indices[64];
+    int previousSame = 1;
+    for (int i = 0; i < 64; ++i)
+    {
+        indices[i] = numbers[pixels[i]];
+        int left = leftOf(indices, i), above = i >= 8 ? indices[i - 8] : left;
+        int same = indices[i] == left;
+        coder.bit(models.sameAsLeft[bits][(left == above) * 2 + previousSame], same);
+        previousSame = same;
+        if (!same)
+            coder.tree(models.index[bits][left * maxPaletteColors + above], bits, indices[i]);
+    }
+}
+
+static void decodeTile(RangeDecoder &coder, CodecModels &models, uint8_t *tile, int &previousKind)
+{
+    uint8_t pixels[64];
+    int kind = std::min(coder.tree(models.kind[previousKind], 5), denseKind);
+    previousKind = kind;
+
+    if (kind == denseKind)
+    {
+        for (int i = 0; i < 64; ++i)
+            pixels[i] = static_cast<uint8_t>(coder.tree(models.pixel[leftOf(pixels, i)], 6));
+    }
+    else
+    {
+        uint8_t palette[maxPaletteColors];
+        for (int number = 0; number <= kind; ++number)
+            palette[number] = static_cast<uint8_t>(coder.tree(models.color, 6));
+
+        int bits = indexBits(kind);
+        uint8_t indices[64] = {};
+        int previousSame = 1;
+        for (int i = 0; i < 64 && bits > 0; ++i)
+        {
+            int left = leftOf(indices, i), above = i >= 8 ? indices[i - 8] : left;
+            int index = left;
+            previousSame = coder.bit(models.sameAsLeft[bits][(left == above) * 2 + previousSame]);
+            if (!previousSame)
+                index = coder.tree(models.index[bits][left * maxPaletteColors + above], bits);
+            indices[i] = static_cast<uint8_t>(std::min(index, kind));
+        }
+        for (int i = 0; i < 64; ++i)
+            pixels[i] = palette[indices[i]];
+    }
+
+    for (int y = 0; y < 8; ++y)
+        std::memcpy(tile + y * FrameBuffer::pitch, pixels + y * 8, 8);
+}
+
+static size_t tileOffset(int tile)
+{
+    return (tile / tileColumns) * 8 * FrameBuffer::pitch + (tile % tileColumns) * 8;
+}
+
+static bool isDirty(const uint32_t *dirty, int tile)
+{
+    return (dirty[tile / tileColumns] >> (tile % tileColumns)) & 1;
+}
+
+FrameEncoder::FrameEncoder(uint32_t keyframeInterval)
+    : state(new CodecState()), keyframeInterval(std::max<uint32_t>(keyframeInterval, 1))
+{
+    state->reset();
+}
+
+FrameEncoder::~FrameEncoder() = default;
+
+void FrameEncoder::encode(const FrameBuffer::View &frame, std::vector<uint8_t> &out)
+{
+    bool keyframe = count % keyframeInterval == 0;
+    if (keyframe)
+        state->reset();
+    CodecModels &models = state->models;
+    FrameBuffer::diff(state->view(count), frame, state->dirty);
+
+    packet.clear();
+    packet.push_back(keyframe ? keyframeFlag : 0);
+    RangeEncoder coder(packet);
+
+    bool emphasisChanged = !std::equal(frame.emphasis, frame.emphasis + height, state->emphasis);
+    coder.bit(models.emphasisChanged, emphasisChanged);
+    if (emphasisChanged)
+    {
+        for (int y = 0; y < height; ++y)
+            coder.tree(models.emphasis[y ? frame.emphasis[y - 1] & 0x07 : 0], 3, frame.emphasis[y] & 0x07);
+    }
+
+    int previousKind = noKind;
+    for (int tile = 0; tile < tiles;)
+    {
+        int start = tile;
+        while (tile < tiles && !isDirty(state->dirty, tile))
+            ++tile;
+        encodeRun(coder, models, 0, tile - start);
+        if (tile == tiles)
+            break;
+
+        start = tile;
+        while (tile < tiles && isDirty(state->dirty, tile))
+            ++tile;
+        encodeRun(coder, models, 1, tile - start);
+        for (int i = start; i < tile; ++i)
+            encodeTile(coder, models, frame.pixels + tileOffset(i), previousKind);
+    }
+    coder.flush();
+
+    writeVarint(out, packet.size());
+    out.insert(out.end(), packet.begin(), packet.end());
+
+    std::memcpy(state->pixels, frame.pixels, sizeof(state->pixels));
+    std::memcpy(state->emphasis, frame.emphasis, height);
+    ++count;
+}
+
+FrameDecoder::FrameDecoder() : state(new CodecState())
+{
+    state->reset();
+    std::memset(state->dirty, 0, sizeof(state->dirty));
+}
+
+FrameDecoder::~FrameDecoder() = default;
+
+FrameBuffer::View FrameDecoder::frame() const
+{
+    return state->view(count);
+}
+
+size_t FrameDecoder::decode(const uint8_t *data, size_t size)
+{
+    size_t packetSize, prefix;
+    if (!readVarint(data, size, packetSize, prefix) || packetSize == 0 || packetSize > size - prefix)
+        return 0;
+    const uint8_t *packet = data + prefix;
+    if (packet[0] & keyframeFlag)
+        state->reset();
+    CodecModels &models = state->models;
+    RangeDecoder coder(packet + 1, packet + packetSize);
+
+    if (coder.bit(models.emphasisChanged))
+    {
+        for (int y = 0; y < height; ++y)
+            state->emphasis[y] =
+                static_cast<uint8_t>(coder.tree(models.emphasis[y ? state->emphasis[y - 1] & 0x07 : 0], 3));
+    }
+
+    // 바뀐 타일만 직전 프레임 위에 덮어씀
+    std::memset(state->dirty, 0, sizeof(state->dirty));
+    int previousKind = noKind;
+    for (int tile = 0; tile < tiles;)
+    {
+        tile += decodeRun(coder, models, 0);
+        if (tile > tiles)
+            return 0;
+        if (tile == tiles)
+            break;
+        int run = decodeRun(coder, models, 1);
+        if (run == 0 || tile + run > tiles)
+            return 0;
+        for (int end = tile + run; tile < end; ++tile)
+        {
+            state->dirty[tile / tileColumns] |= 1u << (tile % tileColumns);
+            decodeTile(coder, models, state->pixels + tileOffset(tile), previousKind);
+        }
+    }
+    if (coder.overrun)
+        return 0;
+    ++count;
+    return prefix + packetSize;
+}
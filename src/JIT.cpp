@@ -0,0 +1,1054 @@
+#include "JIT.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__unix__)
+#define JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+bool JIT::supported()
+{
+#ifdef JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef JIT_X86_64
+
+namespace
+{
+
+// x86-64 레지스터 번호
+enum Reg
+{
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3,
+    RBP = 5,
+    RSI = 6,
+    RDI = 7,
+    R12 = 12,
+    R13 = 13,
+    R14 = 14,
+    R15 = 15,
+};
+
+// 6502 레지스터 할당 (callee-saved 레지스터라 helper 호출 후에도 유지)
+// 바이트 레지스터로는 al/cl/dl/bl 과 r8b 이상만 사용 (spl/bpl/sil/dil 은 REX 가 필요)
+const int REG_A = R12;
+const int REG_X = R13;
+const int REG_Y = R14;
+const int REG_SP = R15;
+const int REG_STAT = RBX; // bl
+const int REG_CPU = RBP;
+
+// 조건 코드 (jcc/setcc)
+enum Condition
+{
+    CC_AE = 0x3,
+    CC_Z = 0x4,
+    CC_NZ = 0x5,
+    CC_NS = 0x9,
+};
+
+// ALU 명령어 (r/m32, r32)
+enum Alu
+{
+    ALU_ADD = 0x01,
+    ALU_OR = 0x09,
+    ALU_AND = 0x21,
+    ALU_SUB = 0x29,
+    ALU_XOR = 0x31,
+    ALU_TEST = 0x85,
+};
+
+// ALU 명령어 (r/m32, imm32) 의 /ext
+enum AluExt
+{
+    EXT_ADD = 0,
+    EXT_OR = 1,
+    EXT_AND = 4,
+    EXT_XOR = 6,
+};
+
+const uint8_t FLAG_CARRY = 0x01;
+const uint8_t FLAG_ZERO = 0x02;
+const uint8_t FLAG_INTERRUPT = 0x04;
+const uint8_t FLAG_DECIMAL = 0x08;
+const uint8_t FLAG_OVERFLOW = 0x40;
+const uint8_t FLAG_NEGATIVE = 0x80;
+
+// CPU 필드 오프셋 (CPU 는 standard-layout 이 아니라 offsetof 대신 인스턴스로 계산)
+struct Offsets
+{
+    int32_t a, x, y, sp, statBits, carry, zeroResult, negativeResult, overflowResult;
+    int32_t pc, cycles, instructions, readPages, writePages;
+
+    explicit Offsets(CPU &cpu)
+    {
+        const char *base = reinterpret_cast<const char *>(&cpu);
+        a = reinterpret_cast<const char *>(&cpu.a) - base;
+        x = reinterpret_cast<const char *>(&cpu.x) - base;
+        y = reinterpret_cast<const char *>(&cpu.y) - base;
+        sp = reinterpret_cast<const char *>(&cpu.sp) - base;
+        statBits = reinterpret_cast<const char *>(&cpu.statBits) - base;
+        carry = reinterpret_cast<const char *>(&cpu.carry) - base;
+        zeroResult = reinterpret_cast<const char *>(&cpu.zeroResult) - base;
+        negativeResult = reinterpret_cast<const char *>(&cpu.negativeResult) - base;
+        overflowResult = reinterpret_cast<const char *>(&cpu.overflowResult) - base;
+        pc = reinterpret_cast<const char *>(&cpu.pc) - base;
+        cycles = reinterpret_cast<const char *>(&cpu.cycles) - base;
+        instructions = reinterpret_cast<const char *>(&cpu.instructions) - base;
+        readPages = reinterpret_cast<const char *>(cpu.bus.readPages) - base;
+        writePages = reinterpret_cast<const char *>(cpu.bus.writePages) - base;
+    }
+};
+
+// helper (네이티브 코드에서 호출)
+uint8_t readHelper(CPU *cpu, uint32_t address)
+{
+    return cpu->bus.readSlow(address);
+}
+
+// 감시 페이지 쓰기로 무효화/매핑 변경/halt 가 일어났으면 true
+bool writeHelper(CPU *cpu, uint32_t address, uint32_t value)
+{
+    uint32_t generation = cpu->blockCache->generation;
+    uint32_t mapGeneration = cpu->bus.mapGeneration;
+    cpu->bus.writeSlow(address, value);
+    return cpu->blockCache->generation != generation || cpu->bus.mapGeneration != mapGeneration || cpu->halted;
+}
+
+// 직접 생성하지 않는 명령어는 BlockCache::execute() 와 같은 방식으로 인터프리터 핸들러 호출
+bool executeHelper(CPU *cpu, const DecodedOp *op)
+{
+    uint32_t generation = cpu->blockCache->generation;
+    uint32_t mapGeneration = cpu->bus.mapGeneration;
+
+    cpu->pc = op->next;
+    cpu->pageCrossed = false;
+    uint16_t address = op->fixed ? op->operand : BlockCache::resolveAddress(*cpu, *op);
+    op->operation(*cpu, address);
+    cpu->cycles += op->cycles + (op->pageCycle && cpu->pageCrossed);
+    ++cpu->instructions;
+
+    return cpu->blockCache->generation != generation || cpu->bus.mapGeneration != mapGeneration || cpu->halted;
+}
+
+class Emitter
+{
+public:
+    std::vector<uint8_t> &out;
+    const Offsets &offsets;
+
+    Emitter(std::vector<uint8_t> &out, const Offsets &offsets) : out(out), offsets(offsets) {}
+
+    void byte(uint8_t value) { out.push_back(value); }
+
+    void u16(uint16_t value)
+    {
+        byte(value & 0xFF);
+        byte(value >> 8);
+    }
+
+    void u32(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            byte((value >> (i * 8)) & 0xFF);
+    }
+
+    void u64(uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+            byte((value >> (i * 8)) & 0xFF);
+    }
+
+    void rex(bool w, int reg, int rm)
+    {
+        uint8_t prefix = 0x40 | (w << 3) | ((reg >> 3) << 2) | (rm >> 3);
+        if (prefix != 0x40)
+            byte(prefix);
+    }
+
+    // [rbp + disp32]
+    void modrmCPU(int reg, int32_t disp)
+    {
+        byte(0x80 | ((reg & 7) << 3) | (REG_CPU & 7));
+        u32(disp);
+    }
+
+    void modrmReg(int reg, int rm) { byte(0xC0 | ((reg & 7) << 3) | (rm & 7)); }
+
+    // movzx reg32, byte [cpu + disp]
+    void loadByte(int reg, int32_t disp)
+    {
+        rex(false, reg, REG_CPU);
+        byte(0x0F);
+        byte(0xB6);
+        modrmCPU(reg, disp);
+    }
+
+    // mov byte [cpu + disp], reg8
+    void storeByte(int32_t disp, int reg)
+    {
+        rex(false, reg, REG_CPU);
+        byte(0x88);
+        modrmCPU(reg, disp);
+    }
+
+    // mov word [cpu + disp], imm16
+    void storeWordImm(int32_t disp, uint16_t value)
+    {
+        byte(0x66);
+        byte(0xC7);
+        modrmCPU(0, disp);
+        u16(value);
+    }
+
+    // add qword [cpu + disp], imm32
+    void addQwordImm(int32_t disp, uint32_t value)
+    {
+        rex(true, 0, REG_CPU);
+        byte(0x81);
+        modrmCPU(0, disp);
+        u32(value);
+    }
+
+    // add qword [cpu + disp], reg64
+    void addQwordReg(int32_t disp, int reg)
+    {
+        rex(true, reg, REG_CPU);
+        byte(0x01);
+        modrmCPU(reg, disp);
+    }
+
+    // mov rax, qword [cpu + disp]
+    void loadPointer(int32_t disp)
+    {
+        rex(true, RAX, REG_CPU);
+        byte(0x8B);
+        modrmCPU(RAX, disp);
+    }
+
+    // esi 주소의 페이지 포인터: mov eax, esi; shr eax, 8; mov rax, qword [cpu + rax * 8 + disp]
+    void loadPagePointer(int32_t disp)
+    {
+        movReg(RAX, RSI);
+        shiftRight(RAX, 8);
+        byte(0x48);
+        byte(0x8B);
+        byte(0x84);
+        byte(0xC5);
+        u32(disp);
+    }
+
+    void testPointer() // test rax, rax
+    {
+        byte(0x48);
+        byte(0x85);
+        byte(0xC0);
+    }
+
+    void movImm(int reg, uint32_t value)
+    {
+        rex(false, 0, reg);
+        byte(0xB8 + (reg & 7));
+        u32(value);
+    }
+
+    void movImm64(int reg, uint64_t value)
+    {
+        rex(true, 0, reg);
+        byte(0xB8 + (reg & 7));
+        u64(value);
+    }
+
+    void movReg(int dst, int src)
+    {
+        rex(false, src, dst);
+        byte(0x89);
+        modrmReg(src, dst);
+    }
+
+    void alu(Alu op, int dst, int src)
+    {
+        rex(false, src, dst);
+        byte(op);
+        modrmReg(src, dst);
+    }
+
+    void aluImm(AluExt ext, int reg, uint32_t value)
+    {
+        rex(false, 0, reg);
+        byte(0x81);
+        modrmReg(ext, reg);
+        u32(value);
+    }
+
+    void shiftRight(int reg, uint8_t count) // shr reg32, imm8
+    {
+        rex(false, 0, reg);
+        byte(0xC1);
+        modrmReg(5, reg);
+        byte(count);
+    }
+
+    void bitwiseNot(int reg)
+    {
+        rex(false, 0, reg);
+        byte(0xF7);
+        modrmReg(2, reg);
+    }
+
+    // movzx dst32, src8
+    void zeroExtend(int dst, int src)
+    {
+        rex(false, dst, src);
+        byte(0x0F);
+        byte(0xB6);
+        modrmReg(dst, src);
+    }
+
+    void statAnd(uint8_t mask) // and bl, imm8
+    {
+        byte(0x80);
+        byte(0xE3);
+        byte(mask);
+    }
+
+    void statOr(uint8_t mask) // or bl, imm8
+    {
+        byte(0x80);
+        byte(0xCB);
+        byte(mask);
+    }
+
+    void statOrReg(int reg8) // or bl, reg8 (al/cl/dl)
+    {
+        byte(0x08);
+        modrmReg(reg8, REG_STAT);
+    }
+
+    void statTest(uint8_t mask) // test bl, imm8
+    {
+        byte(0xF6);
+        byte(0xC3);
+        byte(mask);
+    }
+
+    void setcc(Condition cc, int reg8)
+    {
+        rex(false, 0, reg8);
+        byte(0x0F);
+        byte(0x90 + cc);
+        modrmReg(0, reg8);
+    }
+
+    void testResult() // test al, al
+    {
+        byte(0x84);
+        byte(0xC0);
+    }
+
+    // rel32 를 나중에 채울 위치를 반환
+    size_t jcc(Condition cc)
+    {
+        byte(0x0F);
+        byte(0x80 + cc);
+        u32(0);
+        return out.size() - 4;
+    }
+
+    size_t jmp()
+    {
+        byte(0xE9);
+        u32(0);
+        return out.size() - 4;
+    }
+
+    size_t callRelative()
+    {
+        byte(0xE8);
+        u32(0);
+        return out.size() - 4;
+    }
+
+    void patch(size_t at)
+    {
+        uint32_t rel = static_cast<uint32_t>(out.size() - (at + 4));
+        std::memcpy(&out[at], &rel, 4);
+    }
+
+    template <typename Function>
+    void call(Function function)
+    {
+        movImm64(RAX, reinterpret_cast<uint64_t>(function));
+        byte(0xFF); // call rax
+        byte(0xD0);
+    }
+
+    void movCPUArg() // mov rdi, rbp
+    {
+        byte(0x48);
+        byte(0x89);
+        byte(0xEF);
+    }
+
+    void adjustStack(bool reserve) // sub/add rsp, 8
+    {
+        byte(0x48);
+        byte(0x83);
+        byte(reserve ? 0xEC : 0xC4);
+        byte(0x08);
+    }
+
+    // Z/N 플래그 (value 는 0~255 로 zero-extend 된 32비트 레지스터, ecx/edx 사용)
+    void setZN(int value)
+    {
+        statAnd(~(FLAG_ZERO | FLAG_NEGATIVE) & 0xFF);
+        movReg(RCX, value);
+        aluImm(EXT_AND, RCX, FLAG_NEGATIVE);
+        alu(ALU_TEST, value, value);
+        setcc(CC_Z, RDX);
+        byte(0x00); // add dl, dl
+        byte(0xD2);
+        byte(0x08); // or cl, dl
+        byte(0xD1);
+        statOrReg(RCX);
+    }
+
+    void prologue()
+    {
+        byte(0x53); // push rbx
+        byte(0x55); // push rbp
+        byte(0x41); // push r12
+        byte(0x54);
+        byte(0x41); // push r13
+        byte(0x55);
+        byte(0x41); // push r14
+        byte(0x56);
+        byte(0x41); // push r15
+        byte(0x57);
+        adjustStack(true); // 호출 시 16바이트 정렬
+        byte(0x48);        // mov rbp, rdi
+        byte(0x89);
+        byte(0xFD);
+        loadRegisters();
+    }
+
+    void epilogue()
+    {
+        storeRegisters();
+        adjustStack(false);
+        byte(0x41); // pop r15
+        byte(0x5F);
+        byte(0x41); // pop r14
+        byte(0x5E);
+        byte(0x41); // pop r13
+        byte(0x5D);
+        byte(0x41); // pop r12
+        byte(0x5C);
+        byte(0x5D); // pop rbp
+        byte(0x5B); // pop rbx
+        byte(0xC3); // ret
+    }
+
+    // 네이티브 코드 안에서는 stat 을 bl 에 완성된 형태로 유지 (CPU::getStat() 과 같은 계산, ecx 사용)
+    void loadRegisters()
+    {
+        loadByte(REG_A, offsets.a);
+        loadByte(REG_X, offsets.x);
+        loadByte(REG_Y, offsets.y);
+        loadByte(REG_SP, offsets.sp);
+        loadByte(REG_STAT, offsets.statBits);
+        aluImm(EXT_AND, REG_STAT, ~(FLAG_CARRY | FLAG_ZERO | FLAG_OVERFLOW | FLAG_NEGATIVE) & 0xFF);
+        loadByte(RCX, offsets.carry);
+        alu(ALU_OR, REG_STAT, RCX);
+        loadByte(RCX, offsets.zeroResult);
+        alu(ALU_TEST, RCX, RCX);
+        setcc(CC_Z, RCX);
+        byte(0x00); // add cl, cl
+        byte(0xC9);
+        statOrReg(RCX);
+        loadByte(RCX, offsets.negativeResult);
+        aluImm(EXT_AND, RCX, FLAG_NEGATIVE);
+        alu(ALU_OR, REG_STAT, RCX);
+        loadByte(RCX, offsets.overflowResult);
+        aluImm(EXT_AND, RCX, 0x80);
+        shiftRight(RCX, 1);
+        alu(ALU_OR, REG_STAT, RCX);
+    }
+
+    // CPU::setStat() 과 같은 방식으로 C/Z/V/N 을 다시 나눠서 저장
+    void storeRegisters()
+    {
+        storeByte(offsets.a, REG_A);
+        storeByte(offsets.x, REG_X);
+        storeByte(offsets.y, REG_Y);
+        storeByte(offsets.sp, REG_SP);
+        storeByte(offsets.statBits, REG_STAT);
+        storeByte(offsets.negativeResult, REG_STAT);
+        movReg(RCX, REG_STAT);
+        aluImm(EXT_AND, RCX, FLAG_CARRY);
+        storeByte(offsets.carry, RCX);
+        movReg(RCX, REG_STAT);
+        aluImm(EXT_AND, RCX, FLAG_ZERO);
+        aluImm(EXT_XOR, RCX, FLAG_ZERO);
+        storeByte(offsets.zeroResult, RCX);
+        movReg(RCX, REG_STAT);
+        alu(ALU_ADD, RCX, RCX);
+        storeByte(offsets.overflowResult, RCX);
+    }
+
+    /*
+     * 모든 블록이 공유하는 인터프리터 핸들러 호출 코드 (버퍼 맨 앞)
+     * - rsi = DecodedOp*, 레지스터를 CPU 에 쓰고 executeHelper 를 호출한 뒤 다시 읽음 (al = 중단 여부)
+     */
+    void helperThunk()
+    {
+        storeRegisters();
+        movCPUArg();
+        adjustStack(true); // call 로 어긋난 정렬 복구
+        call(executeHelper);
+        adjustStack(false);
+        loadRegisters();
+        byte(0xC3); // ret
+    }
+};
+
+enum class Native
+{
+    None,
+    Load,      // LDA/LDX/LDY
+    Store,     // STA/STX/STY
+    And,
+    Or,
+    Xor,
+    Add,       // ADC
+    Subtract,  // SBC
+    Compare,   // CMP/CPX/CPY
+    Increment, // INC/DEC (메모리)
+    Transfer,  // TAX/TAY/TXA/TYA/TSX/TXS
+    Step,      // INX/INY/DEX/DEY
+    Flag,      // CLC/SEC/CLI/SEI/CLD/SED/CLV/NOP
+    Branch,
+    Jump,      // JMP abs
+};
+
+struct NativeOp
+{
+    Native kind = Native::None;
+    int reg = 0;      // 대상/원본 6502 레지스터
+    int src = 0;      // Transfer 원본
+    int delta = 0;    // Step/Increment
+    uint8_t mask = 0; // Flag/Branch 비트
+    bool set = false; // Flag: set/clear, Branch: 비트가 1 일 때 분기
+};
+
+// 간접 주소 모드는 인터프리터 핸들러로 처리
+NativeOp classify(uint8_t opcode)
+{
+    NativeOp op;
+    switch (opcode)
+    {
+    case 0xA9: case 0xA5: case 0xB5: case 0xAD: case 0xBD: case 0xB9: op = { Native::Load, REG_A }; break;
+    case 0xA2: case 0xA6: case 0xB6: case 0xAE: case 0xBE: op = { Native::Load, REG_X }; break;
+    case 0xA0: case 0xA4: case 0xB4: case 0xAC: case 0xBC: op = { Native::Load, REG_Y }; break;
+    case 0x85: case 0x95: case 0x8D: case 0x9D: case 0x99: op = { Native::Store, REG_A }; break;
+    case 0x86: case 0x96: case 0x8E: op = { Native::Store, REG_X }; break;
+    case 0x84: case 0x94: case 0x8C: op = { Native::Store, REG_Y }; break;
+    case 0x29: case 0x25: case 0x35: case 0x2D: case 0x3D: case 0x39: op = { Native::And, REG_A }; break;
+    case 0x09: case 0x05: case 0x15: case 0x0D: case 0x1D: case 0x19: op = { Native::Or, REG_A }; break;
+    case 0x49: case 0x45: case 0x55: case 0x4D: case 0x5D: case 0x59: op = { Native::Xor, REG_A }; break;
+    case 0x69: case 0x65: case 0x75: case 0x6D: case 0x7D: case 0x79: op = { Native::Add, REG_A }; break;
+    case 0xE9: case 0xE5: case 0xF5: case 0xED: case 0xFD: case 0xF9: op = { Native::Subtract, REG_A }; break;
+    case 0xC9: case 0xC5: case 0xD5: case 0xCD: case 0xDD: case 0xD9: op = { Native::Compare, REG_A }; break;
+    case 0xE0: case 0xE4: case 0xEC: op = { Native::Compare, REG_X }; break;
+    case 0xC0: case 0xC4: case 0xCC: op = { Native::Compare, REG_Y }; break;
+    case 0xE6: case 0xF6: case 0xEE: case 0xFE: op = { Native::Increment, 0, 0, 1 }; break;
+    case 0xC6: case 0xD6: case 0xCE: case 0xDE: op = { Native::Increment, 0, 0, -1 }; break;
+    case 0xAA: op = { Native::Transfer, REG_X, REG_A }; break;
+    case 0xA8: op = { Native::Transfer, REG_Y, REG_A }; break;
+    case 0x8A: op = { Native::Transfer, REG_A, REG_X }; break;
+    case 0x98: op = { Native::Transfer, REG_A, REG_Y }; break;
+    case 0xBA: op = { Native::Transfer, REG_X, REG_SP }; break;
+    case 0x9A: op = { Native::Transfer, REG_SP, REG_X }; break;
+    case 0xE8: op = { Native::Step, REG_X, 0, 1 }; break;
+    case 0xC8: op = { Native::Step, REG_Y, 0, 1 }; break;
+    case 0xCA: op = { Native::Step, REG_X, 0, -1 }; break;
+    case 0x88: op = { Native::Step, REG_Y, 0, -1 }; break;
+    case 0x18: op = { Native::Flag, 0, 0, 0, FLAG_CARRY, false }; break;
+    case 0x38: op = { Native::Flag, 0, 0, 0, FLAG_CARRY, true }; break;
+    case 0x58: op = { Native::Flag, 0, 0, 0, FLAG_INTERRUPT, false }; break;
+    case 0x78: op = { Native::Flag, 0, 0, 0, FLAG_INTERRUPT, true }; break;
+    case 0xD8: op = { Native::Flag, 0, 0, 0, FLAG_DECIMAL, false }; break;
+    case 0xF8: op = { Native::Flag, 0, 0, 0, FLAG_DECIMAL, true }; break;
+    case 0xB8: op = { Native::Flag, 0, 0, 0, FLAG_OVERFLOW, false }; break;
+    case 0xEA: op = { Native::Flag, 0, 0, 0, 0, false }; break;
+    case 0x90: op = { Native::Branch, 0, 0, 0, FLAG_CARRY, false }; break;
+    case 0xB0: op = { Native::Branch, 0, 0, 0, FLAG_CARRY, true }; break;
+    case 0xD0: op = { Native::Branch, 0, 0, 0, FLAG_ZERO, false }; break;
+    case 0xF0: op = { Native::Branch, 0, 0, 0, FLAG_ZERO, true }; break;
+    case 0x10: op = { Native::Branch, 0, 0, 0, FLAG_NEGATIVE, false }; break;
+    case 0x30: op = { Native::Branch, 0, 0, 0, FLAG_NEGATIVE, true }; break;
+    case 0x50: op = { Native::Branch, 0, 0, 0, FLAG_OVERFLOW, false }; break;
+    case 0x70: op = { Native::Branch, 0, 0, 0, FLAG_OVERFLOW, true }; break;
+    case 0x4C: op = { Native::Jump }; break;
+    default: break;
+    }
+    return op;
+}
+
+// fixed 면 컴파일 시점의 상수 주소, 인덱스 모드면 실행 시점에 esi 에 계산한 주소
+struct Operand
+{
+    bool dynamic;
+    uint16_t address;
+};
+
+class BlockCompiler
+{
+public:
+    std::vector<size_t> thunkCalls; // helperThunk 를 부르는 call rel32 위치 (버퍼에 복사할 때 채움)
+
+    BlockCompiler(CPU &cpu, std::vector<uint8_t> &out) : cpu(cpu), offsets(cpu), e(out, offsets) {}
+
+    void compile(const Block &block)
+    {
+        e.prologue();
+
+        bool exited = false;
+        for (const DecodedOp &op : block.ops)
+        {
+            NativeOp native = classify(op.opcode);
+            if (native.kind == Native::None)
+                exited = emitHelper(op, &op == &block.ops.back());
+            else
+                exited = emitNative(op, native);
+        }
+
+        if (!exited)
+        {
+            e.storeWordImm(offsets.pc, block.ops.back().next);
+            flush();
+            exits.push_back(e.jmp());
+        }
+
+        // 모든 출구가 모이는 곳
+        for (size_t at : exits)
+            e.patch(at);
+        e.epilogue();
+    }
+
+    void compileThunk() { e.helperThunk(); }
+
+private:
+    CPU &cpu;
+    Offsets offsets;
+    Emitter e;
+    std::vector<size_t> exits;
+    uint32_t pendingCycles = 0;
+    uint32_t pendingInstructions = 0;
+
+    // 모아 둔 cycles/instructions 를 CPU 에 반영 (메모리 접근, helper 호출, 출구 전)
+    void flush()
+    {
+        if (pendingCycles)
+            e.addQwordImm(offsets.cycles, pendingCycles);
+        if (pendingInstructions)
+            e.addQwordImm(offsets.instructions, pendingInstructions);
+        pendingCycles = pendingInstructions = 0;
+    }
+
+    void retire(const DecodedOp &op)
+    {
+        pendingCycles += op.cycles;
+        pendingInstructions += 1;
+    }
+
+    // 인덱스 모드는 esi 에 주소를 계산하고, 읽기 명령어면 페이지를 넘을 때 +1 사이클
+    Operand emitAddress(const DecodedOp &op)
+    {
+        int index = REG_X;
+        switch (op.mode)
+        {
+        case AddressMode::ZeroPageYIndexed: index = REG_Y; // fallthrough
+        case AddressMode::ZeroPageXIndexed:
+            e.movReg(RSI, index);
+            e.aluImm(EXT_ADD, RSI, op.operand);
+            e.aluImm(EXT_AND, RSI, 0xFF);
+            return { true, 0 };
+        case AddressMode::AbsoluteYIndexed: index = REG_Y; // fallthrough
+        case AddressMode::AbsoluteXIndexed:
+            if (op.pageCycle)
+            {
+                e.movReg(RDX, index);
+                e.aluImm(EXT_ADD, RDX, op.operand & 0xFF);
+                e.shiftRight(RDX, 8);
+                e.addQwordReg(offsets.cycles, RDX);
+            }
+            e.movReg(RSI, index);
+            e.aluImm(EXT_ADD, RSI, op.operand);
+            e.aluImm(EXT_AND, RSI, 0xFFFF);
+            return { true, 0 };
+        default: return { false, op.operand };
+        }
+    }
+
+    // eax = 메모리[operand]
+    void emitRead(const Operand &operand)
+    {
+        if (operand.dynamic)
+            e.loadPagePointer(offsets.readPages);
+        else
+            e.loadPointer(offsets.readPages + (operand.address >> 8) * 8);
+        e.testPointer();
+        size_t slow = e.jcc(CC_Z);
+        if (operand.dynamic)
+        {
+            e.movReg(RCX, RSI);
+            e.aluImm(EXT_AND, RCX, 0xFF);
+            e.byte(0x0F); // movzx eax, byte [rax + rcx]
+            e.byte(0xB6);
+            e.byte(0x04);
+            e.byte(0x08);
+        }
+        else
+        {
+            e.byte(0x0F); // movzx eax, byte [rax + disp32]
+            e.byte(0xB6);
+            e.byte(0x80);
+            e.u32(operand.address & 0xFF);
+        }
+        size_t done = e.jmp();
+
+        e.patch(slow);
+        e.movCPUArg();
+        if (!operand.dynamic)
+            e.movImm(RSI, operand.address);
+        e.call(readHelper);
+        e.zeroExtend(RAX, RAX);
+        e.patch(done);
+    }
+
+    // 메모리[operand] = value (감시 페이지라 중단해야 하면 op 직후로 빠져나감)
+    void emitWrite(const DecodedOp &op, const Operand &operand, int value)
+    {
+        if (operand.dynamic)
+            e.loadPagePointer(offsets.writePages);
+        else
+            e.loadPointer(offsets.writePages + (operand.address >> 8) * 8);
+        e.testPointer();
+        size_t slow = e.jcc(CC_Z);
+        if (operand.dynamic)
+        {
+            e.movReg(RCX, RSI);
+            e.aluImm(EXT_AND, RCX, 0xFF);
+            e.rex(false, value, RAX); // mov byte [rax + rcx], value8
+            e.byte(0x88);
+            e.byte(0x04 | ((value & 7) << 3));
+            e.byte(0x08);
+        }
+        else
+        {
+            e.rex(false, value, RAX); // mov byte [rax + disp32], value8
+            e.byte(0x88);
+            e.byte(0x80 | ((value & 7) << 3));
+            e.u32(operand.address & 0xFF);
+        }
+        size_t done = e.jmp();
+
+        e.patch(slow);
+        if (value != RDX)
+            e.movReg(RDX, value);
+        e.movCPUArg();
+        if (!operand.dynamic)
+            e.movImm(RSI, operand.address);
+        e.call(writeHelper);
+        e.testResult();
+        size_t resume = e.jcc(CC_Z);
+        // 중단: 이 명령어까지 반영하고 빠져나감 (모아 둔 사이클은 메모리 접근 전에 이미 반영)
+        e.addQwordImm(offsets.cycles, op.cycles);
+        e.addQwordImm(offsets.instructions, 1);
+        e.storeWordImm(offsets.pc, op.next);
+        exits.push_back(e.jmp());
+        e.patch(resume);
+        e.patch(done);
+    }
+
+    // eax = operand 값 (Immediate 는 컴파일 시점의 값, 블록이 유효한 동안 바뀌지 않음)
+    void emitOperand(const DecodedOp &op)
+    {
+        if (op.mode == AddressMode::Immediate)
+        {
+            e.movImm(RAX, cpu.bus.readPages[op.operand >> 8][op.operand & 0xFF]);
+            return;
+        }
+        flush();
+        emitRead(emitAddress(op));
+    }
+
+    bool emitNative(const DecodedOp &op, const NativeOp &native)
+    {
+        switch (native.kind)
+        {
+        case Native::Load:
+            emitOperand(op);
+            e.movReg(native.reg, RAX);
+            e.setZN(native.reg);
+            break;
+        case Native::Store:
+            flush();
+            emitWrite(op, emitAddress(op), native.reg);
+            break;
+        case Native::And:
+        case Native::Or:
+        case Native::Xor:
+            emitOperand(op);
+            e.alu(native.kind == Native::And ? ALU_AND : native.kind == Native::Or ? ALU_OR : ALU_XOR, REG_A, RAX);
+            e.setZN(REG_A);
+            break;
+        case Native::Add:
+            // result = a + value + C (9비트), carry = result >> 8, V = ~(a ^ value) & (a ^ result) & 0x80
+            emitOperand(op);
+            e.movReg(RCX, REG_STAT);
+            e.aluImm(EXT_AND, RCX, FLAG_CARRY);
+            e.alu(ALU_ADD, RCX, REG_A);
+            e.alu(ALU_ADD, RCX, RAX);
+            e.movReg(RDX, REG_A);
+            e.alu(ALU_XOR, RDX, RAX);
+            e.bitwiseNot(RDX);
+            e.movReg(RSI, REG_A);
+            e.alu(ALU_XOR, RSI, RCX);
+            e.alu(ALU_AND, RDX, RSI);
+            e.aluImm(EXT_AND, RDX, 0x80);
+            e.shiftRight(RDX, 1);
+            e.movReg(RAX, RCX);
+            e.shiftRight(RAX, 8);
+            e.statAnd(~(FLAG_CARRY | FLAG_OVERFLOW) & 0xFF);
+            e.statOrReg(RDX);
+            e.statOrReg(RAX);
+            e.zeroExtend(REG_A, RCX);
+            e.setZN(REG_A);
+            break;
+        case Native::Subtract:
+            // result = a - value - !C, carry = result >= 0, V = (a ^ result) & (a ^ value) & 0x80
+            emitOperand(op);
+            e.movReg(RDX, REG_STAT);
+            e.aluImm(EXT_AND, RDX, FLAG_CARRY);
+            e.aluImm(EXT_XOR, RDX, FLAG_CARRY);
+            e.movReg(RCX, REG_A);
+            e.alu(ALU_SUB, RCX, RAX);
+            e.alu(ALU_SUB, RCX, RDX);
+            e.movReg(RDX, REG_A);
+            e.alu(ALU_XOR, RDX, RCX);
+            e.movReg(RSI, REG_A);
+            e.alu(ALU_XOR, RSI, RAX);
+            e.alu(ALU_AND, RDX, RSI);
+            e.aluImm(EXT_AND, RDX, 0x80);
+            e.shiftRight(RDX, 1);
+            e.alu(ALU_TEST, RCX, RCX);
+            e.setcc(CC_NS, RAX);
+            e.statAnd(~(FLAG_CARRY | FLAG_OVERFLOW) & 0xFF);
+            e.statOrReg(RDX);
+            e.statOrReg(RAX);
+            e.zeroExtend(REG_A, RCX);
+            e.setZN(REG_A);
+            break;
+        case Native::Compare:
+            // carry = reg >= value, Z/N = (reg - value) & 0xFF
+            emitOperand(op);
+            e.movReg(RCX, native.reg);
+            e.alu(ALU_SUB, RCX, RAX);
+            e.setcc(CC_AE, RDX);
+            e.statAnd(~FLAG_CARRY & 0xFF);
+            e.statOrReg(RDX);
+            e.zeroExtend(RAX, RCX);
+            e.setZN(RAX);
+            break;
+        case Native::Increment:
+        {
+            // 결과를 edx 에 두고 쓰기 전에 플래그를 계산 (쓰기 helper 는 stat 을 건드리지 않음)
+            // 읽기 helper 가 esi 를 덮어쓸 수 있으므로 인덱스 주소는 쓰기 전에 다시 계산 (pageCycle 없음)
+            flush();
+            emitRead(emitAddress(op));
+            e.aluImm(EXT_ADD, RAX, native.delta);
+            e.zeroExtend(RAX, RAX);
+            e.setZN(RAX);
+            e.movReg(RDX, RAX);
+            emitWrite(op, emitAddress(op), RDX);
+            break;
+        }
+        case Native::Transfer:
+            e.movReg(native.reg, native.src);
+            if (native.reg != REG_SP) // TXS 는 플래그를 바꾸지 않음
+                e.setZN(native.reg);
+            break;
+        case Native::Step:
+            e.aluImm(EXT_ADD, native.reg, native.delta);
+            e.zeroExtend(native.reg, native.reg);
+            e.setZN(native.reg);
+            break;
+        case Native::Flag:
+            if (native.mask && native.set)
+                e.statOr(native.mask);
+            else if (native.mask)
+                e.statAnd(~native.mask & 0xFF);
+            break;
+        case Native::Branch:
+        {
+            // 분기 여부만 실행 시점에 결정 (추가 사이클은 컴파일 시점에 알 수 있음)
+            retire(op);
+            flush();
+            e.statTest(native.mask);
+            size_t notTaken = e.jcc(native.set ? CC_Z : CC_NZ);
+            e.addQwordImm(offsets.cycles, ((op.next ^ op.operand) & 0xFF00) ? 2 : 1);
+            e.storeWordImm(offsets.pc, op.operand);
+            exits.push_back(e.jmp());
+            e.patch(notTaken);
+            e.storeWordImm(offsets.pc, op.next);
+            exits.push_back(e.jmp());
+            return true;
+        }
+        case Native::Jump:
+            retire(op);
+            flush();
+            e.storeWordImm(offsets.pc, op.operand);
+            exits.push_back(e.jmp());
+            return true;
+        default: break;
+        }
+        retire(op);
+        return false;
+    }
+
+    bool emitHelper(const DecodedOp &op, bool last)
+    {
+        flush();
+        e.movImm64(RSI, reinterpret_cast<uint64_t>(&op));
+        thunkCalls.push_back(e.callRelative());
+        if (last) // 제어 흐름 명령어: pc 는 helper 가 설정
+        {
+            exits.push_back(e.jmp());
+            return true;
+        }
+        e.testResult();
+        exits.push_back(e.jcc(CC_NZ));
+        return false;
+    }
+};
+
+// code[begin, end) 를 덮는 페이지의 권한을 바꿈 (W^X: 쓰는 동안만 RW, 그 외에는 RX)
+static bool protect(uint8_t *code, size_t begin, size_t end, bool writable)
+{
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    begin &= ~(pageSize - 1);
+    end = (end + pageSize - 1) & ~(pageSize - 1);
+    return mprotect(code + begin, end - begin, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) == 0;
+}
+
+} // namespace
+
+JIT::JIT(CPU &cpu) : cpu(cpu)
+{
+    void *memory = mmap(nullptr, codeBufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return;
+    code = static_cast<uint8_t *>(memory);
+
+    BlockCompiler(cpu, out).compileThunk();
+    std::memcpy(code, out.data(), out.size());
+    thunkSize = (out.size() + 15) & ~static_cast<size_t>(15);
+    used = thunkSize;
+
+    // 버퍼 전체를 RX 로 (실행 권한을 줄 수 없는 환경이면 JIT 를 쓰지 않음)
+    if (!protect(code, 0, codeBufferSize, false))
+    {
+        munmap(code, codeBufferSize);
+        code = nullptr;
+    }
+}
+
+JIT::~JIT()
+{
+    flush(); // 모드를 바꿔도 블록에 해제된 코드 포인터가 남지 않도록
+    if (code)
+        munmap(code, codeBufferSize);
+}
+
+JIT::NativeBlock JIT::compile(Block &block)
+{
+    if (!code)
+    {
+        block.nativeRejected = true;
+        return nullptr;
+    }
+
+    out.clear();
+    BlockCompiler compiler(cpu, out);
+    compiler.compile(block);
+
+    if (thunkSize + out.size() > codeBufferSize)
+    {
+        block.nativeRejected = true;
+        return nullptr;
+    }
+    if (used + out.size() > codeBufferSize)
+        flush();
+
+    // helperThunk 호출의 상대 주소는 코드 위치가 정해진 뒤에 채움
+    uint8_t *entry = code + used;
+    for (size_t at : compiler.thunkCalls)
+    {
+        uint32_t rel = static_cast<uint32_t>(code - (entry + at + 4));
+        std::memcpy(&out[at], &rel, 4);
+    }
+    if (!protect(code, used, used + out.size(), true))
+    {
+        block.nativeRejected = true;
+        return nullptr;
+    }
+    std::memcpy(entry, out.data(), out.size());
+    if (!protect(code, used, used + out.size(), false))
+    {
+        flush(); // 실행할 수 없는 페이지를 가리키는 블록이 남지 않도록
+        block.nativeRejected = true;
+        return nullptr;
+    }
+    used = (used + out.size() + 15) & ~static_cast<size_t>(15);
+    ++stats.compiled;
+
+    block.native = reinterpret_cast<NativeBlock>(entry);
+    return block.native;
+}
+
+// 버퍼가 가득 차면 전부 버리고 처음부터 다시 컴파일
+void JIT::flush()
+{
+    if (cpu.blockCache)
+        for (Block &block : cpu.blockCache->blocks)
+            block.native = nullptr;
+    used = thunkSize;
+    ++stats.flushes;
+}
+
+#else
+
+JIT::JIT(CPU &cpu) : cpu(cpu) {}
+
+JIT::~JIT() {}
+
+JIT::NativeBlock JIT::compile(Block &block)
+{
+    block.nativeRejected = true;
+    return nullptr;
+}
+
+void JIT::flush() {}
+
+#endif
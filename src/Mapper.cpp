@@ -0,0 +1,378 @@
+#include "Mapper.h"
+#include "Cartridge.h"
+#include "NES.h"
+#include "State.h"
+
+#include <algorithm>
+#include <iterator>
+
+Mapper::Mapper(NES &nes, const Cartridge &cartridge) : nes(nes), cartridge(cartridge)
+{
+}
+
+static size_t wrapBank(int bank, size_t banks)
+{
+    int count = static_cast<int>(banks);
+    return static_cast<size_t>((bank % count + count) % count);
+}
+
+// 롬이 뱅크보다 작으면 (16KB NROM 의 32KB 창) 롬 전체를 미러링
+void Mapper::mapPRG(uint8_t firstPage, size_t size, int bank)
+{
+    size_t banks = cartridge.prgSize / size;
+    if (banks == 0)
+        nes.mapPRGBank(firstPage, size >> 8, cartridge.prg, cartridge.prgSize);
+    else
+        nes.mapPRGBank(firstPage, size >> 8, cartridge.prg + wrapBank(bank, banks) * size, size);
+}
+
+// CHR-ROM 이 없으면 PPU 내장 CHR-RAM 을 같은 방식으로 뱅크 전환 (쓰기 가능)
+void Mapper::mapCHR(int firstPage, int pageCount, int bank)
+{
+    bool ram = cartridge.chrSize == 0;
+    const uint8_t *chr = ram ? nes.ppu.chr.data() : cartridge.chr;
+    size_t chrSize = ram ? nes.ppu.chr.size() : cartridge.chrSize;
+    size_t size = pageCount * 0x400;
+    size_t start = wrapBank(bank, chrSize / size ? chrSize / size : 1) * size;
+    for (int i = 0; i < pageCount; ++i)
+        nes.ppu.mapCHR(firstPage + i, 1, chr + (start + i * 0x400) % chrSize, ram);
+}
+
+// 4화면 카트리지는 미러링을 바꾸지 않음
+void Mapper::setMirroring(int mode)
+{
+    static const Mirroring modes[] = {Mirroring::SingleScreenLower, Mirroring::SingleScreenUpper, Mirroring::Vertical,
+                                      Mirroring::Horizontal};
+    if (!cartridge.fourScreen)
+        nes.ppu.setMirroring(modes[mode & 0x03]);
+}
+
+void Mapper::saveState(StateWriter &writer) const
+{
+    writer.section("MAPR", stateVersion);
+    writer.write16(cartridge.mapper);
+    writer.writeBool(irq);
+    saveRegisters(writer);
+}
+
+bool Mapper::loadState(StateReader &reader)
+{
+    if (!reader.section("MAPR", stateVersion))
+        return false;
+    if (reader.read16() != cartridge.mapper)
+        reader.ok = false;
+    irq = reader.readBool();
+    loadRegisters(reader);
+    if (!reader.ok)
+        return false;
+    apply();
+    return true;
+}
+
+namespace
+{
+
+// 0: 뱅크 전환 없음 (PRG 16/32KB, CHR 8KB)
+class NROM : public Mapper
+{
+public:
+    NROM(NES &nes, const Cartridge &cartridge) : Mapper(nes, cartridge) {}
+
+    void reset() override { apply(); }
+    void write(uint16_t, uint8_t) override {}
+
+protected:
+    void apply() override
+    {
+        mapPRG(0x80, 0x8000, 0);
+        mapCHR(0, 8, 0);
+    }
+};
+
+// 2: $8000 에 16KB 전환, $C000 은 마지막 뱅크 고정
+class UxROM : public Mapper
+{
+public:
+    UxROM(NES &nes, const Cartridge &cartridge) : Mapper(nes, cartridge) {}
+
+    void reset() override
+    {
+        bank = 0;
+        apply();
+    }
+
+    void write(uint16_t, uint8_t value) override
+    {
+        bank = value;
+        mapPRG(0x80, 0x4000, bank);
+    }
+
+protected:
+    uint8_t bank = 0;
+
+    void saveRegisters(StateWriter &writer) const override { writer.write8(bank); }
+    void loadRegisters(StateReader &reader) override { bank = reader.read8(); }
+
+    void apply() override
+    {
+        mapPRG(0x80, 0x4000, bank);
+        mapPRG(0xC0, 0x4000, -1);
+        mapCHR(0, 8, 0);
+    }
+};
+
+// 3: CHR 8KB 전환
+class CNROM : public Mapper
+{
+public:
+    CNROM(NES &nes, const Cartridge &cartridge) : Mapper(nes, cartridge) {}
+
+    void reset() override
+    {
+        bank = 0;
+        apply();
+    }
+
+    void write(uint16_t, uint8_t value) override
+    {
+        bank = value;
+        mapCHR(0, 8, bank);
+    }
+
+protected:
+    uint8_t bank = 0;
+
+    void saveRegisters(StateWriter &writer) const override { writer.write8(bank); }
+    void loadRegisters(StateReader &reader) override { bank = reader.read8(); }
+
+    void apply() override
+    {
+        mapPRG(0x80, 0x8000, 0);
+        mapCHR(0, 8, bank);
+    }
+};
+
+/*
+ * 1: MMC1
+ * - 5비트 직렬 레지스터: 쓰기마다 bit 0 을 밀어 넣고, 다섯 번째 쓰기의 주소 [14:13] 으로 대상 레지스터 선택
+ * - bit 7 을 쓰면 초기화 (PRG 모드 3)
+ * - control: [1:0] 미러링, [3:2] PRG 모드 (0, 1: 32KB / 2: $8000 첫 뱅크 고정 / 3: $C000 마지막 뱅크 고정), [4] CHR 4KB 두 개
+ * - 512KB (SUROM): CHR 뱅크 0 의 bit 4 가 PRG 256KB 바깥 뱅크
+ */
+class MMC1 : public Mapper
+{
+public:
+    MMC1(NES &nes, const Cartridge &cartridge) : Mapper(nes, cartridge) {}
+
+    void reset() override
+    {
+        shift = 0x10;
+        control = 0x0C;
+        chr0 = chr1 = prg = 0;
+        apply();
+    }
+
+    void write(uint16_t address, uint8_t value) override
+    {
+        if (value & 0x80)
+        {
+            shift = 0x10;
+            control |= 0x0C;
+            apply();
+            return;
+        }
+
+        bool full = shift & 0x01;
+        shift = (shift >> 1) | ((value & 0x01) << 4);
+        if (!full)
+            return;
+
+        switch ((address >> 13) & 0x03)
+        {
+        case 0: control = shift; break;
+        case 1: chr0 = shift; break;
+        case 2: chr1 = shift; break;
+        case 3: prg = shift; break;
+        }
+        shift = 0x10;
+        apply();
+    }
+
+protected:
+    uint8_t shift = 0x10;
+    uint8_t control = 0x0C;
+    uint8_t chr0 = 0, chr1 = 0, prg = 0;
+
+    void saveRegisters(StateWriter &writer) const override
+    {
+        writer.write8(shift);
+        writer.write8(control);
+        writer.write8(chr0);
+        writer.write8(chr1);
+        writer.write8(prg);
+    }
+
+    void loadRegisters(StateReader &reader) override
+    {
+        shift = reader.read8();
+        control = reader.read8();
+        chr0 = reader.read8();
+        chr1 = reader.read8();
+        prg = reader.read8();
+    }
+
+    void apply() override
+    {
+        setMirroring(control & 0x03);
+
+        if (control & 0x10)
+        {
+            mapCHR(0, 4, chr0);
+            mapCHR(4, 4, chr1);
+        }
+        else
+            mapCHR(0, 8, chr0 >> 1);
+
+        int outer = cartridge.prgSize > 0x40000 ? (chr0 & 0x10) : 0; // 16KB 단위
+        int bank = outer | (prg & 0x0F);
+        switch ((control >> 2) & 0x03)
+        {
+        case 0:
+        case 1: mapPRG(0x80, 0x8000, bank >> 1); break;
+        case 2:
+            mapPRG(0x80, 0x4000, outer);
+            mapPRG(0xC0, 0x4000, bank);
+            break;
+        case 3:
+            mapPRG(0x80, 0x4000, bank);
+            mapPRG(0xC0, 0x4000, outer | 0x0F);
+            break;
+        }
+    }
+};
+
+/*
+ * 4: MMC3
+ * - $8000 (짝수): [2:0] 다음에 바꿀 뱅크 레지스터, [6] PRG 모드, [7] CHR A12 반전 / $8001: 뱅크 번호
+ * - R0, R1: CHR 2KB, R2-R5: CHR 1KB, R6, R7: PRG 8KB (끝에서 두 번째와 마지막 뱅크는 고정)
+ * - $A000: 미러링, $C000: IRQ latch, $C001: reload, $E000: IRQ 끄고 확인, $E001: IRQ 켬
+ * - IRQ 카운터: 렌더링 중인 줄마다 0 이거나 reload 면 latch 로, 아니면 1 감소. 0 이 되고 IRQ 가 켜져 있으면 irq
+ */
+class MMC3 : public Mapper
+{
+public:
+    MMC3(NES &nes, const Cartridge &cartridge) : Mapper(nes, cartridge) {}
+
+    void reset() override
+    {
+        static const uint8_t initialBanks[8] = {0, 2, 4, 5, 6, 7, 0, 1};
+        std::copy(std::begin(initialBanks), std::end(initialBanks), banks);
+        bankSelect = 0;
+        mirroring = cartridge.mirroring == Mirroring::Vertical ? 0 : 1;
+        irqLatch = irqCounter = 0;
+        irqReload = irqEnabled = false;
+        irq = false;
+        apply();
+    }
+
+    void write(uint16_t address, uint8_t value) override
+    {
+        switch (address & 0xE001)
+        {
+        case 0x8000: bankSelect = value; break;
+        case 0x8001: banks[bankSelect & 0x07] = value; break;
+        case 0xA000: mirroring = value & 0x01; break;
+        case 0xA001: return; // PRG-RAM 보호 (무시)
+        case 0xC000: irqLatch = value; return;
+        case 0xC001:
+            irqCounter = 0;
+            irqReload = true;
+            return;
+        case 0xE000:
+            irqEnabled = false;
+            irq = false;
+            return;
+        case 0xE001: irqEnabled = true; return;
+        }
+        apply();
+    }
+
+    void scanline() override
+    {
+        if (irqCounter == 0 || irqReload)
+        {
+            irqCounter = irqLatch;
+            irqReload = false;
+        }
+        else
+            --irqCounter;
+
+        if (irqCounter == 0 && irqEnabled)
+            irq = true;
+    }
+
+    bool countsScanlines() const override { return irqEnabled; }
+
+protected:
+    uint8_t banks[8] = {};
+    uint8_t bankSelect = 0;
+    uint8_t mirroring = 0;
+    uint8_t irqLatch = 0;
+    uint8_t irqCounter = 0;
+    bool irqReload = false;
+    bool irqEnabled = false;
+
+    void saveRegisters(StateWriter &writer) const override
+    {
+        writer.bytes(banks, sizeof(banks));
+        writer.write8(bankSelect);
+        writer.write8(mirroring);
+        writer.write8(irqLatch);
+        writer.write8(irqCounter);
+        writer.writeBool(irqReload);
+        writer.writeBool(irqEnabled);
+    }
+
+    void loadRegisters(StateReader &reader) override
+    {
+        reader.bytes(banks, sizeof(banks));
+        bankSelect = reader.read8();
+        mirroring = reader.read8();
+        irqLatch = reader.read8();
+        irqCounter = reader.read8();
+        irqReload = reader.readBool();
+        irqEnabled = reader.readBool();
+    }
+
+    void apply() override
+    {
+        setMirroring(mirroring ? 3 : 2);
+
+        int invert = (bankSelect & 0x80) ? 4 : 0;
+        mapCHR(0 ^ invert, 2, banks[0] >> 1);
+        mapCHR(2 ^ invert, 2, banks[1] >> 1);
+        for (int i = 0; i < 4; ++i)
+            mapCHR((4 + i) ^ invert, 1, banks[2 + i]);
+
+        bool swap = bankSelect & 0x40;
+        mapPRG(0x80, 0x2000, swap ? -2 : banks[6] & 0x3F);
+        mapPRG(0xA0, 0x2000, banks[7] & 0x3F);
+        mapPRG(0xC0, 0x2000, swap ? banks[6] & 0x3F : -2);
+        mapPRG(0xE0, 0x2000, -1);
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Mapper> Mapper::create(NES &nes, const Cartridge &cartridge, std::string &error)
+{
+    switch (cartridge.mapper)
+    {
+    case 0: return std::unique_ptr<Mapper>(new NROM(nes, cartridge));
+    case 1: return std::unique_ptr<Mapper>(new MMC1(nes, cartridge));
+    case 2: return std::unique_ptr<Mapper>(new UxROM(nes, cartridge));
+    case 3: return std::unique_ptr<Mapper>(new CNROM(nes, cartridge));
+    case 4: return std::unique_ptr<Mapper>(new MMC3(nes, cartridge));
+    default: error = "unsupported mapper " + std::to_string(cartridge.mapper); return nullptr;
+    }
+}
@@ -0,0 +1,279 @@
+#include "NES.h"
+#include "State.h"
+
+NES::NES() : ram(0x800, 0), prgRAM(0x2000, 0)
+{
+    ppuRegisters = { readPPURegister, writePPURegister, this };
+    ioRegisters = { readIORegister, writeIORegister, this };
+    mapperRegisters = { readMapperRegister, writeMapperRegister, this };
+
+    Bus &bus = cpu.bus;
+    bus.mapMemory(0x00, 0x20, ram.data(), ram.size(), true);
+    bus.mapHandler(0x20, 0x20, &ppuRegisters);
+    bus.mapHandler(0x40, 0x01, &ioRegisters);
+    bus.unmap(0x41, 0x1F);
+    bus.mapMemory(0x60, 0x20, prgRAM.data(), prgRAM.size(), true);
+    bus.unmap(0x80, 0x80);
+
+    cpu.stat |= 0x04; // 전원 투입: I 플래그 (APU 프레임 IRQ 가 켜진 채로 시작)
+
+    ppu.vblankNMI = [this] { nmiPending = true; };
+    ppu.scanlineCounter = [this] {
+        if (mapper)
+            mapper->scanline();
+    };
+    ppuDeadline = ppu.dotsUntilVblank();
+
+    apu.readMemory = [this](uint16_t address) { return cpu.bus.read(address); };
+    apuDeadline = apu.nextEvent();
+}
+
+void NES::loadPRG(const std::vector<uint8_t> &prg)
+{
+    prgROM = prg;
+    mapPRGBank(0x80, 0x80, prgROM.data(), prgROM.size());
+}
+
+/*
+ * 카트리지를 바꿔도 새 매퍼가 모든 뱅크를 다시 배치한 뒤에 이전 매핑을 해제
+ * - 4화면 미러링은 네임 테이블 RAM 이 2KB 뿐이므로 vertical 로 처리
+ */
+bool NES::loadCartridge(const std::string &path, std::string &error)
+{
+    std::unique_ptr<Cartridge> next(new Cartridge);
+    if (!next->open(path, error))
+        return false;
+    std::unique_ptr<Mapper> nextMapper = Mapper::create(*this, *next, error);
+    if (!nextMapper)
+        return false;
+
+    syncPPU();
+    ppu.setMirroring(next->fourScreen ? Mirroring::Vertical : next->mirroring);
+    std::unique_ptr<Cartridge> previous = std::move(cartridge);
+    cartridge = std::move(next);
+    mapper = std::move(nextMapper);
+    mapper->reset();
+    return true;
+}
+
+// 뱅크 스위칭: 페이지 테이블의 포인터만 교체 (매퍼가 있으면 쓰기는 매퍼 레지스터로)
+void NES::mapPRGBank(uint8_t firstPage, int count, const uint8_t *bank, size_t size)
+{
+    cpu.bus.mapROM(firstPage, count, bank, size, mapper ? &mapperRegisters : nullptr);
+}
+
+// 명령어 하나를 실행하고 그만큼(CPU 1 사이클 = PPU 3 dot) PPU 를 진행 (CatchUp 이면 필요할 때까지 미룸)
+void NES::step()
+{
+    uint64_t start = cpu.cycles; // 인터럽트 진입 7 사이클도 PPU 시간에 포함
+    if (nmiPending)
+    {
+        nmiPending = false;
+        cpu.nmi();
+    }
+    else if ((mapper && mapper->irq) || apu.irq())
+        cpu.irq(); // I 플래그가 켜져 있으면 무시 (매퍼/APU 가 내릴 때까지 계속 요청)
+
+    cpu.execute();
+    ppuTargetDot += (cpu.cycles - start) * 3;
+
+    // OAM DMA 는 $4014 에 쓴 명령어가 끝난 뒤 시작
+    if (dmaPending)
+    {
+        dmaPending = false;
+        catchUpPPU();
+        start = cpu.cycles;
+        oamDMA(dmaPage);
+        ppuTargetDot += (cpu.cycles - start) * 3;
+    }
+
+    // 매퍼 IRQ 가 켜져 있으면 IRQ 시점을 놓치지 않도록 명령어마다 따라잡음
+    if (ppuScheduling == PPUScheduling::LockStep || ppuTargetDot >= ppuDeadline ||
+        (mapper && mapper->countsScanlines()))
+        catchUpPPU();
+    if (cpu.cycles >= apuDeadline)
+        catchUpAPU();
+}
+
+// 밀린 dot 을 한 번에 진행하고 다음 NMI 시점을 다시 계산
+void NES::catchUpPPU()
+{
+    ppu.runUntil(ppuTargetDot);
+    ppuDeadline = ppu.dot + ppu.dotsUntilVblank();
+}
+
+void NES::catchUpAPU()
+{
+    apu.runUntil(cpu.cycles);
+    apuDeadline = apu.nextEvent();
+}
+
+void NES::setAudioEnabled(bool enabled)
+{
+    catchUpAPU();
+    apu.setAudioEnabled(enabled);
+    apuDeadline = apu.nextEvent();
+}
+
+void NES::syncPPU()
+{
+    catchUpPPU();
+    ppu.sync();
+}
+
+// 기록 순서: NES 헤더, CPU, PPU, APU, 내부 RAM, PRG-RAM, 매퍼 (카트리지가 있을 때)
+void NES::saveState(std::vector<uint8_t> &buffer)
+{
+    catchUpPPU();
+    catchUpAPU();
+    buffer.clear();
+    StateWriter writer(buffer);
+    writer.section("NES ", stateVersion);
+    writer.writeBool(nmiPending);
+    writer.writeBool(controllerStrobe);
+    writer.bytes(controllerShift, sizeof(controllerShift));
+    cpu.saveState(writer);
+    ppu.saveState(writer);
+    apu.saveState(writer);
+    writer.bytes(ram.data(), ram.size());
+    writer.bytes(prgRAM.data(), prgRAM.size());
+    if (mapper)
+        mapper->saveState(writer);
+}
+
+// 버전이 다르거나 데이터가 잘렸으면 false (이 경우 상태가 일부만 바뀌었을 수 있음)
+bool NES::loadState(const std::vector<uint8_t> &buffer)
+{
+    StateReader reader(buffer);
+    if (!reader.section("NES ", stateVersion))
+        return false;
+    nmiPending = reader.readBool();
+    controllerStrobe = reader.readBool();
+    reader.bytes(controllerShift, sizeof(controllerShift));
+    if (!cpu.loadState(reader) || !ppu.loadState(reader))
+        return false;
+    ppuTargetDot = ppu.dot;
+    ppuDeadline = ppu.dot + ppu.dotsUntilVblank();
+    if (!apu.loadState(reader))
+        return false;
+    apuDeadline = apu.nextEvent();
+    reader.bytes(ram.data(), ram.size());
+    reader.bytes(prgRAM.data(), prgRAM.size());
+    if (mapper && !mapper->loadState(reader))
+        return false;
+    return reader.ok;
+}
+
+// 레지스터에 접근하기 전에 PPU 를 이 명령어 시작 시점까지 따라잡음
+uint8_t NES::readPPURegister(void *context, uint16_t address)
+{
+    NES &nes = *static_cast<NES *>(context);
+    nes.catchUpPPU();
+    PPU &ppu = nes.ppu;
+    switch (address & 0x07)
+    {
+    case 2: return ppu.getPPUStatus();
+    case 4: return ppu.getOAMData();
+    case 7: return ppu.getPPUData();
+    default: return 0; // 쓰기 전용 레지스터
+    }
+}
+
+void NES::writePPURegister(void *context, uint16_t address, uint8_t value)
+{
+    NES &nes = *static_cast<NES *>(context);
+    nes.catchUpPPU();
+    PPU &ppu = nes.ppu;
+    switch (address & 0x07)
+    {
+    case 0: ppu.setPPUCtrl(value); break;
+    case 1: ppu.setPPUMask(value); break;
+    case 3: ppu.setOAMAddr(value); break;
+    case 4: ppu.setOAMData(value); break;
+    case 5: ppu.setPPUSCroll(value); break;
+    case 6: ppu.setPPUAddr(value); break;
+    case 7: ppu.setPPUData(value); break;
+    default: break; // PPUSTATUS 는 읽기 전용
+    }
+}
+
+uint8_t NES::readIORegister(void *context, uint16_t address)
+{
+    NES &nes = *static_cast<NES *>(context);
+    if (address == 0x4015)
+    {
+        nes.catchUpAPU();
+        uint8_t status = nes.apu.readStatus();
+        nes.apuDeadline = nes.apu.nextEvent(); // 프레임 IRQ 를 지웠으면 다음 IRQ 시점
+        return status;
+    }
+    if (address == 0x4016 || address == 0x4017)
+    {
+        int port = address & 1;
+        if (nes.controllerStrobe)
+            nes.controllerShift[port] = nes.buttons[port];
+        uint8_t bit = nes.controllerShift[port] & 1;
+        nes.controllerShift[port] = (nes.controllerShift[port] >> 1) | 0x80;
+        return 0x40 | bit;
+    }
+    return 0; // 나머지 ($4000-$4013 등) 는 쓰기 전용, open bus 는 흉내 내지 않음
+}
+
+void NES::writeIORegister(void *context, uint16_t address, uint8_t value)
+{
+    NES &nes = *static_cast<NES *>(context);
+    if (address == 0x4014)
+    {
+        nes.dmaPending = true;
+        nes.dmaPage = value;
+    }
+    else if (address == 0x4016)
+    {
+        nes.controllerStrobe = value & 1;
+        if (nes.controllerStrobe)
+        {
+            nes.controllerShift[0] = nes.buttons[0];
+            nes.controllerShift[1] = nes.buttons[1];
+        }
+    }
+    else if (address <= 0x4013 || address == 0x4015 || address == 0x4017)
+    {
+        nes.catchUpAPU();
+        nes.apu.writeRegister(address, value);
+        nes.apuDeadline = nes.apu.nextEvent();
+    }
+}
+
+// $8000-$FFFF 읽기는 ROM 페이지에서 바로 처리되므로 호출되지 않음
+uint8_t NES::readMapperRegister(void *, uint16_t)
+{
+    return 0;
+}
+
+// 뱅크 전환 전에 PPU / APU 를 따라잡음 (바뀌기 전의 dot 과 DMC 읽기는 이전 뱅크로)
+void NES::writeMapperRegister(void *context, uint16_t address, uint8_t value)
+{
+    NES &nes = *static_cast<NES *>(context);
+    nes.catchUpPPU();
+    nes.catchUpAPU();
+    nes.mapper->write(address, value);
+}
+
+/*
+ * $XX00-$XXFF 256바이트를 OAM 으로 한 번에 복사 (CPU 는 513/514 사이클 정지)
+ * - 메모리 페이지(RAM, PRG)는 페이지 포인터에서 바로 복사
+ * - IO 페이지는 바이트마다 읽기 핸들러를 거침
+ */
+void NES::oamDMA(uint8_t page)
+{
+    const uint8_t *source = cpu.bus.readPages[page];
+    uint8_t buffer[256];
+    if (source == nullptr)
+    {
+        for (int i = 0; i < 256; ++i)
+            buffer[i] = cpu.read((page << 8) | i);
+        source = buffer;
+    }
+    ppu.writeOAM(source);
+    cpu.cycles += oamDMACycles(cpu.cycles);
+}
@@ -0,0 +1,39 @@
+#include "OutputQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+const size_t AudioBlock::capacity;
+
+bool FrameQueue::push(const FrameBuffer::View &frame)
+{
+    QueuedFrame *slot = queue.acquire();
+    if (!slot)
+        return false;
+    std::memcpy(slot->pixels, frame.pixels, sizeof(slot->pixels));
+    std::memcpy(slot->emphasis, frame.emphasis, sizeof(slot->emphasis));
+    slot->sequence = frame.sequence;
+    queue.publish();
+    return true;
+}
+
+size_t AudioQueue::push(const int16_t *samples, size_t count)
+{
+    size_t queued = 0;
+    for (size_t offset = 0; offset < count;)
+    {
+        size_t length = std::min(count - offset, AudioBlock::capacity);
+        AudioBlock *block = queue.acquire();
+        if (block)
+        {
+            std::memcpy(block->samples, samples + offset, length * sizeof(int16_t));
+            block->count = length;
+            block->first = produced + offset;
+            queue.publish();
+            queued += length;
+        }
+        offset += length;
+    }
+    produced += count;
+    return queued;
+}
@@ -1,33 +1,54 @@
 #include "PPU.h"
+#include "PixelKernels.h"
+#include "State.h"
+
+#include <algorithm>
+#include <cstring>
 
 static const int visibleCycle = 256;
-static const int endCycle = 340;
+static const uint32_t endCycle = 340; // cycle 과 같은 타입
 static const int visibleScanlines = 240;
 
-// temp
-static const uint32_t colors[] = {
-    0x666666ff, 0x002a88ff, 0x1412a7ff, 0x3b00a4ff, 0x5c007eff, 0x6e0040ff, 0x6c0600ff, 0x561d00ff, 0x333500ff, 0x0b4800ff, 0x005200ff,
-    0x004f08ff, 0x00404dff, 0x000000ff, 0x000000ff, 0x000000ff, 0xadadadff, 0x155fd9ff, 0x4240ffff, 0x7527feff, 0xa01accff, 0xb71e7bff,
-    0xb53120ff, 0x994e00ff, 0x6b6d00ff, 0x388700ff, 0x0c9300ff, 0x008f32ff, 0x007c8dff, 0x000000ff, 0x000000ff, 0x000000ff, 0xfffeffff,
-    0x64b0ffff, 0x9290ffff, 0xc676ffff, 0xf36affff, 0xfe6eccff, 0xfe8170ff, 0xea9e22ff, 0xbcbe00ff, 0x88d800ff, 0x5ce430ff, 0x45e082ff,
-    0x48cddeff, 0x4f4f4fff, 0x000000ff, 0x000000ff, 0xfffeffff, 0xc0dfffff, 0xd3d2ffff, 0xe8c8ffff, 0xfbc2ffff, 0xfec4eaff, 0xfeccc5ff,
-    0xf7d8a5ff, 0xe4e594ff, 0xcfef96ff, 0xbdf4abff, 0xb3f3ccff, 0xb5ebf2ff, 0xb8b8b8ff, 0x000000ff, 0x000000ff,
-};
+PPU::PPU()
+    : baseNTAddr(0x2000), vIncrement(1), sprPTAddr(0), bgPTAddr(0), sprSize(8), masterSlave(false),
+      enableVblankNMI(false), graycale(false), showBgInLeftmost(false), showSprInLeftmost(false),
+      enableBgRendering(false), enableSprRendering(false), emphasizeRGB(0), spriteOverflow(false), sprZeroHit(false),
+      vblankFlag(false), readBuffer(0), oamAddr(0), oam(256, 0), soam(), soamCount(0),
+      sprLine(), v(0), t(0), x(0), w(false), cycle(0), scanline(261),
+      oddFrame(false), bgShifterLow(0), bgShifterHigh(0), bgPaletteShifter(0), pipelineState(PreRender),
+      palette(32, 0), chr(0x2000, 0), vram(0x800, 0),
+      mirroring(Mirroring::Vertical), tiles(tileCount * 64, 0), flippedTiles(tileCount * 64, 0),
+      tileDirty(tileCount, 1), vblankNMI([] {}), scanlineCounter([] {}), renderMode(RenderMode::Scanline),
+      pendingDots(0), dot(0),
+      frameSkip(0), skippedFrames(0), skipFrame(false), sprZeroInLine(false), sprZeroHitX(-1)
+{
+    for (int page = 0; page < chrPageCount; ++page)
+    {
+        chrPages[page] = &chr[page * 0x400];
+        chrWritable[page] = true;
+    }
+}
 
 // set IORegisters (called by CPU)
+// - 레지스터 접근 전에 미뤄 둔 dot 을 먼저 처리 (sync)
 
 void PPU::setPPUCtrl(uint8_t ctrl)
 {
+    sync();
     baseNTAddr = 0x2000 + ((ctrl & 0x03) << 10);
     vIncrement = (ctrl & 0x04) ? 32 : 1;
     sprPTAddr = ((ctrl >> 3) & 0x01) << 12;
     bgPTAddr = ((ctrl >> 4) & 0x01) << 12;
     sprSize = (ctrl & 0x20) ? 16 : 8;
     enableVblankNMI = ctrl & 0x80;
+
+    // t: ....BA.. ........ <- ctrl: ......BA
+    t = (t & ~0x0C00) | ((ctrl & 0x03) << 10);
 }
 
 void PPU::setPPUMask(uint8_t mask)
 {
+    sync();
     graycale = mask & 0x01;
     showBgInLeftmost = mask & 0x02;
     showSprInLeftmost = mask & 0x04;
@@ -38,11 +59,13 @@ void PPU::setPPUMask(uint8_t mask)
 
 void PPU::setOAMAddr(uint8_t oamAddr)
 {
+    sync();
     this->oamAddr = oamAddr;
 }
 
 void PPU::setPPUSCroll(uint8_t scroll)
 {
+    sync();
     if (!w) // set (coarseX and fineX) of t
     {
         t &= ~0x1f;
@@ -61,6 +84,7 @@ void PPU::setPPUSCroll(uint8_t scroll)
 
 void PPU::setPPUAddr(uint8_t addr)
 {
+    sync();
     if (!w) // t의 상위 8비트 세팅 (0_CDEFGH)
     {
         t &= ~0xFF00;
@@ -76,12 +100,249 @@ void PPU::setPPUAddr(uint8_t addr)
     }
 }
 
+void PPU::setOAMData(uint8_t data)
+{
+    sync();
+    oam[oamAddr++] = data;
+}
+
+void PPU::writeOAM(const uint8_t *data)
+{
+    sync();
+    size_t first = 256 - oamAddr;
+    std::memcpy(&oam[oamAddr], data, first);
+    std::memcpy(&oam[0], data + first, oamAddr);
+}
+
+void PPU::setPPUData(uint8_t data)
+{
+    sync();
+    write(v, data);
+    v = (v + vIncrement) & 0x7FFF;
+}
+
 uint8_t PPU::getPPUStatus()
 {
+    sync();
+    uint8_t status = (vblankFlag << 7) | (sprZeroHit << 6) | (spriteOverflow << 5);
     vblankFlag = 0;
+    w = 0;
+    return status;
+}
+
+uint8_t PPU::getOAMData()
+{
+    sync();
+    return oam[oamAddr];
+}
+
+uint8_t PPU::getPPUData()
+{
+    sync();
+    uint16_t address = v & 0x3FFF;
+    uint8_t data = readBuffer;
+    readBuffer = read(address);
+    if (address >= 0x3F00) // 팔레트는 바로 읽힘 (버퍼에는 아래쪽 네임테이블 값)
+    {
+        data = readBuffer;
+        readBuffer = read(address - 0x1000);
+    }
+    v = (v + vIncrement) & 0x7FFF;
+    return data;
+}
+
+// VRAM ($0000-$3FFF)
+uint8_t PPU::read(uint16_t address)
+{
+    address &= 0x3FFF;
+    if (address < 0x2000)
+        return chrByte(address);
+    if (address < 0x3F00)
+        return vram[nameTableAddress(address)];
+
+    address &= 0x1F;
+    if ((address & 0x13) == 0x10) // $3F10/$3F14/$3F18/$3F1C -> $3F00/$3F04/$3F08/$3F0C
+        address &= 0x0F;
+    return palette[address];
+}
+
+void PPU::write(uint16_t address, uint8_t value)
+{
+    address &= 0x3FFF;
+    if (address < 0x2000)
+    {
+        if (!chrWritable[address >> 10])
+            return; // CHR-ROM
+        chrPages[address >> 10][address & 0x3FF] = value;
+        tileDirty[address >> 4] = 1;
+    }
+    else if (address < 0x3F00)
+        vram[nameTableAddress(address)] = value;
+    else
+    {
+        address &= 0x1F;
+        if ((address & 0x13) == 0x10)
+            address &= 0x0F;
+        palette[address] = value & 0x3F;
+    }
+}
+
+// 포인터가 바뀐 페이지의 타일(페이지당 64개)만 다시 디코딩
+void PPU::mapCHR(int firstPage, int count, const uint8_t *bank, bool writable)
+{
+    sync();
+    for (int i = 0; i < count; ++i)
+    {
+        int page = (firstPage + i) & (chrPageCount - 1);
+        uint8_t *memory = const_cast<uint8_t *>(bank + i * 0x400); // 쓰기 금지 페이지에는 쓰지 않음
+        chrWritable[page] = writable;
+        if (chrPages[page] == memory)
+            continue;
+        chrPages[page] = memory;
+        std::fill(tileDirty.begin() + page * 64, tileDirty.begin() + page * 64 + 64, 1);
+    }
+}
+
+void PPU::setMirroring(Mirroring mirroring)
+{
+    sync();
+    this->mirroring = mirroring;
+}
+
+// $2000-$2FFF ($3000-$3EFF 미러) 를 2KB vram 의 오프셋으로 변환
+uint16_t PPU::nameTableAddress(uint16_t address)
+{
+    uint16_t table = (address >> 10) & 0x03; // 0: $2000, 1: $2400, 2: $2800, 3: $2C00
+    uint16_t offset = address & 0x03FF;
+    switch (mirroring)
+    {
+    case Mirroring::Horizontal: return ((table >> 1) << 10) | offset;
+    case Mirroring::Vertical: return ((table & 0x01) << 10) | offset;
+    case Mirroring::SingleScreenLower: return offset;
+    case Mirroring::SingleScreenUpper: return 0x400 | offset;
+    default: return offset;
+    }
+}
+
+// CHR 타일 캐시
+void PPU::decodeTile(int tile)
+{
+    const uint8_t *planes = &chrPages[tile >> 6][(tile & 63) * 16]; // low plane 8바이트 + high plane 8바이트
+    const PixelKernels &kernels = pixelKernels();
+    kernels.decodeRows(planes, planes + 8, nullptr, 8, &tiles[tile * 64], false);
+    kernels.decodeRows(planes, planes + 8, nullptr, 8, &flippedTiles[tile * 64], true);
+    tileDirty[tile] = 0;
+    ++tileStats.decodes;
+    ++tileStats.frameDecodes;
+}
+
+const uint8_t *PPU::tileRow(uint16_t ptAddr)
+{
+    int tile = (ptAddr >> 4) & (tileCount - 1);
+    if (tileDirty[tile])
+        decodeTile(tile);
+    return &tiles[tile * 64 + (ptAddr & 0x07) * 8];
+}
+
+const uint8_t *PPU::flippedTileRow(uint16_t ptAddr)
+{
+    int tile = (ptAddr >> 4) & (tileCount - 1);
+    if (tileDirty[tile])
+        decodeTile(tile);
+    return &flippedTiles[tile * 64 + (ptAddr & 0x07) * 8];
+}
+
+// chr 를 write() 를 거치지 않고 바꿨을 때 (save state)
+void PPU::invalidateTiles()
+{
+    std::fill(tileDirty.begin(), tileDirty.end(), 1);
+}
+
+size_t PPU::tileCacheBytes() const
+{
+    return tiles.size() + flippedTiles.size() + tileDirty.size();
 }
 
 // rendering
+void PPU::tick(uint32_t dots)
+{
+    dot += dots;
+    while (dots > 0)
+    {
+        if (pendingDots == 0 && !(renderMode == RenderMode::Scanline && pipelineState == VisibleRender && cycle == 0))
+        {
+            // post-render / vblank 줄은 vblank 시작(cycle 1)과 줄 끝 사이에 할 일이 없으므로 한 번에 건너뜀
+            if ((pipelineState == PostRender || pipelineState == VBlank) && cycle >= 2 && cycle < endCycle)
+            {
+                uint32_t idle = std::min(dots, endCycle - cycle);
+                cycle += idle;
+                dots -= idle;
+                continue;
+            }
+            render();
+            --dots;
+            continue;
+        }
+
+        uint32_t step = std::min(dots, scanlineDots - pendingDots);
+        pendingDots += step;
+        dots -= step;
+        if (pendingDots == scanlineDots)
+        {
+            pendingDots = 0;
+            renderScanline();
+        }
+    }
+}
+
+// 누적 dot 이 targetDot 이 될 때까지 진행 (이미 지났으면 아무것도 하지 않음)
+void PPU::runUntil(uint64_t targetDot)
+{
+    while (dot < targetDot)
+        tick(static_cast<uint32_t>(std::min<uint64_t>(targetDot - dot, UINT32_MAX)));
+}
+
+/*
+ * 다음 vblank 시작(scanline 241, cycle 1 의 dot, NMI 발생)을 처리하려면 더 받아야 하는 dot 수
+ * - 한 줄은 341 dot, pre-render 줄은 홀수 프레임이면 340 dot (scanline 0 ~ 260 다음이 pre-render)
+ * - pendingDots 는 이미 받았지만 처리하지 않은 dot 이므로 뺌
+ */
+uint32_t PPU::dotsUntilVblank() const
+{
+    const uint32_t vblankDot = 241 * scanlineDots + 1; // scanline 0, cycle 0 부터의 위치
+    uint32_t dots;
+    if (pipelineState == PreRender)
+        dots = (endCycle - oddFrame - cycle + 1) + vblankDot + 1;
+    else
+    {
+        uint32_t position = scanline * scanlineDots + cycle;
+        if (position <= vblankDot)
+            dots = vblankDot - position + 1;
+        else // 다음 프레임 (pre-render 에 들어가면 oddFrame 이 바뀜)
+            dots = (261 * scanlineDots - position) + (scanlineDots - !oddFrame) + vblankDot + 1;
+    }
+    return dots - pendingDots;
+}
+
+void PPU::sync()
+{
+    for (; pendingDots > 0; --pendingDots)
+        render();
+}
+
+void PPU::setRenderMode(RenderMode mode)
+{
+    sync();
+    renderMode = mode;
+}
+
+// 다음 프레임부터 적용
+void PPU::setFrameSkip(uint32_t skip)
+{
+    frameSkip = skip;
+    skippedFrames = 0;
+}
+
 void PPU::render()
 {
     switch (pipelineState)
@@ -102,15 +363,40 @@ void PPU::preRender()
         vblankFlag = false;
         sprZeroHit = false;
         spriteOverflow = false;
+
+        tileStats.lastFrameDecodes = tileStats.frameDecodes;
+        tileStats.frameDecodes = 0;
+
+        skipFrame = skippedFrames < frameSkip;
+        skippedFrames = skipFrame ? skippedFrames + 1 : 0;
     }
     // 1 ~ 256: unused tile fetch
     else if (cycle == visibleCycle + 1)
-        resetHorizontalScroll();
+    {
+        if (renderingEnabled())
+            resetHorizontalScroll();
+    }
+    else if (cycle == visibleCycle + 2) // scanline 0 에는 스프라이트가 없음
+    {
+        soamCount = 0;
+        std::fill(std::begin(sprLine), std::end(sprLine), 0);
+    }
+    else if (cycle == 260)
+    {
+        if (renderingEnabled())
+            scanlineCounter();
+    }
     else if (280 == cycle) // 280-304
-        resetVerticalScroll();
+    {
+        if (renderingEnabled())
+            resetVerticalScroll();
+    }
     else if (cycle == 321)
-        loadBgShiftersForNextScanline();
-    else if (cycle >= endCycle - (oddFrame))
+    {
+        if (renderingEnabled())
+            loadBgShiftersForNextScanline();
+    }
+    else if (cycle >= endCycle - oddFrame)
     {
         pipelineState = VisibleRender;
         cycle = -1;
@@ -127,20 +413,33 @@ void PPU::visibleRender()
     if (cycle <= visibleCycle)
         renderPixel();
     else if (cycle == visibleCycle + 1)
-        resetHorizontalScroll();
+    {
+        if (renderingEnabled())
+            resetHorizontalScroll();
+    }
     else if (cycle == visibleCycle + 2)
     {
-        sprShifters = soam;
+        renderSpriteLine(scanline);
+    }
+    else if (cycle == 260)
+    {
+        if (renderingEnabled())
+            scanlineCounter();
     }
     else if (cycle == 321) // 321 ~ 336
     {
-        loadBgShiftersForNextScanline();
+        if (renderingEnabled())
+            loadBgShiftersForNextScanline();
     }
     else if (cycle >= endCycle)
     {
         cycle = -1;
         if (++scanline >= visibleScanlines)
+        {
             pipelineState = PostRender;
+            if (!skipFrame)
+                frameBuffer.present();
+        }
     }
 }
 
@@ -181,11 +480,39 @@ void PPU::renderPixel()
     if (scanline == 0 && cycle <= 16)
     {
         // 16이 될 때까지 그리지 않음
-        if (cycle == 16)
+        if (cycle == 16 && renderingEnabled())
             loadBgShiftersForNextScanline();
         return;
     }
 
+    int x = cycle - 1;
+    int y = scanline;
+
+    // 건너뛰는 프레임: 줄의 첫 픽셀에서 sprite 0 hit 위치만 구하고 픽셀은 만들지 않음
+    // (쉬프터는 cycle 321 에 다시 채워지므로 건드리지 않고, v 만 타일 경계에서 증가)
+    if (skipFrame)
+    {
+        int start = (y == 0) ? 16 : 0;
+        if (x == start)
+            sprZeroHitX = findSpriteZeroHit(start);
+        if (x == sprZeroHitX && enableBgRendering && enableSprRendering)
+            sprZeroHit = true;
+        if (enableBgRendering && (x + this->x) % 8 == 7)
+            incrementHoriV();
+    }
+    else
+        renderVisiblePixel(x, y);
+
+    // sprite evaluation
+    if (cycle == 65)
+        evaluateSprites(y);
+
+    if (cycle == visibleCycle && renderingEnabled())
+        incrementVertV();
+}
+
+void PPU::renderVisiblePixel(int x, int y)
+{
     uint8_t bgPixel = 0;
     uint8_t sprPixel = 0;
 
@@ -193,9 +520,6 @@ void PPU::renderPixel()
     bool sprOpaque = false;
     bool sprForeground = false;
 
-    int x = cycle - 1;
-    int y = scanline;
-
     if (enableBgRendering)
     {
         renderBackgroundPixel(bgPixel, bgOpaque);
@@ -208,19 +532,114 @@ void PPU::renderPixel()
 
     if (enableSprRendering) //  && x > 7
     {
-        renderSpritePixel(x, y, bgOpaque, sprPixel, sprOpaque, sprForeground);
+        renderSpritePixel(x, bgOpaque, sprPixel, sprOpaque, sprForeground);
     }
 
     // palette의 idx (< 32)
-    uint8_t pixel = compositePixel(x, y, bgPixel, sprPixel, bgOpaque, sprOpaque, sprForeground);
-    pBuffer[x][y] = colors[palette[pixel]];
+    uint8_t pixel = compositePixel(bgPixel, sprPixel, bgOpaque, sprOpaque, sprForeground);
+    // 색 번호만 기록 (RGBA 변환은 프레임을 읽는 쪽에서)
+    frameBuffer.backRow(y)[x] = palette[pixel] & (graycale ? 0x30 : 0x3F);
+    frameBuffer.setBackEmphasis(y, emphasizeRGB);
+}
 
-    // sprite evaluation
-    if (cycle == 65)
-        evaluateSprites(y);
+// 렌더링이 꺼져 있으면 v 를 건드리지 않음 (그동안 CPU 가 $2006/$2007 로 VRAM 에 접근)
+bool PPU::renderingEnabled() const
+{
+    return enableBgRendering || enableSprRendering;
+}
 
-    if (cycle == visibleCycle)
-        incrementVertV();
+/*
+ * visible scanline 하나(cycle 0 ~ 340)를 한 번에 처리 (render() 를 341번 호출한 것과 같은 결과)
+ * - 줄 중간에 레지스터가 바뀌지 않으므로 배경을 디코딩된 타일 행으로 한 줄 그린 뒤 스프라이트 라인 버퍼와 합성
+ * - bgLine: 배경 픽셀 (팔레트 << 2 | 픽셀), x = start 부터
+ */
+void PPU::renderScanline()
+{
+    int y = scanline;
+    int start = 0;
+    if (scanline == 0) // 16 dot 까지 그리지 않음
+    {
+        if (renderingEnabled())
+            loadBgShiftersForNextScanline();
+        start = 16;
+    }
+
+    if (!skipFrame)
+        renderLinePixels(y, start);
+    else if (findSpriteZeroHit(start) >= 0 && enableBgRendering && enableSprRendering)
+        sprZeroHit = true;
+
+    evaluateSprites(y); // cycle 65
+    if (renderingEnabled())
+    {
+        incrementVertV();        // cycle 256
+        resetHorizontalScroll(); // cycle 257
+    }
+    renderSpriteLine(y); // cycle 258
+    if (renderingEnabled())
+    {
+        scanlineCounter();               // cycle 260
+        loadBgShiftersForNextScanline(); // cycle 321
+    }
+
+    // cycle 340
+    cycle = 0;
+    if (++scanline >= visibleScanlines)
+    {
+        pipelineState = PostRender;
+        if (!skipFrame)
+            frameBuffer.present();
+    }
+}
+
+// x = start ~ 255 의 픽셀을 만들어 back 프레임에 기록
+void PPU::renderLinePixels(int y, int start)
+{
+    /*
+     * 배경: 쉬프터에 이미 들어 있는 두 타일은 bitplane 을 디코딩하고, 8픽셀마다 읽는 타일은 타일 캐시의 행에 팔레트를 더함
+     * - 쉬프터는 fineX 만큼 밀려 있으므로 되돌려서 타일 경계에 맞추고, bgLine[x - start + fineX] 가 x 의 픽셀
+     * - 이 줄의 쉬프터 값과 수평 v 는 cycle 257/321 에서 다시 정해지므로 갱신하지 않음
+     */
+    const PixelKernels &kernels = pixelKernels();
+    uint8_t bgLine[34 * 8] = {};
+    if (enableBgRendering)
+    {
+        uint8_t low[2], high[2], attributes[2];
+        uint16_t shifterLow = bgShifterLow >> this->x;
+        uint16_t shifterHigh = bgShifterHigh >> this->x;
+        low[0] = shifterLow >> 8;
+        high[0] = shifterHigh >> 8;
+        attributes[0] = (bgPaletteShifter >> 2) & 0x03;
+        low[1] = shifterLow & 0xFF;
+        high[1] = shifterHigh & 0xFF;
+        attributes[1] = bgPaletteShifter & 0x03;
+        kernels.decodeRows(low, high, attributes, 2, bgLine, false);
+
+        int tiles = (256 - start + this->x + 7) / 8;
+        uint8_t fineY = (v >> 12) & 0x07;
+        for (int i = 2; i < tiles; ++i)
+        {
+            uint16_t tileAddr = bgPTAddr + fetchNameTableData() * 16 + fineY;
+            uint64_t attribute = (fetchAttributeTableData() & 0x03) << 2;
+            uint64_t row;
+            std::memcpy(&row, tileRow(tileAddr), sizeof(row));
+            row |= attribute * 0x0101010101010101ull; // decodeRows 와 같이 8픽셀 모두 attribute << 2
+            std::memcpy(&bgLine[i * 8], &row, sizeof(row));
+            incrementHoriV();
+        }
+    }
+
+    static const uint8_t noSprites[256] = {};
+    const uint8_t *sprites = enableSprRendering ? sprLine : noSprites;
+
+    uint8_t pixels[256];
+    if (kernels.composite(bgLine + this->x, sprites + start, pixels, 256 - start))
+        sprZeroHit = true;
+    uint8_t *row = frameBuffer.backRow(y);
+    uint8_t colorMask = graycale ? 0x30 : 0x3F;
+    for (int x = start; x < 256; ++x)
+        row[x] = palette[pixels[x - start]] & colorMask;
+    frameBuffer.setBackEmphasis(y, emphasizeRGB);
 }
 
 void PPU::renderBackgroundPixel(uint8_t &bgPixel, bool &bgOpaque)
@@ -240,67 +659,58 @@ void PPU::renderBackgroundPixel(uint8_t &bgPixel, bool &bgOpaque)
     bgShifterHigh <<= 1;
 }
 
-void PPU::renderSpritePixel(int x, int y, bool bgOpaque, uint8_t &sprPixel, bool &sprOpaque, bool &sprForeground)
+// 라인 버퍼에서 한 픽셀 (renderSpriteLine() 에서 미리 그려 둠)
+void PPU::renderSpritePixel(int x, bool bgOpaque, uint8_t &sprPixel, bool &sprOpaque, bool &sprForeground)
 {
-    /**
-     * spr:
-     * - [31:24] X좌표
-     * - [23:16] 속성(attribute) (하위 2 비트: 팔레트, 그 외 비트: 수직/수평 플립, 우선순위)
-     * - [15:8]  타일번호(tile)
-     * - [7:0]   Y좌표
-     */
-    for (uint8_t sprIdx : sprShifters)
-    {
-        uint32_t spr = oam[sprIdx];
-        uint8_t spry = static_cast<uint8_t>((spr >> 0) & 0xFF);
-        uint8_t tile = static_cast<uint8_t>((spr >> 8) & 0xFF);
-        uint8_t attr = static_cast<uint8_t>((spr >> 16) & 0xFF);
-        uint8_t sprx = static_cast<uint8_t>((spr >> 24) & 0xFF);
-
-        int xOffset = x - sprx;
-        int yOffset = y - spry;
-
-        if (xOffset < 0 || xOffset > 7)
-            continue;
-        if (yOffset < 0 || yOffset >= sprSize)
-            continue;
-
-        bool flipVertical = attr & 0x80;
-        bool flipHorizontal = attr & 0x40;
-        bool behindBG = attr & 0x20; // Priority
-        uint8_t paletteIdx = attr & 0x03;
-
-        int tileY = flipVertical ? (sprSize - 1 - yOffset) : yOffset;
-        int tileX = flipHorizontal ? xOffset : (7 - xOffset);
-
-        uint16_t tilePTAddr;
-        if (sprSize == 16) // 8x16 스프라이트 처리
-        {
-            // TODO
-        }
-        else
-            tilePTAddr = sprPTAddr + (tile * 16) + tileY;
-
-        // fetch pt low-plain / high-plain
-        uint8_t pixel = fetchPatternTablePixelData(tilePTAddr, tileX);
+    uint8_t spr = sprLine[x];
+    if (!(sprOpaque = (spr != 0)))
+        return;
 
-        if (!(sprOpaque = (pixel != 0)))
-            continue;
+    sprPixel = spr & 0x1F;
+    sprForeground = spr & 0x20;
 
-        sprPixel = 0x10 | (paletteIdx << 2) | (pixel & 0x03);
-        sprForeground = !behindBG;
+    // set sprite zero hit flag
+    // - true: spr가 0이고 현재 pixel이 0이 아니어야 함 + 배경 역시 불투명하고 렌더링 가능해야 함.
+    if ((spr & 0x40) && bgOpaque && enableBgRendering)
+        sprZeroHit = true;
+}
 
-        // set sprite zero hit flag
-        // - true: spr가 0이고 현재 pixel이 0이 아니어야 함 + 배경 역시 불투명하고 렌더링 가능해야 함.
-        if (sprIdx == 0 && bgOpaque && enableBgRendering)
-            sprZeroHit = true;
+/*
+ * 건너뛰는 프레임의 sprite 0 hit: 스프라이트 0 의 8픽셀 중 배경도 불투명한 첫 x (없으면 -1)
+ * - 줄을 그리기 전(쉬프터, v 가 줄 시작 상태)에 호출
+ */
+int PPU::findSpriteZeroHit(int start)
+{
+    if (!sprZeroInLine)
+        return -1;
+    int sprx = oam[3];
+    for (int x = std::max(sprx, start); x < std::min(sprx + 8, 256); ++x)
+        if ((sprLine[x] & 0x40) && bgOpaqueAt(x, start))
+            return x;
+    return -1;
+}
 
-        // priority: 가장 낮은 인덱스를 그린다.
-        return;
+// 줄 시작 상태에서 x 의 배경 픽셀이 불투명한지 (renderLinePixels() 의 bgLine 과 같은 위치 계산)
+bool PPU::bgOpaqueAt(int x, int start)
+{
+    int position = x - start + this->x;
+    int tile = position / 8;
+    int bit = 7 - position % 8;
+    if (tile < 2) // 쉬프터에 들어 있는 두 타일
+    {
+        int shift = this->x + (tile == 0 ? 8 : 0) + bit;
+        return ((bgShifterLow | bgShifterHigh) >> shift) & 0x01;
     }
+
+    uint16_t lineV = v;
+    for (int i = 2; i < tile; ++i)
+        incrementHoriV();
+    uint16_t tileAddr = bgPTAddr + fetchNameTableData() * 16 + ((v >> 12) & 0x07);
+    v = lineV;
+    return tileRow(tileAddr)[7 - bit] != 0;
 }
 
-uint8_t PPU::compositePixel(int x, int y, uint8_t bgPixel, uint8_t sprPixel, bool bgOpaque, bool sprOpaque, bool sprForeground)
+uint8_t PPU::compositePixel(uint8_t bgPixel, uint8_t sprPixel, bool bgOpaque, bool sprOpaque, bool sprForeground)
 {
     if (!bgOpaque && !sprOpaque)
         return 0;
@@ -325,11 +735,7 @@ uint8_t PPU::compositePixel(int x, int y, uint8_t bgPixel, uint8_t sprPixel, boo
 uint8_t PPU::fetchPatternTablePixelData(uint16_t ptAddr, uint8_t tileX)
 {
     // uint16_t ptAddr = bgPTAddr + tile * 16 + tileY;
-    uint8_t ptLow = read(ptAddr);
-    uint8_t ptHigh = read(ptAddr + 8);
-    uint8_t lowBit = ((ptLow >> tileX) & 1) & 0x01;
-    uint8_t highBit = ((ptLow >> tileX) & 1) & 0x01;
-    return (highBit << 1) | lowBit;
+    return tileRow(ptAddr)[7 - tileX]; // tileX: 비트 위치 (7 이 왼쪽 픽셀)
 }
 
 uint8_t PPU::fetchNameTableData()
@@ -338,7 +744,7 @@ uint8_t PPU::fetchNameTableData()
     return read(ntAddr);
 }
 
-uint8_t PPU::fetchAttributeTableData(int tileX = -1, int tileY = -1)
+uint8_t PPU::fetchAttributeTableData(int tileX, int tileY)
 {
     uint16_t attrBase = 0x23C0 | (v & 0x0C00);
     int x = (tileX != -1) ? tileX : v & 0x001F;
@@ -355,6 +761,7 @@ uint8_t PPU::fetchAttributeTableData(int tileX = -1, int tileY = -1)
     return paletteIdx;
 }
 
+// 쉬프터는 bitplane 을 그대로 담으므로 (dot 렌더러가 한 비트씩 밀어냄) 타일 캐시 대신 CHR 을 직접 읽음
 void PPU::loadBgShiftersForNextScanline()
 {
     uint8_t fineY = (v >> 12) & 0x07;
@@ -365,10 +772,10 @@ void PPU::loadBgShiftersForNextScanline()
     uint16_t tile1Addr = bgPTAddr + tile1 * 16 + fineY;
     uint16_t tile2Addr = bgPTAddr + tile2 * 16 + fineY;
 
-    uint8_t ptLow1 = read(tile1Addr);
-    uint8_t ptHigh1 = read(tile1Addr + 8);
-    uint8_t ptLow2 = read(tile2Addr);
-    uint8_t ptHigh2 = read(tile2Addr + 8);
+    uint8_t ptLow1 = chrByte(tile1Addr);
+    uint8_t ptHigh1 = chrByte(tile1Addr + 8);
+    uint8_t ptLow2 = chrByte(tile2Addr);
+    uint8_t ptHigh2 = chrByte(tile2Addr + 8);
 
     bgShifterLow = (ptLow1 << 8) | ptLow2;
     bgShifterHigh = (ptHigh1 << 8) | ptHigh2;
@@ -389,10 +796,10 @@ void PPU::loadNextTileIntoShifters()
 {
     uint8_t tile = fetchNameTableData();
     uint8_t paletteIdx = fetchAttributeTableData() & 0x03;
-    uint16_t tileAddr = bgPTAddr + tile * 16 + (v >> 12) & 0x07;
+    uint16_t tileAddr = bgPTAddr + tile * 16 + ((v >> 12) & 0x07);
 
-    uint8_t ptLow = read(tileAddr);
-    uint8_t ptHigh = read(tileAddr + 8);
+    uint8_t ptLow = chrByte(tileAddr);
+    uint8_t ptHigh = chrByte(tileAddr + 8);
 
     bgShifterLow |= ptLow;
     bgShifterHigh |= ptHigh;
@@ -403,23 +810,69 @@ void PPU::loadNextTileIntoShifters()
 
 void PPU::evaluateSprites(int y)
 {
-    soam.resize(0);
-    uint8_t cnt = 0;
+    soamCount = 0;
     for (uint8_t sprIdx = oamAddr / 4; sprIdx < 64; ++sprIdx)
     {
-        uint8_t spry = static_cast<uint8_t>(oam[sprIdx] & 0xFF);
+        uint8_t spry = oam[sprIdx * 4];
         int yOffset = y - spry;
 
         if (yOffset < 0 || yOffset >= sprSize)
             continue;
 
-        if (cnt >= 8)
+        if (soamCount >= 8)
         {
             spriteOverflow = true;
             break;
         }
-        soam.push_back(sprIdx);
-        ++cnt;
+        soam[soamCount++] = sprIdx;
+    }
+}
+
+/*
+ * evaluation 으로 고른 스프라이트(최대 8개)를 라인 버퍼에 그림 (cycle 258, 다음 줄에 표시)
+ * - y 는 evaluation 한 줄: 스프라이트는 OAM 의 y 보다 한 줄 아래에 나타남
+ *
+ * spr:
+ * - [0] Y좌표
+ * - [1] 타일번호(tile) (8x16 이면 bit 0 이 패턴 테이블, 나머지가 위쪽 타일)
+ * - [2] 속성(attribute) (하위 2 비트: 팔레트, 0x20: 배경 뒤, 0x40: 좌우 반전, 0x80: 상하 반전)
+ * - [3] X좌표
+ */
+void PPU::renderSpriteLine(int y)
+{
+    std::fill(std::begin(sprLine), std::end(sprLine), 0);
+    sprZeroInLine = soamCount > 0 && soam[0] == 0;
+
+    // 건너뛰는 프레임은 sprite 0 hit 에 필요한 스프라이트 0 만
+    int count = skipFrame ? (sprZeroInLine ? 1 : 0) : soamCount;
+    for (int i = 0; i < count; ++i)
+    {
+        uint8_t sprIdx = soam[i];
+        const uint8_t *spr = &oam[sprIdx * 4];
+        uint8_t spry = spr[0];
+        uint8_t tile = spr[1];
+        uint8_t attr = spr[2];
+        uint8_t sprx = spr[3];
+
+        int yOffset = y - spry;
+        int tileY = (attr & 0x80) ? (sprSize - 1 - yOffset) : yOffset;
+
+        uint16_t tilePTAddr;
+        if (sprSize == 16) // 8x16: 위/아래 두 타일
+            tilePTAddr = ((tile & 0x01) << 12) + ((tile & 0xFE) + (tileY >> 3)) * 16 + (tileY & 0x07);
+        else
+            tilePTAddr = sprPTAddr + (tile * 16) + tileY;
+
+        const uint8_t *row = (attr & 0x40) ? flippedTileRow(tilePTAddr) : tileRow(tilePTAddr);
+        uint8_t flags = 0x10 | ((attr & 0x03) << 2) | ((attr & 0x20) ? 0 : 0x20) | (sprIdx == 0 ? 0x40 : 0);
+
+        int width = std::min(8, 256 - sprx);
+        for (int xOffset = 0; xOffset < width; ++xOffset)
+        {
+            // 인덱스가 낮은 스프라이트가 우선 (먼저 그린 불투명 픽셀을 덮지 않음)
+            if (row[xOffset] != 0 && sprLine[sprx + xOffset] == 0)
+                sprLine[sprx + xOffset] = flags | row[xOffset];
+        }
     }
 }
 
@@ -511,3 +964,140 @@ void PPU::resetVerticalScroll()
 //     uint16_t ptAddr = bgPTAddr + tile * 16 + fineY + 8;
 //     return (read(ptAddr) >> (7 - tileX)) & 0x01;
 // }
+
+// save state
+void PPU::saveState(StateWriter &writer) const
+{
+    writer.section("PPU ", stateVersion);
+
+    writer.write16(baseNTAddr);
+    writer.write8(vIncrement);
+    writer.write16(sprPTAddr);
+    writer.write16(bgPTAddr);
+    writer.write8(sprSize);
+    writer.writeBool(masterSlave);
+    writer.writeBool(enableVblankNMI);
+
+    writer.writeBool(graycale);
+    writer.writeBool(showBgInLeftmost);
+    writer.writeBool(showSprInLeftmost);
+    writer.writeBool(enableBgRendering);
+    writer.writeBool(enableSprRendering);
+    writer.write8(emphasizeRGB);
+
+    writer.writeBool(spriteOverflow);
+    writer.writeBool(sprZeroHit);
+    writer.writeBool(vblankFlag);
+    writer.write8(readBuffer);
+
+    writer.write8(oamAddr);
+    writer.vector(oam);
+    writer.write8(soamCount);
+    writer.bytes(soam, sizeof(soam));
+    writer.bytes(sprLine, sizeof(sprLine));
+
+    writer.write16(v);
+    writer.write16(t);
+    writer.write8(x);
+    writer.writeBool(w);
+
+    writer.write32(cycle);
+    writer.write32(scanline);
+    writer.writeBool(oddFrame);
+
+    writer.write16(bgShifterLow);
+    writer.write16(bgShifterHigh);
+    writer.write8(bgPaletteShifter);
+    writer.write8(pipelineState);
+
+    writer.vector(palette);
+    writer.bytes(chr.data(), chr.size());
+    writer.vector(vram);
+    writer.write8(static_cast<uint8_t>(mirroring));
+    writer.write32(pendingDots);
+
+    writer.write32(frameSkip);
+    writer.write32(skippedFrames);
+    writer.writeBool(skipFrame);
+    writer.writeBool(sprZeroInLine);
+    writer.write32(static_cast<uint32_t>(sprZeroHitX));
+}
+
+bool PPU::loadState(StateReader &reader)
+{
+    if (!reader.section("PPU ", stateVersion))
+        return false;
+
+    baseNTAddr = reader.read16();
+    vIncrement = reader.read8();
+    sprPTAddr = reader.read16();
+    bgPTAddr = reader.read16();
+    sprSize = reader.read8();
+    masterSlave = reader.readBool();
+    enableVblankNMI = reader.readBool();
+
+    graycale = reader.readBool();
+    showBgInLeftmost = reader.readBool();
+    showSprInLeftmost = reader.readBool();
+    enableBgRendering = reader.readBool();
+    enableSprRendering = reader.readBool();
+    emphasizeRGB = reader.read8();
+
+    spriteOverflow = reader.readBool();
+    sprZeroHit = reader.readBool();
+    vblankFlag = reader.readBool();
+    readBuffer = reader.read8();
+
+    oamAddr = reader.read8();
+    reader.vector(oam);
+    soamCount = std::min<uint8_t>(reader.read8(), 8);
+    reader.bytes(soam, sizeof(soam));
+    reader.bytes(sprLine, sizeof(sprLine));
+
+    v = reader.read16();
+    t = reader.read16();
+    x = reader.read8();
+    w = reader.readBool();
+
+    cycle = reader.read32();
+    scanline = reader.read32();
+    oddFrame = reader.readBool();
+
+    bgShifterLow = reader.read16();
+    bgShifterHigh = reader.read16();
+    bgPaletteShifter = reader.read8();
+    uint8_t state = reader.read8();
+    pipelineState = static_cast<PipelineState>(std::min<uint8_t>(state, VBlank));
+
+    reader.vector(palette);
+    reader.bytes(chr.data(), chr.size());
+    reader.vector(vram);
+    mirroring = static_cast<Mirroring>(reader.read8());
+    pendingDots = reader.read32();
+
+    frameSkip = reader.read32();
+    skippedFrames = reader.read32();
+    skipFrame = reader.readBool();
+    sprZeroInLine = reader.readBool();
+    sprZeroHitX = static_cast<int32_t>(reader.read32());
+    invalidateTiles();
+
+    // 범위를 벗어난 위치는 프레임 버퍼나 scanline 테이블 밖을 가리키므로 거부
+    if (state > VBlank || cycle > endCycle || scanline > 261 ||
+        (pipelineState == VisibleRender && scanline >= visibleScanlines) || pendingDots >= scanlineDots)
+        return false;
+    return reader.ok;
+}
+
+void PPU::saveState(std::vector<uint8_t> &buffer) const
+{
+    buffer.clear();
+    StateWriter writer(buffer);
+    saveState(writer);
+}
+
+bool PPU::loadState(const std::vector<uint8_t> &buffer)
+{
+    StateReader reader(buffer);
+    return loadState(reader);
+}
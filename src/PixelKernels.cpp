@@ -0,0 +1,283 @@
+#include "PixelKernels.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PIXEL_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+// scalar (기준 구현)
+static void decodeRowsScalar(const uint8_t *low, const uint8_t *high, const uint8_t *attributes, size_t rows,
+                             uint8_t *out, bool flip)
+{
+    for (size_t row = 0; row < rows; ++row)
+    {
+        uint8_t attribute = attributes ? (attributes[row] << 2) : 0;
+        for (int column = 0; column < 8; ++column)
+        {
+            int bit = flip ? column : 7 - column;
+            out[row * 8 + column] = attribute | (((high[row] >> bit) & 0x01) << 1) | ((low[row] >> bit) & 0x01);
+        }
+    }
+}
+
+static bool compositeScalar(const uint8_t *bg, const uint8_t *sprite, uint8_t *out, size_t count)
+{
+    bool hit = false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        bool bgOpaque = bg[i] != 0;
+        bool spriteOpaque = sprite[i] != 0;
+        hit |= bgOpaque && (sprite[i] & 0x40);
+        out[i] = (spriteOpaque && (!bgOpaque || (sprite[i] & 0x20))) ? (sprite[i] & 0x1F) : bg[i];
+    }
+    return hit;
+}
+
+static void indicesToRGBAScalar(const uint8_t *indices, const uint32_t *palette, uint32_t *out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = palette[indices[i] & 0x3F];
+}
+
+static uint32_t diffBlocksScalar(const uint8_t *a, const uint8_t *b, size_t blocks)
+{
+    uint32_t mask = 0;
+    for (size_t i = 0; i < blocks; ++i)
+    {
+        uint64_t lhs, rhs;
+        std::memcpy(&lhs, a + i * 8, 8);
+        std::memcpy(&rhs, b + i * 8, 8);
+        mask |= static_cast<uint32_t>(lhs != rhs) << i;
+    }
+    return mask;
+}
+
+static const PixelKernels scalarKernels = {"scalar", decodeRowsScalar, compositeScalar, indicesToRGBAScalar,
+                                           diffBlocksScalar};
+
+#ifdef PIXEL_KERNELS_X86
+
+// SSE2: 2행(16픽셀)씩
+__attribute__((target("sse2"))) static __m128i broadcastRows2(const uint8_t *bytes)
+{
+    __m128i value = _mm_cvtsi32_si128(bytes[0] | (bytes[1] << 8));
+    value = _mm_unpacklo_epi8(value, value);    // b0 b0 b1 b1
+    value = _mm_unpacklo_epi16(value, value);   // b0 x4, b1 x4
+    return _mm_unpacklo_epi32(value, value);    // b0 x8, b1 x8
+}
+
+__attribute__((target("sse2"))) static void decodeRowsSSE2(const uint8_t *low, const uint8_t *high,
+                                                           const uint8_t *attributes, size_t rows, uint8_t *out,
+                                                           bool flip)
+{
+    const __m128i mask = flip ? _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1)
+                              : _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+
+    size_t row = 0;
+    for (; row + 2 <= rows; row += 2)
+    {
+        __m128i lowBits = _mm_cmpeq_epi8(_mm_and_si128(broadcastRows2(low + row), mask), mask);
+        __m128i highBits = _mm_cmpeq_epi8(_mm_and_si128(broadcastRows2(high + row), mask), mask);
+        __m128i pixels = _mm_or_si128(_mm_and_si128(lowBits, one), _mm_and_si128(highBits, two));
+        if (attributes)
+        {
+            __m128i attribute = broadcastRows2(attributes + row);
+            pixels = _mm_or_si128(pixels, _mm_slli_epi16(_mm_and_si128(attribute, _mm_set1_epi8(0x3F)), 2));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + row * 8), pixels);
+    }
+    decodeRowsScalar(low + row, high + row, attributes ? attributes + row : nullptr, rows - row, out + row * 8, flip);
+}
+
+__attribute__((target("sse2"))) static bool compositeSSE2(const uint8_t *bg, const uint8_t *sprite, uint8_t *out,
+                                                          size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i front = _mm_set1_epi8(0x20);
+    const __m128i spriteZero = _mm_set1_epi8(0x40);
+    const __m128i pixelMask = _mm_set1_epi8(0x1F);
+
+    __m128i hit = zero;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bg + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sprite + i));
+        __m128i bgClear = _mm_cmpeq_epi8(b, zero);
+        __m128i spriteClear = _mm_cmpeq_epi8(s, zero);
+        __m128i isFront = _mm_cmpeq_epi8(_mm_and_si128(s, front), front);
+
+        // 스프라이트가 불투명하고 (배경이 투명하거나 스프라이트가 앞) 이면 스프라이트
+        __m128i useSprite = _mm_andnot_si128(spriteClear, _mm_or_si128(bgClear, isFront));
+        __m128i pixels = _mm_or_si128(_mm_and_si128(useSprite, _mm_and_si128(s, pixelMask)),
+                                      _mm_andnot_si128(useSprite, b));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), pixels);
+
+        hit = _mm_or_si128(hit, _mm_andnot_si128(bgClear, _mm_cmpeq_epi8(_mm_and_si128(s, spriteZero), spriteZero)));
+    }
+    bool tail = compositeScalar(bg + i, sprite + i, out + i, count - i);
+    return _mm_movemask_epi8(hit) != 0 || tail;
+}
+
+// 16바이트(2블록)씩 비교, 같은 바이트의 마스크가 8비트 모두 1 이 아니면 그 블록이 다름
+__attribute__((target("sse2"))) static uint32_t diffBlocksSSE2(const uint8_t *a, const uint8_t *b, size_t blocks)
+{
+    uint32_t mask = 0;
+    size_t i = 0;
+    for (; i + 2 <= blocks; i += 2)
+    {
+        __m128i lhs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i * 8));
+        __m128i rhs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i * 8));
+        uint32_t equal = _mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs));
+        mask |= (((equal & 0xFF) != 0xFF) | (((equal >> 8) != 0xFF) << 1)) << i;
+    }
+    return mask | (diffBlocksScalar(a + i * 8, b + i * 8, blocks - i) << i);
+}
+
+// SSE2 에는 gather 가 없으므로 색 변환은 scalar 를 그대로 사용
+static const PixelKernels sse2Kernels = {"sse2", decodeRowsSSE2, compositeSSE2, indicesToRGBAScalar, diffBlocksSSE2};
+
+// AVX2: 4행(32픽셀)씩
+__attribute__((target("avx2"))) static __m256i broadcastRows4(const uint8_t *bytes)
+{
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    // 128비트 lane 안에서만 섞이므로 lane 0 은 b0/b1, lane 1 은 b2/b3
+    const __m256i index = _mm256_set_epi8(3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 0,
+                                          0, 0, 0, 0, 0, 0, 0);
+    return _mm256_shuffle_epi8(_mm256_set1_epi32(value), index);
+}
+
+__attribute__((target("avx2"))) static void decodeRowsAVX2(const uint8_t *low, const uint8_t *high,
+                                                           const uint8_t *attributes, size_t rows, uint8_t *out,
+                                                           bool flip)
+{
+    const __m256i mask =
+        flip ? _mm256_set1_epi64x(0x8040201008040201ll) : _mm256_set1_epi64x(0x0102040810204080ll);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi8(2);
+
+    size_t row = 0;
+    for (; row + 4 <= rows; row += 4)
+    {
+        __m256i lowBits = _mm256_cmpeq_epi8(_mm256_and_si256(broadcastRows4(low + row), mask), mask);
+        __m256i highBits = _mm256_cmpeq_epi8(_mm256_and_si256(broadcastRows4(high + row), mask), mask);
+        __m256i pixels = _mm256_or_si256(_mm256_and_si256(lowBits, one), _mm256_and_si256(highBits, two));
+        if (attributes)
+        {
+            __m256i attribute = _mm256_and_si256(broadcastRows4(attributes + row), _mm256_set1_epi8(0x3F));
+            pixels = _mm256_or_si256(pixels, _mm256_slli_epi16(attribute, 2));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + row * 8), pixels);
+    }
+    decodeRowsSSE2(low + row, high + row, attributes ? attributes + row : nullptr, rows - row, out + row * 8, flip);
+}
+
+__attribute__((target("avx2"))) static bool compositeAVX2(const uint8_t *bg, const uint8_t *sprite, uint8_t *out,
+                                                          size_t count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i front = _mm256_set1_epi8(0x20);
+    const __m256i spriteZero = _mm256_set1_epi8(0x40);
+    const __m256i pixelMask = _mm256_set1_epi8(0x1F);
+
+    __m256i hit = zero;
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bg + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sprite + i));
+        __m256i bgClear = _mm256_cmpeq_epi8(b, zero);
+        __m256i spriteClear = _mm256_cmpeq_epi8(s, zero);
+        __m256i isFront = _mm256_cmpeq_epi8(_mm256_and_si256(s, front), front);
+
+        __m256i useSprite = _mm256_andnot_si256(spriteClear, _mm256_or_si256(bgClear, isFront));
+        __m256i pixels = _mm256_blendv_epi8(b, _mm256_and_si256(s, pixelMask), useSprite);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), pixels);
+
+        hit = _mm256_or_si256(hit, _mm256_andnot_si256(
+                                       bgClear, _mm256_cmpeq_epi8(_mm256_and_si256(s, spriteZero), spriteZero)));
+    }
+    bool tail = compositeSSE2(bg + i, sprite + i, out + i, count - i);
+    return _mm256_movemask_epi8(hit) != 0 || tail;
+}
+
+// 8픽셀씩 색 번호를 32비트로 넓혀 gather
+__attribute__((target("avx2"))) static void indicesToRGBAAVX2(const uint8_t *indices, const uint32_t *palette,
+                                                              uint32_t *out, size_t count)
+{
+    const __m256i colorMask = _mm256_set1_epi32(0x3F);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(indices + i));
+        __m256i index = _mm256_and_si256(_mm256_cvtepu8_epi32(bytes), colorMask);
+        __m256i rgba = _mm256_i32gather_epi32(reinterpret_cast<const int *>(palette), index, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), rgba);
+    }
+    indicesToRGBAScalar(indices + i, palette, out + i, count - i);
+}
+
+// 32바이트(4블록)씩 64비트 단위로 비교해 블록 마스크를 바로 얻음
+__attribute__((target("avx2"))) static uint32_t diffBlocksAVX2(const uint8_t *a, const uint8_t *b, size_t blocks)
+{
+    uint32_t mask = 0;
+    size_t i = 0;
+    for (; i + 4 <= blocks; i += 4)
+    {
+        __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i * 8));
+        __m256i rhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i * 8));
+        uint32_t equal = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lhs, rhs)));
+        mask |= (~equal & 0x0F) << i;
+    }
+    return mask | (diffBlocksScalar(a + i * 8, b + i * 8, blocks - i) << i);
+}
+
+static const PixelKernels avx2Kernels = {"avx2", decodeRowsAVX2, compositeAVX2, indicesToRGBAAVX2, diffBlocksAVX2};
+
+#endif
+
+const PixelKernels *scalarPixelKernels()
+{
+    return &scalarKernels;
+}
+
+const PixelKernels *sse2PixelKernels()
+{
+#ifdef PIXEL_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        return &sse2Kernels;
+#endif
+    return nullptr;
+}
+
+const PixelKernels *avx2PixelKernels()
+{
+#ifdef PIXEL_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return &avx2Kernels;
+#endif
+    return nullptr;
+}
+
+static const PixelKernels &selectKernels()
+{
+    if (const PixelKernels *kernels = avx2PixelKernels())
+        return *kernels;
+    if (const PixelKernels *kernels = sse2PixelKernels())
+        return *kernels;
+    return *scalarPixelKernels();
+}
+
+// 함수 안의 static 은 스레드 안전하게 한 번만 초기화됨
+const PixelKernels &pixelKernels()
+{
+    static const PixelKernels &selected = selectKernels();
+    return selected;
+}
@@ -0,0 +1,238 @@
+#include "Rewind.h"
+
+#include <cstring>
+
+static const size_t minZeroRun = 4; // 이보다 짧은 0 은 literal 에 포함
+
+static uint8_t *writeVarint(uint8_t *out, size_t value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+static size_t readVarint(const uint8_t *&data)
+{
+    size_t value = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        uint8_t byte = *data++;
+        value |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+}
+
+static uint64_t load64(const uint8_t *data)
+{
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static void store64(uint8_t *data, uint64_t value)
+{
+    std::memcpy(data, &value, sizeof(value));
+}
+
+// 8바이트 중 0 인 바이트가 있는지
+static bool hasZeroByte(uint64_t value)
+{
+    return (value - 0x0101010101010101ull) & ~value & 0x8080808080808080ull;
+}
+
+/*
+ * current ^ base 를 토큰으로 압축해 out 에 쓰고 쓴 바이트 수를 돌려줌 (XorBase = false 면 0 과의 XOR, 즉 current 그대로)
+ * - 같은 구간과 literal 구간 모두 8바이트 단위로 훑고, 경계 근처만 바이트 단위로 확인
+ */
+template <bool XorBase>
+static size_t encodeTokens(const uint8_t *current, const uint8_t *base, size_t size, uint8_t *out)
+{
+    auto diff = [&](size_t i) -> uint8_t { return XorBase ? current[i] ^ base[i] : current[i]; };
+    auto diff64 = [&](size_t i) { return XorBase ? load64(current + i) ^ load64(base + i) : load64(current + i); };
+
+    uint8_t *begin = out;
+    size_t i = 0;
+    while (i < size)
+    {
+        size_t zeroStart = i;
+        while (i + 8 <= size && diff64(i) == 0)
+            i += 8;
+        while (i < size && diff(i) == 0)
+            ++i;
+        size_t zeroCount = i - zeroStart;
+
+        // 0 이 minZeroRun 개 이상 이어지는 곳 (또는 끝까지 0) 에서 literal 을 끊음, 0 바이트가 없는 8바이트는 통째로 건너뜀
+        size_t literalStart = i;
+        while (i < size)
+        {
+            if (i + 8 <= size && !hasZeroByte(diff64(i)))
+            {
+                i += 8;
+                continue;
+            }
+            if (diff(i) != 0)
+            {
+                ++i;
+                continue;
+            }
+            size_t run = i + 1;
+            while (run < size && run - i < minZeroRun && diff(run) == 0)
+                ++run;
+            if (run - i >= minZeroRun || run == size)
+                break;
+            i = run;
+        }
+
+        out = writeVarint(out, zeroCount);
+        out = writeVarint(out, i - literalStart);
+        size_t j = literalStart;
+        for (; j + 8 <= i; j += 8, out += 8)
+            store64(out, diff64(j));
+        for (; j < i; ++j)
+            *out++ = diff(j);
+    }
+    return out - begin;
+}
+
+// state ^ base 를 토큰으로 압축 (base == nullptr 이면 0 과의 XOR), out 은 최대 크기로 한 번만 늘리고 쓴 바이트 수를 돌려줌
+static size_t encode(const std::vector<uint8_t> &state, const uint8_t *base, std::vector<uint8_t> &out)
+{
+    // 토큰은 (첫 토큰을 빼면) minZeroRun 개 이상의 0 으로 시작하고, varint 하나는 최대 10바이트
+    size_t bound = state.size() + (state.size() / minZeroRun + 1) * 20;
+    if (out.size() < bound)
+        out.resize(bound);
+    return base ? encodeTokens<true>(state.data(), base, state.size(), out.data())
+                : encodeTokens<false>(state.data(), nullptr, state.size(), out.data());
+}
+
+Rewind::Rewind(size_t capacity, size_t maxFrames, uint32_t keyframeInterval)
+    : storage(capacity), entries(maxFrames), keyframeInterval(keyframeInterval)
+{
+}
+
+void Rewind::clear()
+{
+    first = 0;
+    count = 0;
+    head = 0;
+}
+
+size_t Rewind::bytesUsed() const
+{
+    return count == 0 ? 0 : head - entry(0).position;
+}
+
+// 가장 오래된 keyframe 과 그에 딸린 delta 를 버림
+void Rewind::evictGroup()
+{
+    do
+    {
+        first = (first + 1) % entries.size();
+        --count;
+        ++stats.evicted;
+    } while (count > 0 && entry(0).sinceKeyframe != 0);
+}
+
+void Rewind::push(const std::vector<uint8_t> &state)
+{
+    const Entry *last = count > 0 ? &entry(count - 1) : nullptr;
+    bool isKeyframe = last == nullptr || last->sinceKeyframe + 1 >= keyframeInterval || state.size() != keyframe.size();
+
+    size_t length = 0;
+    for (;;)
+    {
+        length = encode(state, isKeyframe ? nullptr : keyframe.data(), encoded);
+        if (length > storage.size())
+        {
+            clear();
+            return;
+        }
+
+        // 링 끝에 들어가지 않으면 처음으로 (남는 부분은 버림)
+        uint64_t position = head;
+        if (position % storage.size() + length > storage.size())
+            position += storage.size() - position % storage.size();
+        while (count > 0 && (position + length - entry(0).position > storage.size() || count == entries.size()))
+            evictGroup();
+
+        // 현재 keyframe 까지 버렸으면 keyframe 으로 다시 압축
+        if (count == 0 && !isKeyframe)
+        {
+            isKeyframe = true;
+            continue;
+        }
+
+        std::memcpy(&storage[position % storage.size()], encoded.data(), length);
+        Entry &slot = entries[(first + count) % entries.size()];
+        slot.position = position;
+        slot.size = length;
+        slot.stateSize = state.size();
+        slot.sinceKeyframe = isKeyframe ? 0 : entry(count - 1).sinceKeyframe + 1;
+        ++count;
+        head = position + length;
+        break;
+    }
+
+    if (isKeyframe)
+    {
+        keyframe = state;
+        ++stats.keyframes;
+    }
+    ++stats.frames;
+    stats.encodedBytes += length;
+    stats.stateBytes += state.size();
+}
+
+// 토큰을 풀어 state 에 XOR
+void Rewind::apply(const Entry &entry, std::vector<uint8_t> &state) const
+{
+    const uint8_t *data = &storage[entry.position % storage.size()];
+    const uint8_t *end = data + entry.size;
+    size_t i = 0;
+    while (data < end)
+    {
+        i += readVarint(data);
+        size_t literalCount = readVarint(data);
+        for (size_t j = 0; j < literalCount; ++j)
+            state[i++] ^= *data++;
+    }
+}
+
+void Rewind::decode(size_t index, std::vector<uint8_t> &state) const
+{
+    const Entry &target = entry(index);
+    state.assign(target.stateSize, 0);
+    apply(entry(index - target.sinceKeyframe), state);
+    if (target.sinceKeyframe != 0)
+        apply(target, state);
+}
+
+bool Rewind::peek(size_t framesBack, std::vector<uint8_t> &state) const
+{
+    if (framesBack >= count)
+        return false;
+    decode(newest(framesBack), state);
+    return true;
+}
+
+bool Rewind::rewind(size_t framesBack, std::vector<uint8_t> &state)
+{
+    if (framesBack >= count)
+        return false;
+
+    size_t index = newest(framesBack);
+    const Entry &target = entry(index);
+    decode(index - target.sinceKeyframe, keyframe);
+    state = keyframe;
+    if (target.sinceKeyframe != 0)
+        apply(target, state);
+
+    count = index + 1;
+    head = target.position + target.size;
+    return true;
+}
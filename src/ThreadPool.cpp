@@ -0,0 +1,80 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct WorkQueue
+{
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+
+    bool popFront(size_t &task)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty())
+            return false;
+        task = tasks.front();
+        tasks.pop_front();
+        return true;
+    }
+
+    bool popBack(size_t &task)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty())
+            return false;
+        task = tasks.back();
+        tasks.pop_back();
+        return true;
+    }
+};
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads) : threadCount(threads)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ThreadPool::run(size_t count, const std::function<void(size_t)> &task)
+{
+    unsigned workers = std::min<size_t>(threadCount, std::max<size_t>(count, 1));
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    for (unsigned i = 0; i < workers; ++i)
+        queues.push_back(std::make_unique<WorkQueue>());
+    for (size_t i = 0; i < count; ++i)
+        queues[i % workers]->tasks.push_back(i);
+
+    auto worker = [&](unsigned self) {
+        size_t index;
+        for (;;)
+        {
+            if (queues[self]->popFront(index))
+            {
+                task(index);
+                continue;
+            }
+
+            bool stolen = false;
+            for (unsigned i = 1; i < workers && !stolen; ++i)
+                stolen = queues[(self + i) % workers]->popBack(index);
+            if (!stolen)
+                return;
+            task(index);
+        }
+    };
+
+    // 호출한 스레드도 worker 0 으로 참여
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < workers; ++i)
+        threads.emplace_back(worker, i);
+    worker(0);
+    for (std::thread &thread : threads)
+        thread.join();
+}
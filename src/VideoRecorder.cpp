@@ -0,0 +1,288 @@
+#include "VideoRecorder.h"
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+static const int batchFrames = 8; // writev 한 번에 쓰는 최대 프레임 수
+static const char frameTag[] = "FRAME\n";
+
+namespace
+{
+// 색 번호 -> Y, Cb, Cr (BT.601 full range), [emphasis][색 번호]
+struct YUVPalette
+{
+    uint8_t y[8][64], u[8][64], v[8][64];
+
+    YUVPalette()
+    {
+        const RGBAPalette &palette = defaultPalette();
+        for (int emphasis = 0; emphasis < 8; ++emphasis)
+        {
+            for (int index = 0; index < 64; ++index)
+            {
+                uint32_t color = palette.colors[emphasis][index];
+                double r = color >> 24, g = (color >> 16) & 0xFF, b = (color >> 8) & 0xFF;
+                y[emphasis][index] = clamp(0.299 * r + 0.587 * g + 0.114 * b);
+                u[emphasis][index] = clamp(128 - 0.168736 * r - 0.331264 * g + 0.5 * b);
+                v[emphasis][index] = clamp(128 + 0.5 * r - 0.418688 * g - 0.081312 * b);
+            }
+        }
+    }
+
+    static uint8_t clamp(double value) { return value <= 0 ? 0 : value >= 255 ? 255 : uint8_t(value + 0.5); }
+};
+
+// 0xRRGGBBAA 를 메모리에 R, G, B, A 순서로 쓰도록 little-endian 이면 바이트를 뒤집은 팔레트
+struct BytePalette
+{
+    RGBAPalette palette = defaultPalette();
+
+    BytePalette()
+    {
+        uint32_t one = 1;
+        uint8_t first;
+        std::memcpy(&first, &one, 1);
+        if (first == 1)
+            for (auto &row : palette.colors)
+                for (uint32_t &color : row)
+                    color = __builtin_bswap32(color);
+    }
+};
+} // namespace
+
+static void toY4M(const QueuedFrame &frame, uint8_t *out)
+{
+    static const YUVPalette yuv;
+    const int width = FrameBuffer::width, height = FrameBuffer::height;
+    uint8_t *luma = out;
+    uint8_t *cb = out + width * height;
+    uint8_t *cr = cb + width * height / 4;
+
+    for (int y = 0; y < height; ++y)
+    {
+        const uint8_t *row = frame.pixels + y * FrameBuffer::pitch;
+        const uint8_t *table = yuv.y[frame.emphasis[y] & 0x07];
+        for (int x = 0; x < width; ++x)
+            luma[y * width + x] = table[row[x]];
+    }
+
+    // 2x2 평균
+    for (int y = 0; y < height; y += 2)
+    {
+        const uint8_t *top = frame.pixels + y * FrameBuffer::pitch;
+        const uint8_t *bottom = top + FrameBuffer::pitch;
+        int e0 = frame.emphasis[y] & 0x07, e1 = frame.emphasis[y + 1] & 0x07;
+        for (int x = 0; x < width; x += 2)
+        {
+            int u = yuv.u[e0][top[x]] + yuv.u[e0][top[x + 1]] + yuv.u[e1][bottom[x]] + yuv.u[e1][bottom[x + 1]];
+            int v = yuv.v[e0][top[x]] + yuv.v[e0][top[x + 1]] + yuv.v[e1][bottom[x]] + yuv.v[e1][bottom[x + 1]];
+            *cb++ = uint8_t((u + 2) >> 2);
+            *cr++ = uint8_t((v + 2) >> 2);
+        }
+    }
+}
+
+static void convert(const QueuedFrame &frame, VideoFormat format, uint8_t *out)
+{
+    switch (format)
+    {
+    case VideoFormat::Y4M: toY4M(frame, out); break;
+    case VideoFormat::RGBA:
+    {
+        static const BytePalette bytes;
+        FrameBuffer::toRGBA(frame.view(), reinterpret_cast<uint32_t *>(out), FrameBuffer::width, bytes.palette);
+        break;
+    }
+    case VideoFormat::Indexed:
+        for (int y = 0; y < FrameBuffer::height; ++y)
+            std::memcpy(out + y * FrameBuffer::width, frame.pixels + y * FrameBuffer::pitch, FrameBuffer::width);
+        std::memcpy(out + FrameBuffer::width * FrameBuffer::height, frame.emphasis, FrameBuffer::height);
+        break;
+    }
+}
+
+VideoRecorder::VideoRecorder(size_t slots) : queue(slots, OverflowPolicy::Block)
+{
+}
+
+VideoRecorder::~VideoRecorder()
+{
+    std::string error;
+    close(error);
+}
+
+size_t VideoRecorder::frameBytes(VideoFormat format)
+{
+    const size_t pixels = FrameBuffer::width * FrameBuffer::height;
+    switch (format)
+    {
+    case VideoFormat::Y4M: return pixels * 3 / 2;
+    case VideoFormat::RGBA: return pixels * 4;
+    case VideoFormat::Indexed: return pixels + FrameBuffer::height;
+    }
+    return 0;
+}
+
+// NTSC: PPU 5369318 Hz / 프레임당 평균 89341.5 dot = 39375000 / 655171 프레임/초
+std::string VideoRecorder::header(VideoFormat format)
+{
+    if (format != VideoFormat::Y4M)
+        return std::string();
+    return "YUV4MPEG2 W" + std::to_string(FrameBuffer::width) + " H" + std::to_string(FrameBuffer::height) +
+           " F39375000:655171 Ip A8:7 C420jpeg\n";
+}
+
+bool VideoRecorder::open(const std::string &path, VideoFormat format, std::string &error)
+{
+    if (path == "-")
+        return open(STDOUT_FILENO, format, error);
+
+    int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+    {
+        error = "failed to open video file '" + path + "': " + std::strerror(errno);
+        return false;
+    }
+    if (!open(file, format, error))
+    {
+        ::close(file);
+        return false;
+    }
+    ownsFd = true;
+    return true;
+}
+
+bool VideoRecorder::open(int file, VideoFormat videoFormat, std::string &error)
+{
+    if (recording())
+    {
+        error = "video recorder is already open";
+        return false;
+    }
+    fd = file;
+    ownsFd = false;
+    format = videoFormat;
+    writeError.clear();
+    stopping.store(false, std::memory_order_relaxed);
+    frames.store(0, std::memory_order_relaxed);
+    bytes.store(0, std::memory_order_relaxed);
+    calls.store(0, std::memory_order_relaxed);
+    writer = std::thread(&VideoRecorder::run, this);
+    return true;
+}
+
+bool VideoRecorder::close(std::string &error)
+{
+    if (!recording())
+        return true;
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    if (ownsFd)
+        ::close(fd);
+    fd = -1;
+    ownsFd = false;
+    if (!writeError.empty())
+    {
+        error = writeError;
+        return false;
+    }
+    return true;
+}
+
+void VideoRecorder::push(const FrameBuffer::View &frame)
+{
+    if (recording())
+        queue.push(frame);
+}
+
+// 부분 쓰기와 EINTR 를 처리하며 parts 를 모두 씀 (IOV_MAX 개씩)
+bool VideoRecorder::writeAll(iovec *parts, int count)
+{
+    while (count > 0)
+    {
+        ssize_t written = ::writev(fd, parts, count < IOV_MAX ? count : IOV_MAX);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            writeError = std::string("failed to write video: ") + std::strerror(errno);
+            return false;
+        }
+        calls.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(written, std::memory_order_relaxed);
+
+        size_t remaining = static_cast<size_t>(written);
+        while (count > 0 && remaining >= parts->iov_len)
+        {
+            remaining -= parts->iov_len;
+            ++parts;
+            --count;
+        }
+        if (count > 0)
+        {
+            parts->iov_base = static_cast<uint8_t *>(parts->iov_base) + remaining;
+            parts->iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+/*
+ * writer 스레드
+ * - 프레임을 꺼내 batch 의 다음 칸에 변환하고 슬롯을 바로 돌려줌
+ * - batch 가 차거나 큐가 비면 (헤더 +) 모은 프레임을 writev 한 번으로 씀
+ * - 쓰기가 실패해도 에뮬레이션이 막히지 않도록 큐는 계속 비움
+ */
+void VideoRecorder::run()
+{
+    const size_t size = frameBytes(format);
+    std::vector<uint8_t> batch(batchFrames * size);
+    std::vector<iovec> parts;
+    parts.reserve(batchFrames * 2 + 1);
+    std::string streamHeader = header(format);
+    if (!streamHeader.empty())
+        parts.push_back({&streamHeader[0], streamHeader.size()});
+    int pending = 0;
+    bool failed = false;
+
+    auto flush = [&] {
+        failed = failed || !writeAll(parts.data(), static_cast<int>(parts.size()));
+        if (!failed)
+            frames.fetch_add(pending, std::memory_order_relaxed);
+        parts.clear();
+        pending = 0;
+    };
+
+    for (;;)
+    {
+        bool finished = stopping.load(std::memory_order_acquire);
+        if (const QueuedFrame *frame = queue.pop())
+        {
+            if (failed)
+                continue;
+            uint8_t *out = &batch[pending * size];
+            convert(*frame, format, out);
+            queue.queue.release();
+            if (format == VideoFormat::Y4M)
+                parts.push_back({const_cast<char *>(frameTag), sizeof(frameTag) - 1});
+            parts.push_back({out, size});
+            if (++pending == batchFrames)
+                flush();
+            continue;
+        }
+        if (!parts.empty())
+        {
+            flush();
+            continue;
+        }
+        if (finished)
+            return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
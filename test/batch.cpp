@@ -0,0 +1,60 @@
+#include "../includes/Batch.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <manifest> [threads]\n";
+        return 1;
+    }
+
+    std::ifstream manifest(argv[1]);
+    if (!manifest)
+    {
+        std::cerr << "Failed to open manifest: " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::vector<BatchJob> jobs;
+    std::string error;
+    if (!parseManifest(manifest, jobs, error))
+    {
+        std::cerr << argv[1] << ": " << error << "\n";
+        return 1;
+    }
+
+    unsigned threads = (argc >= 3) ? std::stoul(argv[2]) : 0;
+
+    Clock::time_point start = Clock::now();
+    std::vector<BatchResult> results = runBatch(jobs, threads);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    int failed = 0;
+    uint64_t frames = 0;
+    double jobSeconds = 0;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        const BatchResult &result = results[i];
+        failed += !result.passed;
+        frames += result.frames;
+        jobSeconds += result.seconds;
+
+        std::cout << (result.passed ? "PASS " : "FAIL ") << jobs[i].name << ": result " << result.result << ", "
+                  << result.cycles << " cycles, " << result.seconds << " s";
+        if (!result.error.empty())
+            std::cout << " (" << result.error << ")";
+        std::cout << "\n";
+    }
+
+    std::cout << jobs.size() - failed << "/" << jobs.size() << " passed, " << frames << " instance-frames in "
+              << seconds << " s (" << static_cast<uint64_t>(frames / seconds) << " instance-frames/s, "
+              << jobSeconds / seconds << "x parallel)\n";
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,2101 @@
+#include "../includes/Batch.h"
+#include "../includes/BlockCache.h"
+#include "../includes/CPU.h"
+#include "../includes/FrameCodec.h"
+#include "../includes/JIT.h"
+#include "../includes/NES.h"
+#include "../includes/OutputQueue.h"
+#include "../includes/Rewind.h"
+#include "../includes/VideoRecorder.h"
+#include "../includes/PixelKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+using Clock = std::chrono::steady_clock;
+
+static const uint16_t programStart = 0x8000;
+static const uint16_t trapAddress = 0xF001;
+static const double benchSeconds = 0.5;
+
+static double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static bool loadBinary(const char *path, std::vector<uint8_t> &program)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    program.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !program.empty() && program.size() <= 0x10000 - programStart;
+}
+
+static void resetCPU(CPU &cpu, const std::vector<uint8_t> &program)
+{
+    std::copy(program.begin(), program.end(), cpu.memory.begin() + programStart);
+    cpu.memory[trapAddress] = 0;
+    cpu.a = cpu.x = cpu.y = 0;
+    cpu.setStat(0);
+    cpu.sp = 0xFF;
+    cpu.pc = programStart;
+}
+
+/*
+ * 예전 CPU::execute() 경로 재현 (비교용)
+ * - unordered_map 두 번 조회 + std::function 간접 호출
+ */
+struct LegacyDispatcher
+{
+    struct Entry
+    {
+        std::function<void(uint16_t)> operation;
+        AddressMode mode;
+    };
+
+    CPU &cpu;
+    std::unordered_map<uint8_t, Entry> instructionSet;
+
+    explicit LegacyDispatcher(CPU &cpu) : cpu(cpu)
+    {
+        for (int opcode = 0; opcode < 256; ++opcode)
+        {
+            const Instruction &instruction = CPU::instructionSet[opcode];
+            if (instruction.operation == nullptr)
+                continue;
+            auto operation = instruction.operation;
+            instructionSet[opcode] = { [this, operation](uint16_t address) { operation(this->cpu, address); },
+                                       instruction.mode };
+        }
+    }
+
+    void execute()
+    {
+        uint8_t opcode = cpu.fetch();
+        if (instructionSet.find(opcode) != instructionSet.end())
+        {
+            auto &instruction = instructionSet[opcode];
+            uint16_t address = cpu.fetchAddress(instruction.mode);
+            instruction.operation(address);
+        }
+    }
+};
+
+/*
+ * 예전 eager 플래그 방식 재현 (bench flags 비교용)
+ * - 플래그를 읽거나 쓰는 명령어만 명령어마다 stat 을 직접 계산하는 구현으로 바꾸고 나머지는 CPU 것을 그대로 사용
+ * - lazy 필드는 쓰지 않으므로 실행 전후의 상태는 cpu.stat 에만 있음
+ */
+struct EagerFlagInterpreter
+{
+    enum : uint8_t
+    {
+        C = 0x01,
+        Z = 0x02,
+        I = 0x04,
+        D = 0x08,
+        B = 0x10,
+        U = 0x20,
+        V = 0x40,
+        N = 0x80,
+    };
+
+    CPU &cpu;
+    InstructionTable instructionSet = CPU::instructionSet;
+
+    static void setFlag(CPU &cpu, uint8_t flag, bool condition)
+    {
+        if (condition)
+            cpu.stat |= flag;
+        else
+            cpu.stat &= ~flag;
+    }
+
+    static void setZN(CPU &cpu, uint8_t value)
+    {
+        setFlag(cpu, Z, value == 0);
+        setFlag(cpu, N, value & 0x80);
+    }
+
+    template <uint8_t CPU::*reg>
+    static void load(CPU &cpu, uint16_t address)
+    {
+        cpu.*reg = cpu.read(address);
+        setZN(cpu, cpu.*reg);
+    }
+
+    template <uint8_t CPU::*from, uint8_t CPU::*to>
+    static void transfer(CPU &cpu, uint16_t)
+    {
+        cpu.*to = cpu.*from;
+        setZN(cpu, cpu.*to);
+    }
+
+    template <uint8_t CPU::*reg, int delta>
+    static void step(CPU &cpu, uint16_t)
+    {
+        cpu.*reg += delta;
+        setZN(cpu, cpu.*reg);
+    }
+
+    template <int delta>
+    static void stepMemory(CPU &cpu, uint16_t address)
+    {
+        uint8_t result = cpu.read(address) + delta;
+        cpu.write(address, result);
+        setZN(cpu, result);
+    }
+
+    static void adc(CPU &cpu, uint16_t address)
+    {
+        uint8_t memory = cpu.read(address);
+        uint16_t result = cpu.a + memory + (cpu.stat & C);
+        setFlag(cpu, C, result > 0xFF);
+        setFlag(cpu, V, ~(cpu.a ^ memory) & (cpu.a ^ result) & 0x80);
+        cpu.a = result & 0xFF;
+        setZN(cpu, cpu.a);
+    }
+
+    static void sbc(CPU &cpu, uint16_t address)
+    {
+        uint8_t memory = cpu.read(address);
+        uint16_t result = cpu.a - memory - ((cpu.stat & C) ? 0 : 1);
+        setFlag(cpu, C, result < 0x100);
+        setFlag(cpu, V, (cpu.a ^ result) & (cpu.a ^ memory) & 0x80);
+        cpu.a = result & 0xFF;
+        setZN(cpu, cpu.a);
+    }
+
+    static uint8_t asl(CPU &cpu, uint8_t value)
+    {
+        setFlag(cpu, C, value & 0x80);
+        value <<= 1;
+        setZN(cpu, value);
+        return value;
+    }
+
+    static uint8_t lsr(CPU &cpu, uint8_t value)
+    {
+        setFlag(cpu, C, value & 0x01);
+        value >>= 1;
+        setZN(cpu, value);
+        return value;
+    }
+
+    static uint8_t rol(CPU &cpu, uint8_t value)
+    {
+        uint8_t carryIn = cpu.stat & C;
+        setFlag(cpu, C, value & 0x80);
+        value = (value << 1) | carryIn;
+        setZN(cpu, value);
+        return value;
+    }
+
+    static uint8_t ror(CPU &cpu, uint8_t value)
+    {
+        uint8_t carryIn = (cpu.stat & C) << 7;
+        setFlag(cpu, C, value & 0x01);
+        value = (value >> 1) | carryIn;
+        setZN(cpu, value);
+        return value;
+    }
+
+    template <uint8_t (*shift)(CPU &, uint8_t)>
+    static void shiftAccumulator(CPU &cpu, uint16_t)
+    {
+        cpu.a = shift(cpu, cpu.a);
+    }
+
+    template <uint8_t (*shift)(CPU &, uint8_t)>
+    static void shiftMemory(CPU &cpu, uint16_t address)
+    {
+        cpu.write(address, shift(cpu, cpu.read(address)));
+    }
+
+    static void andA(CPU &cpu, uint16_t address)
+    {
+        cpu.a &= cpu.read(address);
+        setZN(cpu, cpu.a);
+    }
+
+    static void ora(CPU &cpu, uint16_t address)
+    {
+        cpu.a |= cpu.read(address);
+        setZN(cpu, cpu.a);
+    }
+
+    static void eor(CPU &cpu, uint16_t address)
+    {
+        cpu.a ^= cpu.read(address);
+        setZN(cpu, cpu.a);
+    }
+
+    static void bit(CPU &cpu, uint16_t address)
+    {
+        uint8_t value = cpu.read(address);
+        setFlag(cpu, Z, (cpu.a & value) == 0);
+        setFlag(cpu, V, value & 0x40);
+        setFlag(cpu, N, value & 0x80);
+    }
+
+    template <uint8_t CPU::*reg>
+    static void compare(CPU &cpu, uint16_t address)
+    {
+        uint8_t value = cpu.read(address);
+        setFlag(cpu, C, cpu.*reg >= value);
+        setZN(cpu, cpu.*reg - value);
+    }
+
+    template <uint8_t flag, bool set>
+    static void branchIf(CPU &cpu, uint16_t address)
+    {
+        cpu.branch(((cpu.stat & flag) != 0) == set, address);
+    }
+
+    template <uint8_t flag, bool set>
+    static void setStatFlag(CPU &cpu, uint16_t)
+    {
+        setFlag(cpu, flag, set);
+    }
+
+    static void brk(CPU &cpu, uint16_t)
+    {
+        cpu.write(0x100 + cpu.sp--, (cpu.pc + 1) >> 8);
+        cpu.write(0x100 + cpu.sp--, (cpu.pc + 1) & 0xFF);
+        cpu.write(0x100 + cpu.sp--, cpu.stat | B | U);
+        cpu.pc = cpu.read(0xFFFE) | (cpu.read(0xFFFF) << 8);
+        cpu.stat |= I;
+    }
+
+    static void rti(CPU &cpu, uint16_t)
+    {
+        cpu.stat = cpu.read(0x0100 + ++cpu.sp);
+        uint8_t low = cpu.read(0x0100 + ++cpu.sp);
+        uint8_t high = cpu.read(0x0100 + ++cpu.sp);
+        cpu.pc = low | (high << 8);
+    }
+
+    static void pla(CPU &cpu, uint16_t)
+    {
+        cpu.a = cpu.read(0x0100 + ++cpu.sp);
+        setZN(cpu, cpu.a);
+    }
+
+    static void php(CPU &cpu, uint16_t)
+    {
+        cpu.write(0x0100 + cpu.sp--, cpu.stat | B | U);
+    }
+
+    static void plp(CPU &cpu, uint16_t)
+    {
+        cpu.stat = cpu.read(0x0100 + ++cpu.sp);
+    }
+
+    void replace(std::initializer_list<uint8_t> opcodes, void (*operation)(CPU &, uint16_t))
+    {
+        for (uint8_t opcode : opcodes)
+            instructionSet[opcode].operation = operation;
+    }
+
+    explicit EagerFlagInterpreter(CPU &cpu) : cpu(cpu)
+    {
+        replace({ 0xA9, 0xA5, 0xB5, 0xAD, 0xBD, 0xB9, 0xA1, 0xB1 }, load<&CPU::a>);
+        replace({ 0xA2, 0xA6, 0xB6, 0xAE, 0xBE }, load<&CPU::x>);
+        replace({ 0xA0, 0xA4, 0xB4, 0xAC, 0xBC }, load<&CPU::y>);
+        replace({ 0xAA }, transfer<&CPU::a, &CPU::x>);
+        replace({ 0x8A }, transfer<&CPU::x, &CPU::a>);
+        replace({ 0xA8 }, transfer<&CPU::a, &CPU::y>);
+        replace({ 0x98 }, transfer<&CPU::y, &CPU::a>);
+        replace({ 0xBA }, transfer<&CPU::sp, &CPU::x>);
+
+        replace({ 0x69, 0x65, 0x75, 0x6D, 0x7D, 0x79, 0x61, 0x71 }, adc);
+        replace({ 0xE9, 0xE5, 0xF5, 0xED, 0xFD, 0xF9, 0xE1, 0xF1 }, sbc);
+        replace({ 0xE6, 0xF6, 0xEE, 0xFE }, stepMemory<1>);
+        replace({ 0xC6, 0xD6, 0xCE, 0xDE }, stepMemory<-1>);
+        replace({ 0xE8 }, step<&CPU::x, 1>);
+        replace({ 0xCA }, step<&CPU::x, -1>);
+        replace({ 0xC8 }, step<&CPU::y, 1>);
+        replace({ 0x88 }, step<&CPU::y, -1>);
+
+        replace({ 0x0A }, shiftAccumulator<asl>);
+        replace({ 0x06, 0x16, 0x0E, 0x1E }, shiftMemory<asl>);
+        replace({ 0x4A }, shiftAccumulator<lsr>);
+        replace({ 0x46, 0x56, 0x4E, 0x5E }, shiftMemory<lsr>);
+        replace({ 0x2A }, shiftAccumulator<rol>);
+        replace({ 0x26, 0x36, 0x2E, 0x3E }, shiftMemory<rol>);
+        replace({ 0x6A }, shiftAccumulator<ror>);
+        replace({ 0x66, 0x76, 0x6E, 0x7E }, shiftMemory<ror>);
+
+        replace({ 0x29, 0x25, 0x35, 0x2D, 0x3D, 0x39, 0x21, 0x31 }, andA);
+        replace({ 0x09, 0x05, 0x15, 0x0D, 0x1D, 0x19, 0x01, 0x11 }, ora);
+        replace({ 0x49, 0x45, 0x55, 0x4D, 0x5D, 0x59, 0x41, 0x51 }, eor);
+        replace({ 0x24, 0x2C }, bit);
+        replace({ 0xC9, 0xC5, 0xD5, 0xCD, 0xDD, 0xD9, 0xC1, 0xD1 }, compare<&CPU::a>);
+        replace({ 0xE0, 0xE4, 0xEC }, compare<&CPU::x>);
+        replace({ 0xC0, 0xC4, 0xCC }, compare<&CPU::y>);
+
+        replace({ 0x90 }, branchIf<C, false>);
+        replace({ 0xB0 }, branchIf<C, true>);
+        replace({ 0xD0 }, branchIf<Z, false>);
+        replace({ 0xF0 }, branchIf<Z, true>);
+        replace({ 0x10 }, branchIf<N, false>);
+        replace({ 0x30 }, branchIf<N, true>);
+        replace({ 0x50 }, branchIf<V, false>);
+        replace({ 0x70 }, branchIf<V, true>);
+
+        replace({ 0x00 }, brk);
+        replace({ 0x40 }, rti);
+        replace({ 0x68 }, pla);
+        replace({ 0x08 }, php);
+        replace({ 0x28 }, plp);
+        replace({ 0x18 }, setStatFlag<C, false>);
+        replace({ 0x38 }, setStatFlag<C, true>);
+        replace({ 0x58 }, setStatFlag<I, false>);
+        replace({ 0x78 }, setStatFlag<I, true>);
+        replace({ 0xD8 }, setStatFlag<D, false>);
+        replace({ 0xF8 }, setStatFlag<D, true>);
+        replace({ 0xB8 }, setStatFlag<V, false>);
+    }
+
+    // CPU::executeInstruction() 과 같은 순서, 정의되지 않은 opcode 는 NOP 처럼 취급
+    void execute()
+    {
+        const Instruction &instruction = instructionSet[cpu.fetch()];
+        cpu.pageCrossed = false;
+        if (instruction.operation != nullptr)
+            instruction.operation(cpu, cpu.fetchAddress(instruction.mode));
+        cpu.cycles += instruction.cycles + (instruction.pageCycle && cpu.pageCrossed);
+        ++cpu.instructions;
+    }
+
+    void run(uint64_t cycleBudget)
+    {
+        uint64_t target = cpu.cycles + cycleBudget;
+        while (cpu.cycles < target && !cpu.halted)
+            execute();
+    }
+};
+
+/*
+ * 분기/점프/스택 제어 없이 RAM($0200-$07FF)만 건드리는 명령어를 무작위로 나열하고
+ * 마지막에 JMP $8000 으로 되돌아가는 프로그램
+ */
+static std::vector<uint8_t> makeSyntheticMix(size_t count)
+{
+    std::vector<uint8_t> opcodes;
+    for (int opcode = 0; opcode < 256; ++opcode)
+    {
+        const Instruction &instruction = CPU::instructionSet[opcode];
+        if (instruction.operation == nullptr)
+            continue;
+        switch (opcode)
+        {
+        case 0x00: case 0x20: case 0x40: case 0x60: // BRK, JSR, RTI, RTS
+        case 0x4C: case 0x6C:                       // JMP
+        case 0x81: case 0x91:                       // STA (간접) 은 코드 영역을 덮어쓸 수 있음
+            continue;
+        default: break;
+        }
+        if (instruction.mode == AddressMode::Relative)
+            continue;
+        opcodes.push_back(opcode);
+    }
+
+    std::mt19937 rng(6502);
+    std::vector<uint8_t> program;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint8_t opcode = opcodes[rng() % opcodes.size()];
+        program.push_back(opcode);
+        switch (CPU::instructionSet[opcode].mode)
+        {
+        case AddressMode::Immediate:
+        case AddressMode::ZeroPage:
+        case AddressMode::ZeroPageXIndexed:
+        case AddressMode::ZeroPageYIndexed:
+        case AddressMode::IndexedIndirect:
+        case AddressMode::IndirectIndexed: program.push_back(rng() & 0xFF); break;
+        case AddressMode::Absolute:
+        case AddressMode::AbsoluteXIndexed:
+        case AddressMode::AbsoluteYIndexed:
+        {
+            uint16_t address = 0x0200 + rng() % 0x0500; // + X/Y 를 해도 $07FF 이하
+            program.push_back(address & 0xFF);
+            program.push_back(address >> 8);
+            break;
+        }
+        default: break;
+        }
+    }
+    program.push_back(0x4C); // JMP $8000
+    program.push_back(programStart & 0xFF);
+    program.push_back(programStart >> 8);
+    return program;
+}
+
+// $0200,X 를 읽어 1 을 더해 $0300,X 에 쓰는 256회 루프를 무한 반복
+static std::vector<uint8_t> makeHotLoop()
+{
+    return {
+        0xA2, 0x00,       // start: LDX #$00
+        0xBD, 0x00, 0x02, // loop:  LDA $0200,X
+        0x18,             //        CLC
+        0x69, 0x01,       //        ADC #$01
+        0x9D, 0x00, 0x03, //        STA $0300,X
+        0xE8,             //        INX
+        0xD0, 0xF4,       //        BNE loop
+        0x4C, 0x00, 0x80, //        JMP start
+    };
+}
+
+// 플래그를 계속 바꾸는 ALU 명령어와 분기 위주의 루프 (메모리 접근 없음)
+static std::vector<uint8_t> makeFlagLoop()
+{
+    return {
+        0xA2, 0x00, //        LDX #$00
+        0x69, 0x11, // loop:  ADC #$11
+        0x2A,       //        ROL A
+        0x49, 0x5A, //        EOR #$5A
+        0xC9, 0x40, //        CMP #$40
+        0xE9, 0x03, //        SBC #$03
+        0x4A,       //        LSR A
+        0x29, 0x7F, //        AND #$7F
+        0x09, 0x21, //        ORA #$21
+        0x6A,       //        ROR A
+        0xE8,       //        INX
+        0xD0, 0xEE, //        BNE loop
+        0x4C, 0x00, 0x80, //  JMP start
+    };
+}
+
+/*
+ * CHR/네임테이블/팔레트/OAM 을 채우고 배경과 스프라이트를 켠 뒤,
+ * 약 3프레임마다 스크롤과 OAM 한 바이트를 바꾸는 프로그램 (프레임 중간의 레지스터 쓰기 포함)
+ */
+static std::vector<uint8_t> makePPUDemo()
+{
+    return {
+        0xA9, 0x00,       //        LDA #$00
+        0x8D, 0x01, 0x20, //        STA $2001      ; 렌더링 끄기
+        0xAD, 0x02, 0x20, //        LDA $2002      ; w 리셋
+        0xA9, 0x00,       //        LDA #$00       ; CHR $0000-$1FFF = (i & $FF) ^ 남은 페이지 수
+        0x8D, 0x06, 0x20, //        STA $2006
+        0x8D, 0x06, 0x20, //        STA $2006
+        0xA0, 0x20,       //        LDY #$20
+        0xA2, 0x00,       //        LDX #$00
+        0x84, 0x00,       // chr:   STY $00
+        0x8A,             // chr2:  TXA
+        0x45, 0x00,       //        EOR $00
+        0x8D, 0x07, 0x20, //        STA $2007
+        0xE8,             //        INX
+        0xD0, 0xF7,       //        BNE chr2
+        0x88,             //        DEY
+        0xD0, 0xF2,       //        BNE chr
+        0xA9, 0x20,       //        LDA #$20       ; 네임테이블 $2000-$27FF 도 같은 방식
+        0x8D, 0x06, 0x20, //        STA $2006
+        0xA9, 0x00,       //        LDA #$00
+        0x8D, 0x06, 0x20, //        STA $2006
+        0xA0, 0x08,       //        LDY #$08
+        0x84, 0x00,       // nt:    STY $00
+        0x8A,             // nt2:   TXA
+        0x45, 0x00,       //        EOR $00
+        0x8D, 0x07, 0x20, //        STA $2007
+        0xE8,             //        INX
+        0xD0, 0xF7,       //        BNE nt2
+        0x88,             //        DEY
+        0xD0, 0xF2,       //        BNE nt
+        0xA9, 0x3F,       //        LDA #$3F       ; 팔레트 $3F00-$3F1F = 0, 1, 2, ...
+        0x8D, 0x06, 0x20, //        STA $2006
+        0xA9, 0x00,       //        LDA #$00
+        0x8D, 0x06, 0x20, //        STA $2006
+        0x8A,             // pal:   TXA
+        0x8D, 0x07, 0x20, //        STA $2007
+        0xE8,             //        INX
+        0xE0, 0x20,       //        CPX #$20
+        0xD0, 0xF7,       //        BNE pal
+        0xA9, 0x00,       //        LDA #$00       ; $0200-$02FF = i ^ $A5 (OAM DMA 원본)
+        0x8D, 0x03, 0x20, //        STA $2003
+        0xAA,             //        TAX
+        0x8A,             // oam:   TXA
+        0x49, 0xA5,       //        EOR #$A5
+        0x9D, 0x00, 0x02, //        STA $0200,X
+        0xE8,             //        INX
+        0xD0, 0xF7,       //        BNE oam
+        0xAD, 0x02, 0x20, //        LDA $2002      ; 스크롤 0
+        0xA9, 0x00,       //        LDA #$00
+        0x8D, 0x05, 0x20, //        STA $2005
+        0x8D, 0x05, 0x20, //        STA $2005
+        0xA9, 0x10,       //        LDA #$10       ; 배경 패턴 테이블 $1000
+        0x8D, 0x00, 0x20, //        STA $2000
+        0xA9, 0x1E,       //        LDA #$1E       ; 배경 + 스프라이트
+        0x8D, 0x01, 0x20, //        STA $2001
+        0xA0, 0x40,       // main:  LDY #$40       ; 64 * 256 번 대기
+        0xCA,             // delay: DEX
+        0xD0, 0xFD,       //        BNE delay
+        0x88,             //        DEY
+        0xD0, 0xFA,       //        BNE delay
+        0xE6, 0x01,       //        INC $01
+        0xA5, 0x01,       //        LDA $01
+        0x8D, 0x05, 0x20, //        STA $2005
+        0x8D, 0x05, 0x20, //        STA $2005
+        0x8D, 0x03, 0x20, //        STA $2003
+        0x8D, 0x04, 0x20, //        STA $2004
+        0x29, 0x20,       //        AND #$20       ; $01 의 bit 5 로 8x8 / 8x16 스프라이트 전환
+        0x09, 0x10,       //        ORA #$10
+        0x8D, 0x00, 0x20, //        STA $2000
+        0xA9, 0x02,       //        LDA #$02       ; OAM DMA (oamAddr = $01 부터)
+        0x8D, 0x14, 0x40, //        STA $4014
+        0x4C, 0x73, 0x80, //        JMP main
+    };
+}
+
+template <typename Step>
+static double runUntilTrap(CPU &cpu, const std::vector<uint8_t> &program, Step step, uint64_t &instructions)
+{
+    instructions = 0;
+    Clock::time_point start = Clock::now();
+    do
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            resetCPU(cpu, program);
+            while (cpu.memory[trapAddress] == 0)
+            {
+                step();
+                ++instructions;
+            }
+        }
+    } while (secondsSince(start) < benchSeconds);
+    return secondsSince(start);
+}
+
+template <typename Step>
+static double runFor(CPU &cpu, const std::vector<uint8_t> &program, Step step, uint64_t &instructions)
+{
+    instructions = 0;
+    resetCPU(cpu, program);
+    Clock::time_point start = Clock::now();
+    do
+    {
+        for (int i = 0; i < 100000; ++i)
+            step();
+        instructions += 100000;
+    } while (secondsSince(start) < benchSeconds);
+    return secondsSince(start);
+}
+
+static void report(const char *name, uint64_t instructions, double seconds)
+{
+    std::cout << "  " << name << ": " << static_cast<uint64_t>(instructions / seconds) << " instructions/s\n";
+}
+
+template <typename Runner>
+static void compareDispatch(const char *title, const std::vector<uint8_t> &program, Runner runner)
+{
+    CPU cpu;
+    LegacyDispatcher legacy(cpu);
+    uint64_t legacyCount, tableCount;
+    double legacySeconds = runner(cpu, program, [&] { legacy.execute(); }, legacyCount);
+    double tableSeconds = runner(cpu, program, [&] { cpu.executeInstruction(); }, tableCount);
+
+    std::cout << title << "\n";
+    report("unordered_map + std::function", legacyCount, legacySeconds);
+    report("dispatch table", tableCount, tableSeconds);
+    std::cout << "  speedup: " << (tableCount / tableSeconds) / (legacyCount / legacySeconds) << "x\n";
+}
+
+// CPU::run() 으로 NTSC 프레임(29780 사이클) 단위 실행
+static int benchCycles()
+{
+    const uint64_t frameCycles = 29780;
+    const double ntscCPUClock = 1789773.0;
+
+    CPU cpu;
+    std::vector<uint8_t> program = makeSyntheticMix(4096);
+    resetCPU(cpu, program);
+
+    uint64_t frames = 0;
+    Clock::time_point start = Clock::now();
+    do
+    {
+        cpu.run(frameCycles);
+        ++frames;
+    } while (secondsSince(start) < benchSeconds);
+    double seconds = secondsSince(start);
+
+    std::cout << "synthetic opcode mix (CPU::run)\n";
+    std::cout << "  " << static_cast<uint64_t>(cpu.cycles / seconds) << " cycles/s, "
+              << static_cast<uint64_t>(frames / seconds) << " frames/s ("
+              << cpu.cycles / seconds / ntscCPUClock << "x NTSC)\n";
+    return 0;
+}
+
+/*
+ * 인터프리터와 블록 캐시 비교 (CPU::run 기준)
+ * - untilTrap: trap 에 도달할 때까지 실행하는 짧은 프로그램이면 반복해서 다시 시작
+ */
+static void compareBlockCache(const char *title, const std::vector<uint8_t> &program, bool untilTrap)
+{
+    const uint64_t frameCycles = 29780;
+    double cyclesPerSecond[2];
+    BlockCache::Stats stats;
+
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        CPU cpu;
+        cpu.setExecutionMode(mode == 0 ? ExecutionMode::Interpreter : ExecutionMode::BlockCache);
+        resetCPU(cpu, program);
+        cpu.setTrap(trapAddress);
+
+        uint64_t cycles = 0;
+        Clock::time_point start = Clock::now();
+        do
+        {
+            if (!untilTrap)
+            {
+                cycles += cpu.run(frameCycles);
+                continue;
+            }
+            for (int i = 0; i < 1000; ++i)
+            {
+                resetCPU(cpu, program);
+                cpu.halted = false;
+                while (!cpu.halted)
+                    cycles += cpu.run(frameCycles);
+            }
+        } while (secondsSince(start) < benchSeconds);
+        cyclesPerSecond[mode] = cycles / secondsSince(start);
+        if (cpu.blockCache)
+            stats = cpu.blockCache->stats;
+    }
+
+    std::cout << title << "\n";
+    std::cout << "  interpreter: " << static_cast<uint64_t>(cyclesPerSecond[0]) << " cycles/s\n";
+    std::cout << "  block cache: " << static_cast<uint64_t>(cyclesPerSecond[1]) << " cycles/s\n";
+    std::cout << "  speedup: " << cyclesPerSecond[1] / cyclesPerSecond[0] << "x, hit rate: "
+              << 100.0 * stats.hits / stats.lookups << "% (" << stats.decodes << " decodes, " << stats.invalidations
+              << " invalidations, " << stats.coldRuns << " cold runs)\n";
+}
+
+static int benchBlocks(int argc, char *argv[])
+{
+    if (argc >= 3)
+    {
+        std::vector<uint8_t> program;
+        if (!loadBinary(argv[2], program))
+        {
+            std::cerr << "Failed to load binary file: " << argv[2] << "\n";
+            return 1;
+        }
+        compareBlockCache(argv[2], program, true);
+    }
+
+    compareBlockCache("hot loop", makeHotLoop(), false);
+    compareBlockCache("synthetic opcode mix", makeSyntheticMix(4096), false);
+    return 0;
+}
+
+/*
+ * 인터프리터 / 블록 캐시 / JIT 비교
+ * - 같은 프레임 수만큼 실행한 뒤 JIT 의 최종 상태가 인터프리터와 같은지 확인
+ * - untilTrap: trap 에 도달할 때까지 실행하는 짧은 프로그램이면 같은 횟수만큼 다시 시작
+ *   (한 번만 실행하면 처음 디코딩/컴파일하는 비용만 재게 됨)
+ */
+static bool compareJIT(const char *title, const std::vector<uint8_t> &program, bool untilTrap)
+{
+    const uint64_t frameCycles = 29780;
+    const int frames = 2000;
+    const int restarts = 100000;
+    const ExecutionMode modes[3] = { ExecutionMode::Interpreter, ExecutionMode::BlockCache, ExecutionMode::JIT };
+    const char *names[3] = { "interpreter", "block cache", "jit" };
+    double cyclesPerSecond[3];
+    JIT::Stats stats;
+    CPU cpus[3];
+
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        CPU &cpu = cpus[mode];
+        cpu.setExecutionMode(modes[mode]);
+        resetCPU(cpu, program);
+        cpu.setTrap(trapAddress);
+
+        Clock::time_point start = Clock::now();
+        if (untilTrap)
+        {
+            for (int i = 0; i < restarts; ++i)
+            {
+                resetCPU(cpu, program);
+                cpu.halted = false;
+                while (!cpu.halted)
+                    cpu.run(frameCycles);
+            }
+        }
+        else
+        {
+            for (int frame = 0; frame < frames; ++frame)
+                cpu.run(frameCycles);
+        }
+        cyclesPerSecond[mode] = cpu.cycles / secondsSince(start);
+        if (cpu.jit)
+            stats = cpu.jit->stats;
+    }
+
+    std::cout << title << "\n";
+    for (int mode = 0; mode < 3; ++mode)
+        std::cout << "  " << names[mode] << ": " << static_cast<uint64_t>(cyclesPerSecond[mode]) << " cycles/s ("
+                  << cyclesPerSecond[mode] / cyclesPerSecond[0] << "x)\n";
+    std::cout << "  " << stats.compiled << " blocks compiled, " << stats.nativeRuns << " native runs, "
+              << stats.flushes << " flushes\n";
+
+    const CPU &lhs = cpus[0];
+    const CPU &rhs = cpus[2];
+    bool same = lhs.a == rhs.a && lhs.x == rhs.x && lhs.y == rhs.y && lhs.sp == rhs.sp && lhs.stat == rhs.stat &&
+                lhs.pc == rhs.pc && lhs.cycles == rhs.cycles && lhs.instructions == rhs.instructions &&
+                lhs.memory == rhs.memory;
+    if (!same)
+        std::cerr << "  state mismatch between interpreter and jit\n";
+    return same;
+}
+
+static int benchJIT(int argc, char *argv[])
+{
+    if (!JIT::supported())
+        std::cout << "JIT is not supported on this platform (block cache is used instead)\n";
+
+    bool same = true;
+    if (argc >= 3)
+    {
+        std::vector<uint8_t> program;
+        if (!loadBinary(argv[2], program))
+        {
+            std::cerr << "Failed to load binary file: " << argv[2] << "\n";
+            return 1;
+        }
+        same &= compareJIT(argv[2], program, true);
+    }
+
+    same &= compareJIT("hot loop", makeHotLoop(), false);
+    same &= compareJIT("synthetic opcode mix", makeSyntheticMix(4096), false);
+    return same ? 0 : 1;
+}
+
+/*
+ * lazy 플래그 인터프리터와 eager 플래그 재현(EagerFlagInterpreter)의 instructions/s
+ * - 0.5초씩 번갈아 5번 실행한 것 중 가장 빠른 값, ALU 위주의 루프와 synthetic mix 를 사용
+ * - 같은 사이클만큼 실행한 뒤 레지스터/stat/메모리가 같은지도 확인
+ */
+static bool measureInstructions(const char *title, const std::vector<uint8_t> &program)
+{
+    const uint64_t frameCycles = 29780;
+    double eagerBest = 0, lazyBest = 0;
+
+    for (int round = 0; round < 5; ++round)
+    {
+        CPU eagerCPU;
+        EagerFlagInterpreter eager(eagerCPU);
+        resetCPU(eagerCPU, program);
+        Clock::time_point start = Clock::now();
+        do
+            eager.run(frameCycles);
+        while (secondsSince(start) < benchSeconds);
+        eagerBest = std::max(eagerBest, eagerCPU.instructions / secondsSince(start));
+
+        CPU cpu;
+        resetCPU(cpu, program);
+        start = Clock::now();
+        do
+            cpu.run(frameCycles);
+        while (secondsSince(start) < benchSeconds);
+        lazyBest = std::max(lazyBest, cpu.instructions / secondsSince(start));
+    }
+
+    CPU eagerCPU, cpu;
+    EagerFlagInterpreter eager(eagerCPU);
+    resetCPU(eagerCPU, program);
+    resetCPU(cpu, program);
+    for (int frame = 0; frame < 100; ++frame)
+    {
+        eager.run(frameCycles);
+        cpu.run(frameCycles);
+    }
+    bool same = eagerCPU.a == cpu.a && eagerCPU.x == cpu.x && eagerCPU.y == cpu.y && eagerCPU.sp == cpu.sp &&
+                eagerCPU.stat == cpu.stat && eagerCPU.pc == cpu.pc && eagerCPU.cycles == cpu.cycles &&
+                eagerCPU.memory == cpu.memory;
+
+    std::cout << title << "\n";
+    std::cout << "  eager flags: " << static_cast<uint64_t>(eagerBest) << " instructions/s\n";
+    std::cout << "  lazy flags: " << static_cast<uint64_t>(lazyBest) << " instructions/s\n";
+    std::cout << "  speedup: " << lazyBest / eagerBest << "x, " << (same ? "identical" : "MISMATCH") << "\n";
+    return same;
+}
+
+static int benchFlags()
+{
+    bool same = measureInstructions("flag-heavy ALU loop", makeFlagLoop());
+    same &= measureInstructions("synthetic opcode mix", makeSyntheticMix(4096));
+    return same ? 0 : 1;
+}
+
+// 16KB PRG 로 채워서 올리고 $8000 부터 실행
+static void loadNES(NES &nes, std::vector<uint8_t> prg)
+{
+    prg.resize(0x4000, 0xEA);
+    nes.loadPRG(prg);
+    nes.cpu.pc = programStart;
+}
+
+// NES 를 frames 프레임(CPU 사이클 기준)만큼 lock-step 으로 진행
+static void runNESFrames(NES &nes, int frames)
+{
+    const uint64_t frameCycles = 29780;
+    uint64_t target = nes.cpu.cycles + frames * frameCycles;
+    while (nes.cpu.cycles < target)
+        nes.step();
+}
+
+// save + load 를 0.5초 동안 반복 (같은 버퍼를 재사용)
+template <typename Component>
+static void measureState(const char *title, Component &component)
+{
+    std::vector<uint8_t> buffer;
+    component.saveState(buffer);
+    size_t capacity = buffer.capacity();
+
+    uint64_t rounds = 0;
+    double saveSeconds = 0, loadSeconds = 0;
+    Clock::time_point start = Clock::now();
+    do
+    {
+        Clock::time_point saveStart = Clock::now();
+        component.saveState(buffer);
+        Clock::time_point loadStart = Clock::now();
+        component.loadState(buffer);
+        loadSeconds += secondsSince(loadStart);
+        saveSeconds += std::chrono::duration<double>(loadStart - saveStart).count();
+        ++rounds;
+    } while (secondsSince(start) < benchSeconds);
+
+    std::cout << title << " (" << buffer.size() << " bytes)\n";
+    std::cout << "  save: " << saveSeconds / rounds * 1e6 << " us, load: " << loadSeconds / rounds * 1e6
+              << " us" << (buffer.capacity() == capacity ? "" : " (buffer reallocated)") << "\n";
+}
+
+/*
+ * save state 크기/속도와 되돌리기 검증
+ * - 저장 -> 1프레임 실행 -> 불러오기 -> 같은 1프레임 실행의 결과가 처음과 같아야 함
+ */
+static int benchState()
+{
+    NES nes;
+    loadNES(nes, makeSyntheticMix(4096));
+    runNESFrames(nes, 1);
+
+    std::vector<uint8_t> snapshot, first, second;
+    nes.saveState(snapshot);
+    runNESFrames(nes, 1);
+    nes.saveState(first);
+    bool same = nes.loadState(snapshot);
+    runNESFrames(nes, 1);
+    nes.saveState(second);
+    same &= first == second;
+
+    measureState("NES (CPU + PPU + RAM)", nes);
+
+    CPU cpu;
+    resetCPU(cpu, makeSyntheticMix(4096));
+    cpu.run(29780);
+    measureState("CPU (flat 64KB)", cpu);
+
+    std::cout << "restore and replay: " << (same ? "identical" : "MISMATCH") << "\n";
+    return same ? 0 : 1;
+}
+
+/*
+ * 되감기 기록 비용 (프레임마다 save state + push)
+ * - 60초 분량을 기록한 뒤 임의의 프레임으로 되감아, 그 시점에 저장해 둔 원본과 같은지 확인
+ */
+static int benchRewind()
+{
+    const int frames = 60 * 60;
+    const double budgetMicroseconds = 100; // 프레임(16.6ms)당 허용하는 기록 비용
+
+    NES nes;
+    loadNES(nes, makeSyntheticMix(4096));
+
+    Rewind rewind;
+    std::vector<uint8_t> state;
+    std::vector<std::vector<uint8_t>> originals; // 검증용 (되감을 프레임만)
+    std::mt19937 rng(2);
+    std::vector<int> checkpoints;
+    for (int i = 0; i < 16; ++i)
+        checkpoints.push_back(rng() % frames);
+    std::sort(checkpoints.begin(), checkpoints.end());
+    checkpoints.erase(std::unique(checkpoints.begin(), checkpoints.end()), checkpoints.end());
+
+    double captureSeconds = 0;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        runNESFrames(nes, 1);
+        nes.saveState(state); // 미뤄 둔 PPU/APU 따라잡기는 에뮬레이션 비용이므로 측정에서 뺌
+        Clock::time_point start = Clock::now();
+        nes.saveState(state);
+        rewind.push(state);
+        captureSeconds += secondsSince(start);
+        if (std::find(checkpoints.begin(), checkpoints.end(), frame) != checkpoints.end())
+            originals.push_back(state);
+    }
+
+    double capture = captureSeconds / frames * 1e6;
+    std::cout << "NES rewind capture (" << frames << " frames, keyframe every 60)\n";
+    std::cout << "  capture: " << capture << " us/frame (budget " << budgetMicroseconds << " us)\n";
+    std::cout << "  state: " << state.size() << " bytes, stored: " << rewind.stats.encodedBytes / frames
+              << " bytes/frame, " << rewind.bytesUsed() / 1024 << " KB for " << rewind.frames() << " frames\n";
+
+    bool same = true;
+    std::vector<uint8_t> decoded;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < checkpoints.size(); ++i)
+        same &= rewind.peek(frames - 1 - checkpoints[i], decoded) && decoded == originals[i];
+    double decode = secondsSince(start) / checkpoints.size() * 1e6;
+
+    // 가장 이른 지점으로 되감은 뒤 이어서 실행해도 기록이 이어지는지 확인
+    same &= rewind.rewind(frames - 1 - checkpoints[0], decoded) && nes.loadState(decoded);
+    runNESFrames(nes, 1);
+    nes.saveState(state);
+    rewind.push(state);
+    same &= rewind.frames() == static_cast<size_t>(checkpoints[0] + 2) && rewind.peek(0, decoded) && decoded == state;
+
+    std::cout << "  decode: " << decode << " us/frame, rewind: " << (same ? "identical" : "MISMATCH") << "\n";
+    return same && capture < budgetMicroseconds ? 0 : 1;
+}
+
+/*
+ * 일괄 실행 확장성: 같은 작업 묶음을 스레드 1개와 전체 스레드로 실행해 instance-frames/s 비교
+ * - 작업 길이를 섞어 두어 work stealing 이 균형을 맞추는지도 볼 수 있음
+ */
+static int benchBatch()
+{
+    unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<BatchJob> jobs(hardwareThreads * 8);
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        jobs[i].name = "synthetic " + std::to_string(i);
+        jobs[i].program = makeSyntheticMix(4096);
+        jobs[i].cycleBudget = (20 + i % 4 * 20) * batchFrameCycles;
+        jobs[i].exit = BatchExit::Budget;
+    }
+
+    double single = 0;
+    std::cout << "batch of " << jobs.size() << " synthetic mix instances\n";
+    for (unsigned threads : {1u, hardwareThreads})
+    {
+        Clock::time_point start = Clock::now();
+        std::vector<BatchResult> results = runBatch(jobs, threads);
+        double seconds = secondsSince(start);
+
+        uint64_t frames = 0;
+        for (const BatchResult &result : results)
+            frames += result.passed ? result.frames : 0;
+        double throughput = frames / seconds;
+        if (threads == 1)
+            single = throughput;
+        std::cout << "  " << threads << " thread(s): " << static_cast<uint64_t>(throughput) << " instance-frames/s ("
+                  << throughput / single << "x)\n";
+        if (hardwareThreads == 1)
+            break;
+    }
+    return 0;
+}
+
+// front/back 버퍼 모두 비교 (back 은 그리는 중인 프레임)
+static bool sameFrames(FrameBuffer &lhs, FrameBuffer &rhs)
+{
+    return lhs.sequence() == rhs.sequence() && FrameBuffer::hash(lhs.front()) == FrameBuffer::hash(rhs.front()) &&
+           FrameBuffer::hash(lhs.back()) == FrameBuffer::hash(rhs.back());
+}
+
+// 프레임 하나를 RGBA 로 변환 / 해시하는 데 걸리는 시간 (µs)
+template <typename Consume> static double frameMicros(Consume consume)
+{
+    uint64_t frames = 0;
+    Clock::time_point start = Clock::now();
+    do
+    {
+        consume();
+        ++frames;
+    } while (secondsSince(start) < benchSeconds);
+    return secondsSince(start) * 1e6 / frames;
+}
+
+/*
+ * dot 렌더러와 scanline 렌더러 비교
+ * - 같은 프로그램을 두 NES 에서 실행하며 프레임마다 화면과 save state 가 같은지 확인
+ * - PPU 만 진행했을 때와 NES 전체의 frames/s
+ */
+static int benchPPU()
+{
+    const int compareFrames = 300;
+    const uint32_t frameDots = 341 * 262;
+    std::vector<uint8_t> program = makePPUDemo();
+
+    NES dot, line;
+    loadNES(dot, program);
+    loadNES(line, program);
+    dot.ppu.setRenderMode(RenderMode::Dot);
+
+    bool same = true;
+    uint64_t dirtyTiles = 0;
+    std::vector<uint8_t> dotState, lineState;
+    for (int frame = 0; frame < compareFrames && same; ++frame)
+    {
+        runNESFrames(dot, 1);
+        runNESFrames(line, 1);
+        dot.syncPPU();
+        line.syncPPU();
+        dot.saveState(dotState);
+        line.saveState(lineState);
+        same = sameFrames(dot.ppu.frameBuffer, line.ppu.frameBuffer) && dotState == lineState;
+        if (!same)
+            std::cerr << "Dot and scanline renderers differ after frame " << frame + 1 << "\n";
+        dirtyTiles += FrameBuffer::dirtyTiles(line.ppu.frameBuffer.front());
+    }
+
+    std::cout << "PPU demo (dot / scanline renderer)\n";
+    for (RenderMode mode : {RenderMode::Dot, RenderMode::Scanline})
+    {
+        const char *name = mode == RenderMode::Dot ? "dot" : "scanline";
+
+        // 화면을 채운 상태에서 PPU 만 진행
+        line.ppu.setRenderMode(mode);
+        uint64_t frames = 0;
+        Clock::time_point start = Clock::now();
+        do
+        {
+            line.ppu.tick(frameDots);
+            ++frames;
+        } while (secondsSince(start) < benchSeconds);
+        double ppuOnly = frames / secondsSince(start);
+
+        NES nes;
+        loadNES(nes, program);
+        nes.ppu.setRenderMode(mode);
+        frames = 0;
+        start = Clock::now();
+        do
+        {
+            runNESFrames(nes, 1);
+            ++frames;
+        } while (secondsSince(start) < benchSeconds);
+        double full = frames / secondsSince(start);
+
+        std::cout << "  " << name << ": " << static_cast<uint64_t>(ppuOnly) << " frames/s (PPU only), "
+                  << static_cast<uint64_t>(full) << " frames/s (NES)\n";
+    }
+    // headless 실행은 해시만 하므로 RGBA 변환 비용이 들지 않음
+    FrameBuffer::View front = line.ppu.frameBuffer.front();
+    std::vector<uint32_t> rgba(FrameBuffer::width * FrameBuffer::height);
+    uint64_t sink = 0;
+    double convert = frameMicros([&] {
+        FrameBuffer::toRGBA(front, rgba.data(), FrameBuffer::width);
+        sink += rgba[sink & 0xFFFF];
+    });
+    double hash = frameMicros([&] { sink += FrameBuffer::hash(front); });
+    std::cout << "  RGBA conversion (" << pixelKernels().name << "): " << convert << " us/frame, hash only: " << hash
+              << " us/frame" << (sink == 1 ? " " : "") << "\n";
+
+    // present() 할 때 드는 dirty 타일 계산 비용 (PPU frames/s 에 포함되어 있음)
+    FrameBuffer::View back = line.ppu.frameBuffer.back();
+    uint32_t dirty[FrameBuffer::tileRows];
+    double diff = frameMicros([&] {
+        FrameBuffer::diff(front, back, dirty);
+        sink += dirty[sink % FrameBuffer::tileRows];
+    });
+    FrameBuffer::diff(front, front, dirty);
+    same &= std::all_of(dirty, dirty + FrameBuffer::tileRows, [](uint32_t mask) { return mask == 0; });
+    std::cout << "  dirty tiles: " << diff << " us/frame, " << dirtyTiles / compareFrames << " of "
+              << FrameBuffer::tileColumns * FrameBuffer::tileRows << " tiles changed per frame\n";
+    std::cout << "  tile cache: " << line.ppu.tileCacheBytes() << " bytes, " << line.ppu.tileStats.decodes
+              << " tiles decoded, " << line.ppu.tileStats.lastFrameDecodes << " in the last frame\n";
+    std::cout << "  " << compareFrames << " frames: " << (same ? "identical" : "MISMATCH") << "\n";
+    return same ? 0 : 1;
+}
+
+// 게임 로직이 보는 상태: CPU, RAM, PPU 타이밍 / 상태 플래그 / 레지스터 / OAM
+static bool sameLogic(const NES &lhs, const NES &rhs)
+{
+    std::vector<uint8_t> lhsCPU, rhsCPU;
+    lhs.cpu.saveState(lhsCPU);
+    rhs.cpu.saveState(rhsCPU);
+    const PPU &a = lhs.ppu, &b = rhs.ppu;
+    return lhsCPU == rhsCPU && lhs.ram == rhs.ram && lhs.nmiPending == rhs.nmiPending && a.cycle == b.cycle &&
+           a.scanline == b.scanline && a.pipelineState == b.pipelineState && a.vblankFlag == b.vblankFlag &&
+           a.sprZeroHit == b.sprZeroHit && a.spriteOverflow == b.spriteOverflow && a.v == b.v && a.t == b.t &&
+           a.x == b.x && a.w == b.w && a.oamAddr == b.oamAddr && a.oam == b.oam;
+}
+
+/*
+ * frame skip
+ * - 모든 프레임을 그리는 NES 와 frameSkip 을 켠 NES 의 게임 로직 상태가 프레임마다 같은지 확인 (dot / scanline)
+ * - NES 전체의 frames/s 와 속도 향상
+ */
+static int benchFrameSkip()
+{
+    const int compareFrames = 300;
+    const uint32_t skip = 3;
+    std::vector<uint8_t> program = makePPUDemo();
+
+    bool same = true;
+    int hitFrames = 0;
+    for (RenderMode mode : {RenderMode::Dot, RenderMode::Scanline})
+    {
+        NES full, skipped;
+        loadNES(full, program);
+        loadNES(skipped, program);
+        full.ppu.setRenderMode(mode);
+        skipped.ppu.setRenderMode(mode);
+        skipped.ppu.setFrameSkip(skip);
+        for (int frame = 0; frame < compareFrames && same; ++frame)
+        {
+            runNESFrames(full, 1);
+            runNESFrames(skipped, 1);
+            full.syncPPU();
+            skipped.syncPPU();
+            same = sameLogic(full, skipped);
+            hitFrames += full.ppu.sprZeroHit;
+            if (!same)
+                std::cerr << "Frame skip changes game state after frame " << frame + 1 << "\n";
+        }
+    }
+
+    std::cout << "Frame skip (" << skip << ":1, PPU demo)\n";
+    double base = 0;
+    for (uint32_t frameSkip : {0u, skip})
+    {
+        NES nes;
+        loadNES(nes, program);
+        nes.ppu.setFrameSkip(frameSkip);
+        uint64_t frames = 0;
+        Clock::time_point start = Clock::now();
+        do
+        {
+            runNESFrames(nes, 1);
+            ++frames;
+        } while (secondsSince(start) < benchSeconds);
+        double throughput = frames / secondsSince(start);
+        if (frameSkip == 0)
+            base = throughput;
+        std::cout << "  skip " << frameSkip << ": " << static_cast<uint64_t>(throughput) << " frames/s ("
+                  << throughput / base << "x), " << nes.ppu.frameBuffer.sequence() << " presented\n";
+    }
+    std::cout << "  " << compareFrames << " frames x 2 modes (" << hitFrames << " with sprite 0 hit): "
+              << (same ? "identical" : "MISMATCH") << "\n";
+    return same ? 0 : 1;
+}
+
+/*
+ * PPU 스케줄링: 명령어마다 PPU 를 진행(lock-step) vs 필요할 때 따라잡기(catch-up)
+ * - 같은 프로그램을 두 방식으로 실행하며 프레임마다 save state 와 화면이 같은지 확인
+ * - 프레임당 호스트 시간 (dot / scanline 렌더러, 두 방식을 번갈아 3번씩 실행한 것 중 가장 빠른 값)
+ */
+static int benchCatchUp()
+{
+    const int compareFrames = 300;
+    std::vector<uint8_t> program = makePPUDemo();
+
+    bool same = true;
+    for (RenderMode mode : {RenderMode::Dot, RenderMode::Scanline})
+    {
+        NES lockStep, catchUp;
+        loadNES(lockStep, program);
+        loadNES(catchUp, program);
+        lockStep.ppuScheduling = PPUScheduling::LockStep;
+        lockStep.ppu.setRenderMode(mode);
+        catchUp.ppu.setRenderMode(mode);
+
+        std::vector<uint8_t> lockStepState, catchUpState;
+        for (int frame = 0; frame < compareFrames && same; ++frame)
+        {
+            runNESFrames(lockStep, 1);
+            runNESFrames(catchUp, 1);
+            lockStep.syncPPU();
+            catchUp.syncPPU();
+            lockStep.saveState(lockStepState);
+            catchUp.saveState(catchUpState);
+            same = lockStepState == catchUpState && sameFrames(lockStep.ppu.frameBuffer, catchUp.ppu.frameBuffer);
+            if (!same)
+                std::cerr << "Lock-step and catch-up PPU differ after frame " << frame + 1 << "\n";
+        }
+    }
+
+    std::cout << "PPU scheduling (PPU demo, NES)\n";
+    for (RenderMode mode : {RenderMode::Dot, RenderMode::Scanline})
+    {
+        double micros[2] = { 1e30, 1e30 };
+        for (int round = 0; round < 3; ++round)
+            for (PPUScheduling scheduling : {PPUScheduling::LockStep, PPUScheduling::CatchUp})
+            {
+                NES nes;
+                loadNES(nes, program);
+                nes.ppuScheduling = scheduling;
+                nes.ppu.setRenderMode(mode);
+                uint64_t frames = 0;
+                Clock::time_point start = Clock::now();
+                do
+                {
+                    runNESFrames(nes, 1);
+                    ++frames;
+                } while (secondsSince(start) < benchSeconds);
+                double &best = micros[scheduling == PPUScheduling::CatchUp];
+                best = std::min(best, secondsSince(start) * 1e6 / frames);
+            }
+        const char *name = mode == RenderMode::Dot ? "dot" : "scanline";
+        std::cout << "  " << name << ", lock-step: " << micros[0] << " us/frame\n";
+        std::cout << "  " << name << ", catch-up: " << micros[1] << " us/frame (" << micros[0] / micros[1] << "x)\n";
+    }
+    std::cout << "  " << compareFrames << " frames x 2 modes: " << (same ? "identical" : "MISMATCH") << "\n";
+    return same ? 0 : 1;
+}
+
+// 네 채널 + DMC 를 켜고 프레임마다 음높이를 바꾸며 다시 울림 (렌더링 켬, $4015 를 읽어 RAM 에 기록)
+static std::vector<uint8_t> makeAPUDemo()
+{
+    std::vector<uint8_t> program = {
+        0xA9, 0xBF,       //        LDA #$BF       ; pulse 1: duty 50%, halt, 상수 볼륨 15
+        0x8D, 0x00, 0x40, //        STA $4000
+        0xA9, 0x7F,       //        LDA #$7F       ; pulse 2: duty 25%
+        0x8D, 0x04, 0x40, //        STA $4004
+        0xA9, 0xFF,       //        LDA #$FF       ; triangle: halt, linear counter 최대
+        0x8D, 0x08, 0x40, //        STA $4008
+        0xA9, 0x3A,       //        LDA #$3A       ; noise: halt, 상수 볼륨 10
+        0x8D, 0x0C, 0x40, //        STA $400C
+        0xA9, 0x04,       //        LDA #$04
+        0x8D, 0x0E, 0x40, //        STA $400E
+        0xA9, 0x4F,       //        LDA #$4F       ; DMC: loop, 가장 빠른 rate, $C000 부터 4081 바이트
+        0x8D, 0x10, 0x40, //        STA $4010
+        0xA9, 0x00,       //        LDA #$00
+        0x8D, 0x12, 0x40, //        STA $4012
+        0xA9, 0xFF,       //        LDA #$FF
+        0x8D, 0x13, 0x40, //        STA $4013
+        0xA9, 0x1F,       //        LDA #$1F       ; 모든 채널 켬
+        0x8D, 0x15, 0x40, //        STA $4015
+        0xA9, 0x08,       //        LDA #$08
+        0x8D, 0x0F, 0x40, //        STA $400F
+        0xA9, 0x40,       //        LDA #$40       ; 프레임 IRQ 끔
+        0x8D, 0x17, 0x40, //        STA $4017
+        0xA9, 0x1E,       //        LDA #$1E       ; 배경 + 스프라이트
+        0x8D, 0x01, 0x20, //        STA $2001
+    };
+    uint16_t main = programStart + program.size();
+    std::vector<uint8_t> loop = {
+        0xA0, 0x18,       // main:  LDY #$18       ; 24 * 256 번 대기 (약 1 프레임)
+        0xCA,             // delay: DEX
+        0xD0, 0xFD,       //        BNE delay
+        0x88,             //        DEY
+        0xD0, 0xFA,       //        BNE delay
+        0xE6, 0x00,       //        INC $00
+        0xA5, 0x00,       //        LDA $00
+        0x8D, 0x02, 0x40, //        STA $4002      ; 음높이
+        0x8D, 0x0A, 0x40, //        STA $400A
+        0x49, 0xFF,       //        EOR #$FF
+        0x8D, 0x06, 0x40, //        STA $4006
+        0xA9, 0x08,       //        LDA #$08       ; 다시 울림 (length 254)
+        0x8D, 0x03, 0x40, //        STA $4003
+        0x8D, 0x07, 0x40, //        STA $4007
+        0x8D, 0x0B, 0x40, //        STA $400B
+        0xAD, 0x15, 0x40, //        LDA $4015      ; 상태를 RAM 에
+        0xA6, 0x00,       //        LDX $00
+        0x95, 0x10,       //        STA $10,X
+        0x4C, uint8_t(main & 0xFF), uint8_t(main >> 8), // JMP main
+    };
+    program.insert(program.end(), loop.begin(), loop.end());
+    return program;
+}
+
+// 게임 로직이 보는 상태: CPU, RAM
+static bool sameCPUAndRAM(const NES &lhs, const NES &rhs)
+{
+    std::vector<uint8_t> lhsCPU, rhsCPU;
+    lhs.cpu.saveState(lhsCPU);
+    rhs.cpu.saveState(rhsCPU);
+    return lhsCPU == rhsCPU && lhs.ram == rhs.ram;
+}
+
+/*
+ * APU
+ * - 440Hz 펄스만 1초 합성해 영점 교차로 주파수 확인 (APU 단독)
+ * - 레지스터 접근 / 이벤트에서만 따라잡는 NES 와 명령어마다 따라잡는 NES 의 상태와 샘플이 같은지 (일괄 진행이 결과를 바꾸지 않음)
+ * - 오디오를 끈(headless) NES 와 게임 로직 상태가 같은지
+ * - 프레임당 시간: 오디오 켬 / 끔, 오디오가 차지하는 비율
+ */
+static int benchAPU()
+{
+    bool passed = true;
+    {
+        APU apu;
+        std::vector<int16_t> samples;
+        apu.audioOutput = [&](const int16_t *data, size_t count) { samples.insert(samples.end(), data, data + count); };
+        apu.writeRegister(0x4015, 0x01);
+        apu.writeRegister(0x4000, 0xBF); // duty 50%, 상수 볼륨 15
+        apu.writeRegister(0x4002, 0xFD); // 1789773 / (16 * 254) = 440.4Hz
+        apu.writeRegister(0x4003, 0x08);
+        apu.runUntil(APU::clockRate);
+        int crossings = 0, peak = 0;
+        for (size_t i = 1; i < samples.size(); ++i)
+        {
+            crossings += (samples[i - 1] < 0) != (samples[i] < 0);
+            peak = std::max(peak, std::abs(int(samples[i])));
+        }
+        double seconds = double(samples.size()) / apu.sampleRate;
+        double frequency = crossings / 2.0 / seconds;
+        bool ok = std::abs(frequency - 440.4) < 2 && peak < 32767;
+        passed &= ok;
+        std::cout << "APU pulse 440.4Hz: " << samples.size() << " samples, " << frequency << " Hz, peak " << peak
+                  << " (" << (ok ? "ok" : "FAILED") << ")\n";
+    }
+
+    const int compareFrames = 300;
+    std::vector<uint8_t> program = makeAPUDemo();
+    {
+        NES lazy, eager, headless;
+        std::vector<int16_t> lazySamples, eagerSamples;
+        lazy.apu.audioOutput = [&](const int16_t *data, size_t count) {
+            lazySamples.insert(lazySamples.end(), data, data + count);
+        };
+        eager.apu.audioOutput = [&](const int16_t *data, size_t count) {
+            eagerSamples.insert(eagerSamples.end(), data, data + count);
+        };
+        for (NES *nes : {&lazy, &eager, &headless})
+            loadNES(*nes, program);
+        headless.setAudioEnabled(false);
+
+        std::vector<uint8_t> lazyState, eagerState;
+        bool same = true;
+        const uint64_t frameCycles = 29780;
+        for (int frame = 0; frame < compareFrames && same; ++frame)
+        {
+            runNESFrames(lazy, 1);
+            runNESFrames(headless, 1);
+            uint64_t target = eager.cpu.cycles + frameCycles;
+            while (eager.cpu.cycles < target)
+            {
+                eager.apuDeadline = 0; // 명령어마다 따라잡음
+                eager.step();
+            }
+            lazy.saveState(lazyState);
+            eager.saveState(eagerState);
+            same = lazyState == eagerState && lazySamples == eagerSamples && sameCPUAndRAM(lazy, headless);
+            if (!same)
+                std::cerr << "APU batching or headless mode changes the result after frame " << frame + 1 << "\n";
+        }
+        passed &= same;
+        std::cout << "APU demo: " << compareFrames << " frames, " << lazySamples.size() << " samples ("
+                  << lazySamples.size() / double(compareFrames) << " per frame), batched / per-instruction / headless: "
+                  << (same ? "identical" : "MISMATCH") << "\n";
+    }
+
+    // 두 모드를 번갈아 재고 각각 가장 빠른 회차를 씀 (다른 부하의 영향을 줄임)
+    NES nes[2];
+    double times[2] = {1e9, 1e9};
+    for (int audio = 0; audio < 2; ++audio)
+    {
+        loadNES(nes[audio], program);
+        nes[audio].setAudioEnabled(audio);
+    }
+    const int rounds = 10, roundFrames = 60;
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (int audio = 0; audio < 2; ++audio)
+        {
+            Clock::time_point start = Clock::now();
+            runNESFrames(nes[audio], roundFrames);
+            times[audio] = std::min(times[audio], secondsSince(start) * 1e6 / roundFrames);
+        }
+    }
+    std::cout << "  headless: " << times[0] << " us/frame, audio: " << times[1] << " us/frame ("
+              << (times[1] - times[0]) / times[1] * 100 << "% of frame time for audio)\n";
+    return passed ? 0 : 1;
+}
+
+// 한 스레드에서 슬롯 4개짜리 큐에 10개를 넣은 뒤 모두 꺼내 넘침 정책 확인
+static bool checkOverflowPolicy(OverflowPolicy policy, const std::vector<uint64_t> &expected)
+{
+    SPSCQueue<uint64_t> queue(4, policy);
+    for (uint64_t value = 0; value < 10; ++value)
+    {
+        uint64_t *slot = queue.acquire();
+        if (!slot)
+            continue;
+        *slot = value;
+        queue.publish();
+    }
+    std::vector<uint64_t> values;
+    while (const uint64_t *value = queue.pop())
+        values.push_back(*value);
+    return values == expected && queue.popped() + queue.dropped() == 10;
+}
+
+// 소비자가 읽는 슬롯은 생산자가 계속 넣어도 (DropOldest) 다음 pop() 까지 그대로
+static bool checkReadingSlot()
+{
+    SPSCQueue<uint64_t> queue(3, OverflowPolicy::DropOldest);
+    *queue.acquire() = 100;
+    queue.publish();
+    const uint64_t *reading = queue.pop();
+    for (uint64_t value = 0; value < 10; ++value)
+    {
+        *queue.acquire() = value;
+        queue.publish();
+    }
+    bool kept = reading && *reading == 100;
+    const uint64_t *next = queue.pop();
+    return kept && next && *next == 8 && *queue.pop() == 9 && !queue.pop();
+}
+
+static double percentile(std::vector<double> &values, double fraction)
+{
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static void reportLatency(const char *title, std::vector<double> &microseconds)
+{
+    std::cout << "  " << title << " latency p50 " << percentile(microseconds, 0.5) << " us, p99 "
+              << percentile(microseconds, 0.99) << " us, p99.9 " << percentile(microseconds, 0.999) << " us, max "
+              << percentile(microseconds, 1.0) << " us\n";
+}
+
+/*
+ * SPSC 큐
+ * - 넘침 정책 (한 스레드에서 순서 확인), 소비자가 읽는 슬롯 보호
+ * - 처리량 / 지연: 생산자 스레드가 800 샘플 블록을 Block 정책으로 계속 넣고 소비자 스레드가 꺼냄 (넣은 시각 -> 꺼낸 시각)
+ * - NES: 에뮬레이션 스레드가 프레임 (DropOldest) 과 오디오 (Block) 를 넣고 소비자 스레드가 RGBA 로 변환,
+ *   push 비용과 빠짐 없이 순서대로 전달되는지
+ */
+static int benchQueue()
+{
+    bool passed = checkOverflowPolicy(OverflowPolicy::DropNewest, {0, 1, 2, 3}) &&
+                  checkOverflowPolicy(OverflowPolicy::DropOldest, {6, 7, 8, 9}) && checkReadingSlot();
+    std::cout << "SPSC queue overflow policies: " << (passed ? "ok" : "FAILED") << "\n";
+
+    {
+        struct Message
+        {
+            uint64_t sequence;
+            Clock::time_point sent;
+            int16_t samples[800];
+        };
+        const uint64_t messages = 200000;
+        SPSCQueue<Message> queue(16, OverflowPolicy::Block);
+        std::vector<double> latency;
+        latency.reserve(messages);
+        bool ordered = true;
+
+        Clock::time_point start = Clock::now();
+        std::thread consumer([&] {
+            uint64_t expected = 0;
+            while (expected < messages)
+            {
+                const Message *message = queue.pop();
+                if (!message)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                latency.push_back(std::chrono::duration<double, std::micro>(Clock::now() - message->sent).count());
+                ordered &= message->sequence == expected++;
+            }
+        });
+        for (uint64_t i = 0; i < messages; ++i)
+        {
+            Message *message = queue.acquire();
+            message->sequence = i;
+            std::fill(std::begin(message->samples), std::end(message->samples), int16_t(i));
+            message->sent = Clock::now();
+            queue.publish();
+        }
+        consumer.join();
+        double seconds = secondsSince(start);
+        passed &= ordered;
+        std::cout << "SPSC queue, 1600-byte blocks, 16 slots, block policy (" << std::thread::hardware_concurrency()
+                  << " hardware threads)\n";
+        std::cout << "  " << messages / seconds / 1e6 << " M blocks/s, " << messages * sizeof(Message) / seconds / 1e9
+                  << " GB/s, order: " << (ordered ? "ok" : "FAILED") << "\n";
+        reportLatency("push -> pop", latency);
+    }
+
+    {
+        const int frames = 600;
+        NES nes;
+        loadNES(nes, makeAPUDemo());
+        FrameQueue frameQueue(4, OverflowPolicy::DropOldest);
+        AudioQueue audioQueue(16, OverflowPolicy::Block);
+        uint64_t producedSamples = 0;
+        std::vector<double> pushTimes;
+        pushTimes.reserve(frames * 2);
+        nes.apu.audioOutput = [&](const int16_t *samples, size_t count) {
+            Clock::time_point start = Clock::now();
+            audioQueue.push(samples, count);
+            pushTimes.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            producedSamples += count;
+        };
+
+        std::atomic<bool> done{false};
+        uint64_t framesSeen = 0, samplesSeen = 0, lastSequence = 0;
+        bool ordered = true;
+        std::vector<uint32_t> rgba(FrameBuffer::width * FrameBuffer::height);
+        std::thread consumer([&] {
+            for (;;)
+            {
+                bool finished = done.load(std::memory_order_acquire);
+                bool idle = true;
+                if (const QueuedFrame *frame = frameQueue.pop())
+                {
+                    FrameBuffer::toRGBA(frame->view(), rgba.data(), FrameBuffer::width);
+                    ordered &= frame->sequence > lastSequence;
+                    lastSequence = frame->sequence;
+                    ++framesSeen;
+                    idle = false;
+                }
+                if (const AudioBlock *block = audioQueue.pop())
+                {
+                    ordered &= block->first == samplesSeen;
+                    samplesSeen += block->count;
+                    idle = false;
+                }
+                if (idle && finished)
+                    return;
+                if (idle)
+                    std::this_thread::yield();
+            }
+        });
+
+        Clock::time_point start = Clock::now();
+        uint64_t presented = nes.ppu.frameBuffer.sequence();
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            runNESFrames(nes, 1);
+            if (nes.ppu.frameBuffer.sequence() == presented)
+                continue;
+            presented = nes.ppu.frameBuffer.sequence();
+            Clock::time_point pushStart = Clock::now();
+            frameQueue.push(nes.ppu.frameBuffer.front());
+            pushTimes.push_back(std::chrono::duration<double, std::micro>(Clock::now() - pushStart).count());
+        }
+        double seconds = secondsSince(start);
+        done.store(true, std::memory_order_release);
+        consumer.join();
+
+        const SPSCQueue<QueuedFrame> &queue = frameQueue.queue;
+        bool complete = ordered && samplesSeen == producedSamples && framesSeen == queue.popped() &&
+                        queue.pushed() == queue.popped() + queue.dropped() && audioQueue.queue.dropped() == 0;
+        passed &= complete;
+        std::cout << "NES " << frames << " frames -> consumer thread (RGBA conversion)\n";
+        std::cout << "  emulation: " << frames / seconds << " fps, frames delivered " << framesSeen << " / dropped "
+                  << queue.dropped() << ", audio samples " << samplesSeen << " / " << producedSamples
+                  << ", order: " << (complete ? "ok" : "FAILED") << "\n";
+        reportLatency("emulation-side push", pushTimes);
+    }
+    return passed ? 0 : 1;
+}
+
+// 이 스레드가 쓴 CPU 시간 (다른 스레드가 코어를 나눠 써도 에뮬레이션 자체의 비용만 잼)
+static double threadSeconds()
+{
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/*
+ * 비동기 비디오 기록
+ * - 기록 안 함 / Y4M / RGBA / 색 번호 로 APU 데모를 600 프레임 실행하고 파일에 씀
+ * - 에뮬레이션 스레드의 CPU 시간 (프레임당), 벽시계 fps, writer 의 쓰기 횟수와 처리량
+ * - 파일 크기 = 헤더 + 프레임 수 * 프레임 크기, 색 번호 기록의 마지막 프레임이 PPU 의 마지막 프레임과 같은지
+ */
+static int benchRecord()
+{
+    const int frames = 600;
+    const std::string path = "/tmp/bk-nes-bench-video";
+    bool passed = true;
+    std::vector<uint8_t> program = makeAPUDemo();
+
+    std::cout << "NES video recording (" << frames << " frames, writer thread, " << std::thread::hardware_concurrency()
+              << " hardware threads)\n";
+    for (int mode = -1; mode < 3; ++mode)
+    {
+        VideoFormat format = static_cast<VideoFormat>(std::max(mode, 0));
+        static const char *names[] = {"Y4M:     ", "RGBA:    ", "indexed: "};
+        NES nes;
+        loadNES(nes, program);
+        nes.setAudioEnabled(false);
+        VideoRecorder recorder;
+        std::string error;
+        if (mode >= 0 && !recorder.open(path, format, error))
+        {
+            std::cerr << error << "\n";
+            return 1;
+        }
+
+        uint64_t presented = nes.ppu.frameBuffer.sequence(), recorded = 0;
+        Clock::time_point start = Clock::now();
+        double cpuStart = threadSeconds();
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            runNESFrames(nes, 1);
+            if (nes.ppu.frameBuffer.sequence() == presented)
+                continue;
+            presented = nes.ppu.frameBuffer.sequence();
+            recorder.push(nes.ppu.frameBuffer.front());
+            recorded += recorder.recording();
+        }
+        double cpu = (threadSeconds() - cpuStart) / frames * 1e6;
+        double wall = secondsSince(start);
+
+        if (mode < 0)
+        {
+            std::cout << "  off:     " << cpu << " us/frame emulation CPU, " << frames / wall << " fps\n";
+            continue;
+        }
+        bool ok = recorder.close(error);
+        double seconds = secondsSince(start);
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        uint64_t size = static_cast<uint64_t>(file.tellg());
+        size_t frameSize = VideoRecorder::frameBytes(format) + (format == VideoFormat::Y4M ? 6 : 0);
+        ok &= recorder.framesWritten() == recorded && size == VideoRecorder::header(format).size() + recorded * frameSize;
+        if (format == VideoFormat::Indexed)
+        {
+            std::vector<uint8_t> last(frameSize);
+            file.seekg(size - frameSize);
+            file.read(reinterpret_cast<char *>(last.data()), frameSize);
+            FrameBuffer::View front = nes.ppu.frameBuffer.front();
+            for (int y = 0; y < FrameBuffer::height; ++y)
+                ok &= std::equal(last.begin() + y * FrameBuffer::width, last.begin() + (y + 1) * FrameBuffer::width,
+                                 front.pixels + y * FrameBuffer::pitch);
+            ok &= std::equal(front.emphasis, front.emphasis + FrameBuffer::height,
+                             last.begin() + FrameBuffer::width * FrameBuffer::height);
+        }
+        passed &= ok;
+        std::cout << "  " << names[mode] << cpu << " us/frame emulation CPU, "
+                  << frames / wall << " fps, " << recorder.framesWritten() << " frames in " << recorder.writeCalls()
+                  << " writes, " << recorder.bytesWritten() / seconds / 1e6 << " MB/s ("
+                  << (ok ? "ok" : (error.empty() ? "FAILED" : error)) << ")\n";
+    }
+    std::remove(path.c_str());
+    return passed ? 0 : 1;
+}
+
+// 프레임마다 present 된 프레임을 복사해 둠
+static std::vector<QueuedFrame> recordFrames(const std::vector<uint8_t> &program, int frames)
+{
+    NES nes;
+    loadNES(nes, program);
+    nes.setAudioEnabled(false);
+    std::vector<QueuedFrame> recorded;
+    recorded.reserve(frames);
+    uint64_t presented = nes.ppu.frameBuffer.sequence();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        runNESFrames(nes, 1);
+        if (nes.ppu.frameBuffer.sequence() == presented)
+            continue;
+        presented = nes.ppu.frameBuffer.sequence();
+        FrameBuffer::View front = nes.ppu.frameBuffer.front();
+        recorded.emplace_back();
+        std::memcpy(recorded.back().pixels, front.pixels, sizeof(recorded.back().pixels));
+        std::memcpy(recorded.back().emphasis, front.emphasis, sizeof(recorded.back().emphasis));
+        recorded.back().sequence = front.sequence;
+    }
+    return recorded;
+}
+
+static bool sameFrame(const FrameBuffer::View &lhs, const QueuedFrame &rhs)
+{
+    return std::memcmp(lhs.pixels, rhs.pixels, sizeof(rhs.pixels)) == 0 &&
+           std::memcmp(lhs.emphasis, rhs.emphasis, sizeof(rhs.emphasis)) == 0;
+}
+
+/*
+ * 색 번호 프레임 코덱
+ * - PPU 데모 (몇 프레임마다 화면 전체 스크롤 + 스프라이트), APU 데모 (정지 화면) 를 600 프레임씩 기록해 압축
+ * - 압축률 (raw RGBA / 색 번호 대비), 인코더 / 디코더 fps 와 MB/s (입력 = 색 번호 + emphasis), 모든 프레임이 원본과 같은지
+ * - 두 번째 keyframe 부터 새 디코더로 풀어도 같은지
+ */
+static int benchCodec()
+{
+    const int frames = 600;
+    const uint32_t keyframeInterval = 240;
+    const double rawBytes = FrameBuffer::width * FrameBuffer::height + FrameBuffer::height;
+    const double rgbaBytes = FrameBuffer::width * FrameBuffer::height * 4;
+    bool passed = true;
+
+    struct Clip
+    {
+        const char *name;
+        std::vector<uint8_t> program;
+    };
+    for (const Clip &clip : {Clip{"PPU demo (scrolling)", makePPUDemo()}, Clip{"APU demo (static)", makeAPUDemo()}})
+    {
+        std::vector<QueuedFrame> recorded = recordFrames(clip.program, frames);
+        std::vector<uint8_t> stream;
+        stream.reserve(recorded.size() * 8192);
+        double encodeSeconds = 1e9, decodeSeconds = 1e9;
+        bool same = true;
+        for (int round = 0; round < 3; ++round) // 가장 빠른 회차
+        {
+            stream.clear();
+            FrameEncoder encoder(keyframeInterval);
+            Clock::time_point start = Clock::now();
+            for (const QueuedFrame &frame : recorded)
+                encoder.encode(frame.view(), stream);
+            encodeSeconds = std::min(encodeSeconds, secondsSince(start));
+
+            FrameDecoder decoder;
+            size_t offset = 0, decoded = 0;
+            double seconds = 0;
+            for (const QueuedFrame &frame : recorded)
+            {
+                start = Clock::now();
+                size_t used = decoder.decode(stream.data() + offset, stream.size() - offset);
+                seconds += secondsSince(start);
+                if (!used)
+                    break;
+                offset += used;
+                same &= sameFrame(decoder.frame(), frame);
+                ++decoded;
+            }
+            decodeSeconds = std::min(decodeSeconds, seconds);
+            same &= decoded == recorded.size() && offset == stream.size();
+        }
+
+        // 두 번째 keyframe 부터 새 디코더로 풀기 (패킷 크기만 읽어 건너뜀)
+        size_t offset = 0;
+        for (size_t i = 0; i < keyframeInterval; ++i)
+        {
+            size_t size = 0;
+            int shift = 0;
+            while (stream[offset] & 0x80)
+            {
+                size |= size_t(stream[offset++] & 0x7F) << shift;
+                shift += 7;
+            }
+            size |= size_t(stream[offset++]) << shift;
+            offset += size;
+        }
+        FrameDecoder seek;
+        for (size_t i = keyframeInterval; i < recorded.size(); ++i)
+        {
+            size_t used = seek.decode(stream.data() + offset, stream.size() - offset);
+            same &= used > 0 && sameFrame(seek.frame(), recorded[i]);
+            offset += used;
+        }
+        passed &= same;
+
+        double count = double(recorded.size());
+        std::cout << "Frame codec, " << clip.name << ": " << recorded.size() << " frames, "
+                  << stream.size() / count << " bytes/frame (" << rgbaBytes * count / stream.size() << "x vs RGBA, "
+                  << rawBytes * count / stream.size() << "x vs indices), lossless: " << (same ? "ok" : "FAILED")
+                  << "\n";
+        std::cout << "  encode: " << count / encodeSeconds << " fps, " << rawBytes * count / encodeSeconds / 1e6
+                  << " MB/s, decode: " << count / decodeSeconds << " fps, " << rawBytes * count / decodeSeconds / 1e6
+                  << " MB/s\n";
+    }
+    return passed ? 0 : 1;
+}
+
+/*
+ * 가짜 iNES 롬 파일 (PRG 8KB 뱅크 i 의 첫 바이트 = i, CHR 1KB 뱅크 j 의 첫 바이트 = j)
+ * - 마지막 PRG 뱅크의 $E010 부터 code, 벡터는 NMI: RTI / RESET: $E010 / IRQ: irqHandler
+ */
+static std::string writeROM(uint16_t mapper, size_t prgKB, size_t chrKB, const std::vector<uint8_t> &code,
+                            uint16_t irqHandler)
+{
+    std::vector<uint8_t> prg(prgKB * 1024, 0xEA), chr(chrKB * 1024, 0);
+    for (size_t bank = 0; bank < prg.size() / 0x2000; ++bank)
+        prg[bank * 0x2000] = bank;
+    for (size_t bank = 0; bank < chr.size() / 0x400; ++bank)
+        chr[bank * 0x400] = bank;
+
+    uint8_t *last = &prg[prg.size() - 0x2000];
+    std::copy(code.begin(), code.end(), last + 0x10);
+    uint16_t rti = 0xE010 + code.size();
+    last[code.size() + 0x10] = 0x40; // RTI
+    const uint16_t vectors[3] = {rti, 0xE010, irqHandler};
+    for (int i = 0; i < 3; ++i)
+    {
+        last[0x1FFA + i * 2] = vectors[i] & 0xFF;
+        last[0x1FFB + i * 2] = vectors[i] >> 8;
+    }
+
+    uint8_t header[16] = {'N', 'E', 'S', 0x1A};
+    header[4] = prgKB / 16;
+    header[5] = chrKB / 8;
+    header[6] = ((mapper & 0x0F) << 4) | 0x01; // vertical
+    header[7] = mapper & 0xF0;
+
+    std::string path = "/tmp/bk-nes-bench-" + std::to_string(mapper) + "-" + std::to_string(prgKB) + ".nes";
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(prg.data()), prg.size());
+    file.write(reinterpret_cast<const char *>(chr.data()), chr.size());
+    return path;
+}
+
+// MMC1 직렬 레지스터에 5비트 쓰기
+static void writeMMC1(NES &nes, uint16_t address, uint8_t value)
+{
+    for (int i = 0; i < 5; ++i)
+        nes.cpu.bus.write(address, (value >> i) & 0x01);
+}
+
+// 뱅크 전환 결과를 표식 바이트로 확인
+static bool checkMappers()
+{
+    struct Check
+    {
+        const char *name;
+        bool ok;
+    };
+    std::vector<Check> checks;
+    std::string error;
+    auto load = [&](NES &nes, uint16_t mapper, size_t prgKB, size_t chrKB) {
+        if (!nes.loadCartridge(writeROM(mapper, prgKB, chrKB, {}, 0xE010), error))
+            std::cerr << "Failed to load ROM: " << error << "\n";
+    };
+
+    {
+        NES nes;
+        load(nes, 0, 16, 8);
+        checks.push_back({"NROM 16KB mirror", nes.cpu.read(0x8000) == 0 && nes.cpu.read(0xC000) == 0});
+    }
+    {
+        NES nes;
+        load(nes, 2, 128, 0);
+        nes.cpu.bus.write(0x8000, 5);
+        nes.ppu.write(0x0000, 0x5A);
+        checks.push_back({"UxROM", nes.cpu.read(0x8000) == 10 && nes.cpu.read(0xC000) == 14 &&
+                                       nes.ppu.chrByte(0x0000) == 0x5A});
+    }
+    {
+        NES nes;
+        load(nes, 3, 32, 32);
+        nes.cpu.bus.write(0x8000, 2);
+        nes.ppu.write(0x0000, 0x5A); // CHR-ROM 은 쓰기 금지
+        checks.push_back({"CNROM", nes.ppu.chrByte(0x0000) == 16 && nes.ppu.chrByte(0x1C00) == 23});
+    }
+    {
+        NES nes;
+        load(nes, 1, 512, 128);
+        bool ok = nes.cpu.read(0xC000) == 30; // 전원 투입: 마지막 16KB (첫 256KB 안)
+        writeMMC1(nes, 0xE000, 3);
+        ok &= nes.cpu.read(0x8000) == 6;
+        writeMMC1(nes, 0xA000, 0x10); // 8KB CHR 모드에서도 bit 4 는 PRG 바깥 뱅크
+        ok &= nes.cpu.read(0x8000) == 38 && nes.cpu.read(0xC000) == 62;
+        writeMMC1(nes, 0x8000, 0x1F); // horizontal, PRG 모드 3, CHR 4KB
+        writeMMC1(nes, 0xC000, 5);
+        ok &= nes.ppu.mirroring == Mirroring::Horizontal && nes.ppu.chrByte(0x1000) == 20;
+        checks.push_back({"MMC1 (SUROM)", ok});
+    }
+    {
+        NES nes;
+        load(nes, 4, 512, 256);
+        nes.cpu.bus.write(0x8000, 6);
+        nes.cpu.bus.write(0x8001, 5);
+        bool ok = nes.cpu.read(0x8000) == 5 && nes.cpu.read(0xC000) == 62 && nes.cpu.read(0xE000) == 63;
+        nes.cpu.bus.write(0x8000, 0x42); // PRG 모드 1, R2
+        nes.cpu.bus.write(0x8001, 200);
+        ok &= nes.cpu.read(0x8000) == 62 && nes.cpu.read(0xC000) == 5 && nes.ppu.chrByte(0x1000) == 200;
+        nes.cpu.bus.write(0x8000, 0x80); // CHR 반전
+        ok &= nes.ppu.chrByte(0x0000) == 200 && nes.ppu.chrByte(0x1000) == 0;
+        checks.push_back({"MMC3", ok});
+    }
+
+    bool passed = true;
+    for (const Check &check : checks)
+    {
+        std::cout << "  " << check.name << ": " << (check.ok ? "ok" : "FAILED") << "\n";
+        passed &= check.ok;
+    }
+    return passed;
+}
+
+/*
+ * 카트리지
+ * - 롬 크기별 로드 시간 (mmap + 헤더 + 매퍼 초기 배치, 롬을 복사하지 않으므로 크기와 무관해야 함)
+ * - 매퍼별 뱅크 전환 확인
+ * - MMC3 IRQ 를 16줄마다 받는 프로그램을 lock-step / catch-up 으로 실행해 같은지 확인
+ */
+static int benchROM()
+{
+    std::cout << "Cartridge load (MMC3, CHR 128KB)\n";
+    for (size_t prgKB : {32, 128, 512})
+    {
+        std::string path = writeROM(4, prgKB, 128, {}, 0xE010), error;
+        NES nes;
+        uint64_t loads = 0;
+        Clock::time_point start = Clock::now();
+        do
+        {
+            if (!nes.loadCartridge(path, error))
+            {
+                std::cerr << "Failed to load ROM: " << error << "\n";
+                return 1;
+            }
+            ++loads;
+        } while (secondsSince(start) < benchSeconds);
+        std::cout << "  PRG " << prgKB << "KB: " << secondsSince(start) * 1e6 / loads << " us/load\n";
+    }
+
+    std::cout << "Mappers\n";
+    bool passed = checkMappers();
+
+    const std::vector<uint8_t> irqDemo = {
+        0xA2, 0xFF,       //        LDX #$FF
+        0x9A,             //        TXS
+        0xA9, 0x1E,       //        LDA #$1E       ; 배경 + 스프라이트 (렌더링 중에만 카운터가 돎)
+        0x8D, 0x01, 0x20, //        STA $2001
+        0xA9, 0x0F,       //        LDA #$0F       ; 16줄마다
+        0x8D, 0x00, 0xC0, //        STA $C000      ; latch
+        0x8D, 0x01, 0xC0, //        STA $C001      ; reload
+        0x8D, 0x01, 0xE0, //        STA $E001      ; IRQ 켬
+        0xA9, 0x40,       //        LDA #$40       ; APU 프레임 IRQ 끔 (전원 투입 때 켜져 있음)
+        0x8D, 0x17, 0x40, //        STA $4017
+        0x58,             //        CLI
+        0xE6, 0x01,       // loop:  INC $01
+        0x4C, 0x29, 0xE0, //        JMP loop
+        0x8D, 0x00, 0xE0, // irq:   STA $E000      ; 확인
+        0x8D, 0x01, 0xE0, //        STA $E001
+        0xE6, 0x00,       //        INC $00        ; IRQ 횟수 ($02:$00)
+        0xD0, 0x02,       //        BNE done
+        0xE6, 0x02,       //        INC $02
+        0x40,             // done:  RTI
+    };
+    std::string path = writeROM(4, 512, 128, irqDemo, 0xE02E), error;
+
+    const int frames = 120;
+    NES lockStep, catchUp;
+    lockStep.ppuScheduling = PPUScheduling::LockStep;
+    uint64_t lines[2] = {}; // 매퍼 카운터를 클럭한 줄 수 (기대 IRQ 횟수 = lines / 16)
+    for (NES *nes : {&lockStep, &catchUp})
+    {
+        nes->loadCartridge(path, error);
+        nes->cpu.reset();
+        uint64_t &count = lines[nes == &catchUp];
+        nes->ppu.scanlineCounter = [nes, &count] {
+            ++count;
+            nes->mapper->scanline();
+        };
+    }
+    std::vector<uint8_t> lockStepState, catchUpState;
+    bool same = true;
+    for (int frame = 0; frame < frames && same; ++frame)
+    {
+        runNESFrames(lockStep, 1);
+        runNESFrames(catchUp, 1);
+        lockStep.saveState(lockStepState);
+        catchUp.saveState(catchUpState);
+        same = lockStepState == catchUpState;
+        if (!same)
+            std::cerr << "Lock-step and catch-up MMC3 IRQ differ after frame " << frame + 1 << "\n";
+    }
+    // IRQ 마다 한 번씩만 들어와야 함 (핸들러가 확인하지 않은 IRQ 가 남아 있으면 RTI 직후 다시 들어옴)
+    int irqs = catchUp.ram[0] | (catchUp.ram[2] << 8);
+    int lockStepIRQs = lockStep.ram[0] | (lockStep.ram[2] << 8);
+    uint64_t clocked = lines[1];
+    int expected = static_cast<int>(clocked / 16);
+    bool counted = irqs == expected && lockStepIRQs == expected && lines[0] == lines[1];
+
+    // 매퍼 레지스터 / IRQ 카운터까지 save state 로 되돌아오는지
+    std::vector<uint8_t> snapshot, first, second;
+    catchUp.saveState(snapshot);
+    runNESFrames(catchUp, 1);
+    catchUp.saveState(first);
+    same &= catchUp.loadState(snapshot);
+    runNESFrames(catchUp, 1);
+    catchUp.saveState(second);
+    same &= first == second;
+
+    std::cout << "MMC3 IRQ (latch 15): " << frames << " frames, " << irqs << " IRQs (expected " << expected << " = "
+              << clocked << " lines / 16), " << (counted ? "count ok" : "COUNT MISMATCH") << ", "
+              << (same ? "identical" : "MISMATCH") << "\n";
+    return passed && same && counted ? 0 : 1;
+}
+
+static int benchDispatch(int argc, char *argv[])
+{
+    if (argc >= 3)
+    {
+        std::vector<uint8_t> program;
+        if (!loadBinary(argv[2], program))
+        {
+            std::cerr << "Failed to load binary file: " << argv[2] << "\n";
+            return 1;
+        }
+        compareDispatch(argv[2], program, [](CPU &cpu, const std::vector<uint8_t> &program, auto step, uint64_t &n) {
+            return runUntilTrap(cpu, program, step, n);
+        });
+    }
+
+    compareDispatch("synthetic opcode mix", makeSyntheticMix(4096),
+                    [](CPU &cpu, const std::vector<uint8_t> &program, auto step, uint64_t &n) {
+                        return runFor(cpu, program, step, n);
+                    });
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " dispatch [binary file] | cycles | blocks [binary file] | jit [binary file] | flags | state | rewind | batch | ppu | skip | catchup | rom | apu | queue | record | codec\n";
+        return 1;
+    }
+
+    std::string name = argv[1];
+    if (name == "dispatch")
+        return benchDispatch(argc, argv);
+    if (name == "cycles")
+        return benchCycles();
+    if (name == "blocks")
+        return benchBlocks(argc, argv);
+    if (name == "jit")
+        return benchJIT(argc, argv);
+    if (name == "flags")
+        return benchFlags();
+    if (name == "state")
+        return benchState();
+    if (name == "rewind")
+        return benchRewind();
+    if (name == "batch")
+        return benchBatch();
+    if (name == "ppu")
+        return benchPPU();
+    if (name == "skip")
+        return benchFrameSkip();
+    if (name == "catchup")
+        return benchCatchUp();
+    if (name == "rom")
+        return benchROM();
+    if (name == "apu")
+        return benchAPU();
+    if (name == "queue")
+        return benchQueue();
+    if (name == "record")
+        return benchRecord();
+    if (name == "codec")
+        return benchCodec();
+
+    std::cerr << "Unknown benchmark: " << name << "\n";
+    return 1;
+}
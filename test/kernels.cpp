@@ -0,0 +1,196 @@
+#include "../includes/PixelKernels.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * SIMD 픽셀 커널이 scalar 구현과 같은 결과를 내는지 확인
+ * - 길이가 벡터 폭의 배수가 아닌 경우(나머지 처리)도 포함
+ */
+
+static std::mt19937 rng(2002);
+
+static std::vector<uint8_t> randomBytes(size_t size)
+{
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t &byte : bytes)
+        byte = rng() & 0xFF;
+    return bytes;
+}
+
+// 실제 렌더러가 만드는 값의 범위: 배경 0 ~ 15, 스프라이트 0 또는 0x10 | 플래그
+static std::vector<uint8_t> randomLine(size_t size, bool sprite)
+{
+    std::vector<uint8_t> line(size);
+    for (uint8_t &pixel : line)
+    {
+        if (rng() % 3 == 0)
+            pixel = 0;
+        else
+            pixel = sprite ? (0x10 | (rng() & 0x6F)) : (rng() & 0x0F);
+    }
+    return line;
+}
+
+static bool testDecode(const PixelKernels &kernels)
+{
+    const PixelKernels &reference = *scalarPixelKernels();
+    for (size_t rows = 0; rows <= 40; ++rows)
+        for (int variant = 0; variant < 4; ++variant)
+        {
+            bool flip = variant & 1;
+            bool withAttributes = variant & 2;
+            std::vector<uint8_t> low = randomBytes(rows), high = randomBytes(rows), attributes = randomBytes(rows);
+            std::vector<uint8_t> expected(rows * 8 + 1, 0xAA), actual(rows * 8 + 1, 0xAA);
+
+            const uint8_t *attributeData = withAttributes ? attributes.data() : nullptr;
+            reference.decodeRows(low.data(), high.data(), attributeData, rows, expected.data(), flip);
+            kernels.decodeRows(low.data(), high.data(), attributeData, rows, actual.data(), flip);
+            if (actual != expected)
+            {
+                std::cerr << kernels.name << " decodeRows: mismatch (rows " << rows << ", flip " << flip
+                          << ", attributes " << withAttributes << ")\n";
+                return false;
+            }
+        }
+    return true;
+}
+
+static bool testComposite(const PixelKernels &kernels)
+{
+    const PixelKernels &reference = *scalarPixelKernels();
+    for (size_t count = 0; count <= 300; ++count)
+    {
+        std::vector<uint8_t> bg = randomLine(count, false), sprite = randomLine(count, true);
+        std::vector<uint8_t> expected(count + 1, 0xAA), actual(count + 1, 0xAA);
+
+        bool expectedHit = reference.composite(bg.data(), sprite.data(), expected.data(), count);
+        bool actualHit = kernels.composite(bg.data(), sprite.data(), actual.data(), count);
+        if (actual != expected || actualHit != expectedHit)
+        {
+            std::cerr << kernels.name << " composite: mismatch (count " << count << ")\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool testIndicesToRGBA(const PixelKernels &kernels)
+{
+    const PixelKernels &reference = *scalarPixelKernels();
+    std::vector<uint32_t> palette(64);
+    for (uint32_t &color : palette)
+        color = rng();
+    for (size_t count = 0; count <= 300; ++count)
+    {
+        std::vector<uint8_t> indices = randomBytes(count); // 상위 비트는 무시되어야 함
+        std::vector<uint32_t> expected(count + 1, 0xAAAAAAAA), actual(count + 1, 0xAAAAAAAA);
+
+        reference.indicesToRGBA(indices.data(), palette.data(), expected.data(), count);
+        kernels.indicesToRGBA(indices.data(), palette.data(), actual.data(), count);
+        if (actual != expected)
+        {
+            std::cerr << kernels.name << " indicesToRGBA: mismatch (count " << count << ")\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool testDiffBlocks(const PixelKernels &kernels)
+{
+    const PixelKernels &reference = *scalarPixelKernels();
+    for (size_t blocks = 0; blocks <= 32; ++blocks)
+        for (int changes = 0; changes < 4; ++changes)
+        {
+            std::vector<uint8_t> a = randomBytes(blocks * 8), b = a;
+            for (int i = 0; i < changes && blocks > 0; ++i)
+                b[rng() % b.size()] ^= 1 << (rng() % 8);
+
+            uint32_t expected = reference.diffBlocks(a.data(), b.data(), blocks);
+            if (kernels.diffBlocks(a.data(), b.data(), blocks) != expected)
+            {
+                std::cerr << kernels.name << " diffBlocks: mismatch (blocks " << blocks << ")\n";
+                return false;
+            }
+        }
+    return true;
+}
+
+// scalar 기준 구현 자체도 손으로 계산한 값과 비교
+static bool testReference()
+{
+    const PixelKernels &scalar = *scalarPixelKernels();
+    const uint8_t low[] = {0xA0};  // 1010 0000
+    const uint8_t high[] = {0x60}; // 0110 0000
+    const uint8_t attributes[] = {0x02};
+    uint8_t pixels[8], flipped[8];
+    scalar.decodeRows(low, high, attributes, 1, pixels, false);
+    scalar.decodeRows(low, high, attributes, 1, flipped, true);
+    const uint8_t expected[] = {0x09, 0x0A, 0x0B, 0x08, 0x08, 0x08, 0x08, 0x08};
+    for (int i = 0; i < 8; ++i)
+        if (pixels[i] != expected[i] || flipped[7 - i] != expected[i])
+        {
+            std::cerr << "scalar decodeRows: pixel " << i << " is " << +pixels[i] << "\n";
+            return false;
+        }
+
+    // 투명 / 배경만 / 스프라이트만 / 배경 뒤 스프라이트 / 배경 앞 스프라이트 0
+    const uint8_t bg[] = {0x00, 0x05, 0x00, 0x06, 0x07};
+    const uint8_t sprite[] = {0x00, 0x00, 0x13, 0x11, 0x72};
+    const uint8_t composited[] = {0x00, 0x05, 0x13, 0x06, 0x12};
+    uint8_t out[5];
+    bool hit = scalar.composite(bg, sprite, out, 5);
+    for (int i = 0; i < 5; ++i)
+        if (out[i] != composited[i])
+        {
+            std::cerr << "scalar composite: pixel " << i << " is " << +out[i] << "\n";
+            return false;
+        }
+    if (!hit || scalar.composite(bg, sprite, out, 4))
+    {
+        std::cerr << "scalar composite: wrong sprite 0 hit\n";
+        return false;
+    }
+
+    uint32_t palette[64] = {};
+    palette[0x05] = 0x11223344;
+    palette[0x3F] = 0xAABBCCDD;
+    const uint8_t indices[] = {0x05, 0x45, 0xFF};
+    uint32_t rgba[3];
+    scalar.indicesToRGBA(indices, palette, rgba, 3);
+    if (rgba[0] != 0x11223344 || rgba[1] != 0x11223344 || rgba[2] != 0xAABBCCDD)
+    {
+        std::cerr << "scalar indicesToRGBA: wrong color\n";
+        return false;
+    }
+
+    uint8_t before[24] = {}, after[24] = {};
+    after[8] = 1;  // 블록 1
+    after[23] = 1; // 블록 2
+    if (scalar.diffBlocks(before, after, 3) != 0x06 || scalar.diffBlocks(before, after, 1) != 0)
+    {
+        std::cerr << "scalar diffBlocks: wrong mask\n";
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    bool passed = testReference();
+
+    for (const PixelKernels *kernels : {sse2PixelKernels(), avx2PixelKernels()})
+    {
+        if (kernels == nullptr)
+            continue;
+        bool ok = testDecode(*kernels) && testComposite(*kernels) && testIndicesToRGBA(*kernels) &&
+                  testDiffBlocks(*kernels);
+        std::cout << kernels->name << ": " << (ok ? "ok" : "FAILED") << "\n";
+        passed &= ok;
+    }
+
+    std::cout << "selected: " << pixelKernels().name << "\n";
+    return passed ? 0 : 1;
+}
@@ -1,15 +1,334 @@
 #include "../includes/CPU.h"
+#include "../includes/BlockCache.h"
+#include "../includes/JIT.h"
 #include <fstream>
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
 
 #include <chrono>
 #include <thread>
 
+using Clock = std::chrono::steady_clock;
+
+static const uint16_t trapAddress = 0xF001;     // 프로그램이 결과를 쓰면 종료
+static const uint64_t frameCycles = 29780;      // NTSC 한 프레임의 CPU 사이클
+static const double ntscCPUClock = 1789773.0;   // NTSC 2A03 클럭 (Hz)
+static const uint64_t maxCycles = 1ull << 40;   // trap 에 도달하지 못하는 프로그램 대비
+static const uint64_t maxFrames = maxCycles / frameCycles;
+
+// 제한 없이 최대 속도로 실행
+static void runFullSpeed(CPU &cpu)
+{
+    while (!cpu.halted && cpu.cycles < maxCycles)
+        cpu.run(frameCycles);
+}
+
+/*
+ * 실제 NES 속도로 실행
+ * - 프레임(29780 사이클)마다 한 번씩, monotonic clock 기준의 절대 시각까지 sleep 하므로 오차가 누적되지 않음
+ * - 한 프레임 이상 뒤처지면 기준 시각을 현재로 다시 맞춤 (따라잡기 위해 몰아서 실행하지 않음)
+ */
+static void runPaced(CPU &cpu)
+{
+    const auto frameDuration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(frameCycles / ntscCPUClock));
+
+    Clock::time_point deadline = Clock::now();
+    while (!cpu.halted && cpu.cycles < maxCycles)
+    {
+        cpu.run(frameCycles);
+        if (cpu.halted)
+            break;
+
+        deadline += frameDuration;
+        Clock::time_point now = Clock::now();
+        if (now > deadline + frameDuration)
+            deadline = now;
+        else
+            std::this_thread::sleep_until(deadline);
+    }
+}
+
+static bool sameState(const CPU &lhs, const CPU &rhs)
+{
+    return lhs.a == rhs.a && lhs.x == rhs.x && lhs.y == rhs.y && lhs.sp == rhs.sp && lhs.stat == rhs.stat &&
+           lhs.pc == rhs.pc && lhs.cycles == rhs.cycles && lhs.instructions == rhs.instructions &&
+           lhs.halted == rhs.halted && lhs.memory == rhs.memory;
+}
+
+/*
+ * 인터프리터와 JIT 를 프레임 단위로 나란히 실행하며 상태(레지스터, 사이클, 메모리)를 비교
+ * - 짧은 프로그램도 네이티브 코드를 거치도록 처음 실행되는 블록부터 디코딩/컴파일
+ * - trap 에 도달하거나 frames 프레임까지 실행
+ * - 처음으로 달라진 프레임을 출력하고 실패, 컴파일된 블록이 없어도 실패
+ */
+static bool runDifferential(const std::string &title, CPU &cpu, uint64_t frames)
+{
+    if (cpu.executionMode != ExecutionMode::JIT)
+    {
+        std::cerr << "JIT is not active, nothing to compare\n";
+        return false;
+    }
+    cpu.jit->hotThreshold = 1;
+    cpu.blockCache->decodeThreshold = 0;
+
+    CPU reference;
+    reference.memory = cpu.memory;
+    reference.pc = cpu.pc;
+    reference.setTrap(trapAddress);
+
+    uint64_t frame = 0;
+    while (!cpu.halted && frame < frames)
+    {
+        cpu.run(frameCycles);
+        reference.run(frameCycles);
+        ++frame;
+        if (!sameState(cpu, reference))
+        {
+            std::cerr << title << ": state mismatch after frame " << frame << ": pc " << std::hex << cpu.pc << " / "
+                      << reference.pc << ", a " << +cpu.a << " / " << +reference.a << ", stat " << +cpu.stat
+                      << " / " << +reference.stat << std::dec << ", cycles " << cpu.cycles << " / "
+                      << reference.cycles << "\n";
+            return false;
+        }
+    }
+    if (cpu.jit->stats.compiled == 0)
+    {
+        std::cerr << title << ": no block was compiled, the JIT was not exercised\n";
+        return false;
+    }
+    std::cout << title << ": interpreter and JIT states match over " << frame << " frames (" << cpu.jit->stats.compiled
+              << " blocks compiled, " << cpu.jit->stats.nativeRuns << " native runs)\n";
+    return true;
+}
+
+/*
+ * diff 모드에서 바이너리 다음에 돌리는 프로그램 ($8000 부터, 마지막에 $F001 에 써서 종료)
+ * - ADC/SBC/CMP/BIT 를 C/D 플래그를 바꿔 가며 모든 값에 대해 실행 (V 포함, 2A03 은 D 를 무시하지만 stat 에는 남음)
+ */
+static std::vector<uint8_t> makeFlagSweep()
+{
+    return {
+        0xA9, 0x18,       //        LDA #$18     ; 바깥 루프 24번
+        0x85, 0x04,       //        STA $04
+        0xA0, 0x00,       //        LDY #$00
+        0x84, 0x01,       // outer: STY $01      ; operand
+        0xA2, 0x00,       //        LDX #$00
+        0x8A,             // inner: TXA
+        0x65, 0x01,       //        ADC $01      ; C 는 이전 결과에서 이어짐
+        0x20, 0x48, 0x80, //        JSR record
+        0x8A,             //        TXA
+        0xE5, 0x01,       //        SBC $01
+        0x20, 0x48, 0x80, //        JSR record
+        0x8A,             //        TXA
+        0xC5, 0x01,       //        CMP $01
+        0x20, 0x48, 0x80, //        JSR record
+        0x8A,             //        TXA
+        0x69, 0x7F,       //        ADC #$7F     ; immediate (컴파일할 때 코드에 들어감)
+        0x20, 0x48, 0x80, //        JSR record
+        0x8A,             //        TXA
+        0xE9, 0x80,       //        SBC #$80
+        0x20, 0x48, 0x80, //        JSR record
+        0x8A,             //        TXA
+        0xC9, 0x40,       //        CMP #$40
+        0x20, 0x48, 0x80, //        JSR record
+        0x24, 0x01,       //        BIT $01      ; V/N 은 operand 에서
+        0x20, 0x48, 0x80, //        JSR record
+        0xE8,             //        INX
+        0xD0, 0xD4,       //        BNE inner
+        0x08,             //        PHP          ; D 플래그 전환
+        0x68,             //        PLA
+        0x49, 0x08,       //        EOR #$08
+        0x48,             //        PHA
+        0x28,             //        PLP
+        0x98,             //        TYA
+        0x18,             //        CLC
+        0x69, 0x0B,       //        ADC #$0B
+        0xA8,             //        TAY
+        0xC6, 0x04,       //        DEC $04
+        0xD0, 0xC1,       //        BNE outer
+        0x8D, 0x01, 0xF0, //        STA $F001
+        0x08,             // record: PHP         ; $02 ^= A, $03 ^= 상태 (플래그는 그대로 돌려놓음)
+        0x45, 0x02,       //        EOR $02
+        0x85, 0x02,       //        STA $02
+        0x68,             //        PLA
+        0x48,             //        PHA
+        0x45, 0x03,       //        EOR $03
+        0x85, 0x03,       //        STA $03
+        0x28,             //        PLP
+        0x60,             //        RTS
+    };
+}
+
+/*
+ * 컴파일된 블록에 쓰는 루프 (Y 가 0 이면 $7Fxx 데이터에 씀)
+ * - X & 15 == 0: 실행 중인 블록의 뒤쪽 immediate (patch+1)
+ * - X & 15 == 8: 다른 블록의 immediate (tick+1)
+ * - 두 블록 모두 그 사이에 다시 컴파일되므로 네이티브 코드의 쓰기가 컴파일된 코드를 바꿈
+ */
+static std::vector<uint8_t> makeSelfModifyingLoop()
+{
+    return {
+        0xA2, 0x00,       //        LDX #$00
+        0xA9, 0xA0,       //        LDA #$A0     ; $0400 + (X & 15): Y 값 표 (0 이면 $A0 = off1)
+        0x8D, 0x00, 0x04, //        STA $0400
+        0xA9, 0x40,       //        LDA #$40     ; (8 이면 $40 = off2)
+        0x8D, 0x08, 0x04, //        STA $0408
+        0xA9, 0x04,       //        LDA #$04     ; 바깥 루프 4번
+        0x85, 0x04,       //        STA $04
+        0x8A,             // loop:  TXA
+        0x29, 0x0F,       //        AND #$0F
+        0xA8,             //        TAY
+        0xB9, 0x00, 0x04, //        LDA $0400,Y
+        0xA8,             //        TAY
+        0x8A,             //        TXA
+        0x99, 0x80, 0x7F, //        STA $7F80,Y  ; off1: 이 블록의 뒤쪽 immediate (patch+1)
+        0x99, 0xEB, 0x7F, //        STA $7FEB,Y  ; off2: 다른 블록의 immediate (tick+1)
+        0x69, 0x00,       // patch: ADC #$00
+        0x6D, 0x01, 0x03, //        ADC $0301    ; 누적: 바뀌기 전 immediate 로 계산하면 끝까지 남음
+        0x8D, 0x01, 0x03, //        STA $0301
+        0x18,             //        CLC
+        0x90, 0x00,       //        BCC tick     ; 블록 경계
+        0xA9, 0x00,       // tick:  LDA #$00
+        0x6D, 0x02, 0x03, //        ADC $0302
+        0x8D, 0x02, 0x03, //        STA $0302
+        0xE8,             //        INX
+        0xD0, 0xDB,       //        BNE loop
+        0xC6, 0x04,       //        DEC $04
+        0xD0, 0xD7,       //        BNE loop
+        0x8D, 0x01, 0xF0, //        STA $F001
+    };
+}
+
+// 메모리 INC/DEC/ROL/LSR 과 페이지를 넘는 분기 (앞/뒤, 두 페이지에 걸친 명령어와 블록)
+static std::vector<uint8_t> makePageCrossingLoop()
+{
+    std::vector<uint8_t> program = {
+        0xA2, 0x00,       //        LDX #$00
+        0xA9, 0x20,       //        LDA #$20     ; 바깥 루프 32번
+        0x85, 0x04,       //        STA $04
+        0x4C, 0xF0, 0x80, //        JMP loop
+    };
+    program.resize(0xF0, 0xEA); // loop 는 $80F0
+    std::vector<uint8_t> loop = {
+        0xFE, 0x00, 0x02, // loop:  INC $0200,X
+        0xDE, 0x00, 0x03, //        DEC $0300,X
+        0xBD, 0x00, 0x02, //        LDA $0200,X
+        0xC9, 0x10,       //        CMP #$10
+        0xB0, 0x0E,       //        BCS far      ; 다음 페이지로 분기
+        0xE6, 0x10,       //        INC $10
+        0xD6, 0x11,       //        DEC $11,X    ; $80FF-$8100 에 걸침
+        0xE8,             // back:  INX
+        0xD0, 0xEC,       //        BNE loop     ; 이전 페이지로 분기
+        0xC6, 0x04,       //        DEC $04
+        0xD0, 0xE8,       //        BNE loop
+        0x8D, 0x01, 0xF0, //        STA $F001
+        0x3E, 0x00, 0x02, // far:   ROL $0200,X
+        0x46, 0x10,       //        LSR $10
+        0x18,             //        CLC
+        0x90, 0xEE,       //        BCC back
+    };
+    program.insert(program.end(), loop.begin(), loop.end());
+    return program;
+}
+
+/*
+ * 분기/점프/스택 제어 없이 RAM($0200-$07FF)만 건드리는 명령어를 무작위로 나열하고
+ * 마지막에 JMP $8000 으로 되돌아가는 프로그램 (종료하지 않음)
+ */
+static std::vector<uint8_t> makeSyntheticMix(size_t count)
+{
+    std::vector<uint8_t> opcodes;
+    for (int opcode = 0; opcode < 256; ++opcode)
+    {
+        const Instruction &instruction = CPU::instructionSet[opcode];
+        if (instruction.operation == nullptr || instruction.mode == AddressMode::Relative)
+            continue;
+        switch (opcode)
+        {
+        case 0x00: case 0x20: case 0x40: case 0x60: // BRK, JSR, RTI, RTS
+        case 0x4C: case 0x6C:                       // JMP
+        case 0x81: case 0x91:                       // STA (간접) 은 코드 영역을 덮어쓸 수 있음
+            continue;
+        default: opcodes.push_back(opcode); break;
+        }
+    }
+
+    std::mt19937 rng(0x2A03);
+    std::vector<uint8_t> program;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint8_t opcode = opcodes[rng() % opcodes.size()];
+        program.push_back(opcode);
+        switch (CPU::instructionSet[opcode].mode)
+        {
+        case AddressMode::Implied:
+        case AddressMode::Accumulator: break;
+        case AddressMode::Absolute:
+        case AddressMode::AbsoluteXIndexed:
+        case AddressMode::AbsoluteYIndexed:
+        {
+            uint16_t address = 0x0200 + rng() % 0x0500; // + X/Y 를 해도 $07FF 이하
+            program.push_back(address & 0xFF);
+            program.push_back(address >> 8);
+            break;
+        }
+        default: program.push_back(rng() & 0xFF); break;
+        }
+    }
+    program.push_back(0x4C); // JMP $8000
+    program.push_back(0x00);
+    program.push_back(0x80);
+    return program;
+}
+
+// program 을 $8000 에 올려 JIT 로 runDifferential (selfModifying: 블록 무효화가 한 번도 없으면 실패)
+static bool runProgramDifferential(const char *title, const std::vector<uint8_t> &program, uint64_t frames,
+                                   bool selfModifying = false)
+{
+    CPU cpu;
+    std::copy(program.begin(), program.end(), cpu.memory.begin() + 0x8000);
+    cpu.pc = 0x8000;
+    cpu.setTrap(trapAddress);
+    cpu.setExecutionMode(ExecutionMode::JIT);
+    if (!runDifferential(title, cpu, frames))
+        return false;
+    if (frames == maxFrames && !cpu.halted)
+    {
+        std::cerr << title << ": did not reach the trap address\n";
+        return false;
+    }
+    if (selfModifying && cpu.blockCache->stats.invalidations == 0)
+    {
+        std::cerr << title << ": no block was invalidated, self-modifying code was not exercised\n";
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char *argv[])
 {
     if (argc < 2)
     {
-        std::cerr << "Usage: " << argv[0] << " <binary file>\n";
+        std::cerr << "Usage: " << argv[0] << " <binary file> [fast|paced|diff] [interpreter|blocks|jit]\n";
+        return 1;
+    }
+
+    std::string mode = (argc >= 3) ? argv[2] : "fast";
+    if (mode != "fast" && mode != "paced" && mode != "diff")
+    {
+        std::cerr << "Unknown run mode: " << mode << "\n";
+        return 1;
+    }
+
+    std::string engine = (argc >= 4) ? argv[3] : "interpreter";
+    if (mode == "diff")
+        engine = "jit";
+    if (engine != "interpreter" && engine != "blocks" && engine != "jit")
+    {
+        std::cerr << "Unknown execution mode: " << engine << "\n";
         return 1;
     }
 
@@ -28,7 +347,7 @@ int main(int argc, char *argv[])
     }
 
     // Load binary into memory starting at address 0x8000
-    uint16_t startAddress = 0x8000;
+    uint32_t startAddress = 0x8000; // 0xFFFF 를 넘는지 확인할 수 있도록 32비트
     uint8_t byte;
     while (file.read(reinterpret_cast<char *>(&byte), 1))
     {
@@ -53,16 +372,39 @@ int main(int argc, char *argv[])
 
     // Set the program counter to the start of the loaded program
     cpu.pc = 0x8000;
+    cpu.setTrap(trapAddress);
+    if (engine == "jit")
+        cpu.setExecutionMode(ExecutionMode::JIT);
+    else
+        cpu.setExecutionMode(engine == "blocks" ? ExecutionMode::BlockCache : ExecutionMode::Interpreter);
+    if (engine == "jit" && cpu.executionMode != ExecutionMode::JIT)
+        std::cerr << "JIT is not available on this platform, using the block cache\n";
 
-    // Execute instructions in a loop
-    while (cpu.memory[0xF001] == 0)
+    Clock::time_point start = Clock::now();
+    if (mode == "diff")
     {
-        cpu.execute();
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        bool same = runDifferential(argv[1], cpu, maxFrames);
+        same &= runProgramDifferential("flag sweep", makeFlagSweep(), maxFrames);
+        same &= runProgramDifferential("self-modifying code", makeSelfModifyingLoop(), maxFrames, true);
+        same &= runProgramDifferential("page-crossing branches", makePageCrossingLoop(), maxFrames);
+        same &= runProgramDifferential("synthetic opcode mix", makeSyntheticMix(4096), 100);
+        if (!same)
+            return 1;
     }
+    else if (mode == "paced")
+        runPaced(cpu);
+    else
+        runFullSpeed(cpu);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (!cpu.halted)
+        std::cerr << "Program did not reach the trap address within " << maxCycles << " cycles\n";
 
-    int result = static_cast<int>(cpu.memory[0xF001]);
+    int result = static_cast<int>(cpu.memory[trapAddress]);
     std::cout << "Summation result: " << std::dec << result << std::endl;
+    std::cout << "Executed " << cpu.instructions << " instructions, " << cpu.cycles << " cycles in " << seconds
+              << " s (" << static_cast<uint64_t>(cpu.instructions / seconds) << " instructions/s, "
+              << static_cast<uint64_t>(cpu.cycles / seconds) << " cycles/s)" << std::endl;
 
     return 0;
 }